@@ -1010,6 +1010,150 @@ MA_ATTR_WEAK ma_err_t rgb_to_rgb(const ma_img_t* src, ma_img_t* dst) {
     return MA_OK;
 }
 
+MA_ATTR_WEAK ma_err_t crop(const ma_img_t* src, ma_img_t* dst, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    if (!src || !src->data || !dst || !dst->data) [[unlikely]]
+        return MA_EINVAL;
+
+    if (src->format == MA_PIXEL_FORMAT_YUV422) {
+        x &= ~1;
+        w &= ~1;
+    }
+
+    if (w == 0 || h == 0 || x + w > src->width || y + h > src->height) [[unlikely]]
+        return MA_EINVAL;
+
+    dst->width  = w;
+    dst->height = h;
+    dst->format = src->format;
+    dst->rotate = MA_PIXEL_ROTATE_0;
+
+    switch (src->format) {
+        case MA_PIXEL_FORMAT_RGB888:
+        case MA_PIXEL_FORMAT_RGB565:
+        case MA_PIXEL_FORMAT_GRAYSCALE: {
+            uint32_t bpp    = src->format == MA_PIXEL_FORMAT_RGB888 ? 3 : src->format == MA_PIXEL_FORMAT_RGB565 ? 2 : 1;
+            uint32_t stride = src->width * bpp;
+            uint32_t line   = w * bpp;
+            for (uint16_t i = 0; i < h; ++i) {
+                memcpy(dst->data + i * line, src->data + (y + i) * stride + x * bpp, line);
+            }
+            dst->size = line * h;
+        } break;
+
+        case MA_PIXEL_FORMAT_YUV422: {
+            // planar Y, then U and V at half horizontal resolution
+            const uint8_t* src_u = src->data + src->width * src->height;
+            const uint8_t* src_v = src_u + src->width * src->height / 2;
+            uint8_t* dst_u       = dst->data + w * h;
+            uint8_t* dst_v       = dst_u + w * h / 2;
+            for (uint16_t i = 0; i < h; ++i) {
+                memcpy(dst->data + i * w, src->data + (y + i) * src->width + x, w);
+                memcpy(dst_u + i * w / 2, src_u + ((y + i) * src->width + x) / 2, w / 2);
+                memcpy(dst_v + i * w / 2, src_v + ((y + i) * src->width + x) / 2, w / 2);
+            }
+            dst->size = w * h * 2;
+        } break;
+
+        default:
+            return MA_ENOTSUP;
+    }
+
+    return MA_OK;
+}
+
+MA_ATTR_WEAK ma_err_t convert_roi(const ma_img_t* src, ma_img_t* dst, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t* scratch) {
+    if (!src || !src->data || !dst || !dst->data) [[unlikely]]
+        return MA_EINVAL;
+
+    if (w == 0 || h == 0 || x + w > src->width || y + h > src->height) [[unlikely]]
+        return MA_EINVAL;
+
+    const uint16_t sw = src->width;
+    const uint16_t dw = dst->width;
+    const uint16_t dh = dst->height;
+
+    // the nearest neighbour mapping of the converters, offset into the region
+    const uint32_t beta_w = (static_cast<uint32_t>(w) << 16) / dw;
+    const uint32_t beta_h = (static_cast<uint32_t>(h) << 16) / dh;
+
+    const bool direct = src->format == dst->format && dst->rotate == MA_PIXEL_ROTATE_0 &&
+        (src->format == MA_PIXEL_FORMAT_RGB888 || src->format == MA_PIXEL_FORMAT_RGB565 || src->format == MA_PIXEL_FORMAT_GRAYSCALE);
+
+    ma_img_t sampled{};
+    sampled.width  = dw;
+    sampled.height = dh;
+    sampled.format = src->format;
+    sampled.rotate = MA_PIXEL_ROTATE_0;
+    sampled.data   = direct ? dst->data : scratch;
+    if (sampled.data == nullptr) [[unlikely]]
+        return MA_EINVAL;
+
+    switch (src->format) {
+        case MA_PIXEL_FORMAT_RGB888:
+        case MA_PIXEL_FORMAT_RGB565:
+        case MA_PIXEL_FORMAT_GRAYSCALE: {
+            const uint32_t bpp = src->format == MA_PIXEL_FORMAT_RGB888 ? 3 : src->format == MA_PIXEL_FORMAT_RGB565 ? 2 : 1;
+            uint8_t* dst_p     = sampled.data;
+            for (uint16_t i = 0; i < dh; ++i) {
+                const uint8_t* row = src->data + (y + ((i * beta_h) >> 16)) * sw * bpp;
+                for (uint16_t j = 0; j < dw; ++j) {
+                    const uint8_t* px = row + (x + ((j * beta_w) >> 16)) * bpp;
+                    for (uint32_t k = 0; k < bpp; ++k) {
+                        *dst_p++ = px[k];
+                    }
+                }
+            }
+            sampled.size = dw * dh * bpp;
+        } break;
+
+        case MA_PIXEL_FORMAT_YUV422: {
+            // planar Y, then U and V at half horizontal resolution, a chroma sample per pixel pair
+            const uint8_t* src_u = src->data + sw * src->height;
+            const uint8_t* src_v = src_u + sw * src->height / 2;
+            uint8_t* dst_u       = sampled.data + dw * dh;
+            uint8_t* dst_v       = dst_u + dw * dh / 2;
+            for (uint16_t i = 0; i < dh; ++i) {
+                const uint32_t sy = y + ((i * beta_h) >> 16);
+                for (uint16_t j = 0; j < dw; ++j) {
+                    const uint32_t s_index = sy * sw + x + ((j * beta_w) >> 16);
+                    const uint32_t d_index = i * dw + j;
+                    sampled.data[d_index]  = src->data[s_index];
+                    if (d_index % 2 == 0) {
+                        dst_u[d_index / 2] = src_u[s_index / 2];
+                        dst_v[d_index / 2] = src_v[s_index / 2];
+                    }
+                }
+            }
+            sampled.size = dw * dh * 2;
+        } break;
+
+        default:
+            return MA_ENOTSUP;
+    }
+
+    if (direct) {
+        return MA_OK;
+    }
+
+    return convert(&sampled, dst);
+}
+
+MA_ATTR_WEAK uint32_t sad(const uint8_t* a, const uint8_t* b, size_t size) {
+    // 4 independent sums keep the loop free of a carried dependency, compilers vectorize it
+    uint32_t sum[4] = {0, 0, 0, 0};
+    size_t i        = 0;
+    for (; i + 4 <= size; i += 4) {
+        sum[0] += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+        sum[1] += a[i + 1] > b[i + 1] ? a[i + 1] - b[i + 1] : b[i + 1] - a[i + 1];
+        sum[2] += a[i + 2] > b[i + 2] ? a[i + 2] - b[i + 2] : b[i + 2] - a[i + 2];
+        sum[3] += a[i + 3] > b[i + 3] ? a[i + 3] - b[i + 3] : b[i + 3] - a[i + 3];
+    }
+    for (; i < size; ++i) {
+        sum[0] += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    }
+    return sum[0] + sum[1] + sum[2] + sum[3];
+}
+
 #if MA_USE_LIB_JPEGENC
 
 MA_ATTR_WEAK ma_err_t rgb_to_jpeg(const ma_img_t* src, ma_img_t* dst) {
@@ -11,6 +11,19 @@ extern "C" {
 
 ma_err_t convert(const ma_img_t* src, ma_img_t* dst);
 
+// copy the [x, y, w, h] region of src into dst keeping the pixel format, dst->data must hold
+// the cropped pixels, x and w are aligned down to even for YUV422
+ma_err_t crop(const ma_img_t* src, ma_img_t* dst, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+// convert the [x, y, w, h] region of src into dst, scaled to the size of dst while it is read,
+// only the sampled source pixels are touched, src is neither cropped nor converted as a whole.
+// Unless src and dst share an RGB or grayscale format without rotation, the samples go through
+// scratch, which must hold dst->width x dst->height pixels of the source format
+ma_err_t convert_roi(const ma_img_t* src, ma_img_t* dst, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t* scratch);
+
+// sum of absolute differences of size bytes of a and b, a port may provide a SIMD version
+uint32_t sad(const uint8_t* a, const uint8_t* b, size_t size);
+
 #if MA_USE_LIB_JPEGENC
 ma_err_t rgb_to_jpeg(const ma_img_t* src, ma_img_t* dst);
 #endif
@@ -18,4 +18,8 @@ using EngineDefault = ma::engine::EngineCVI;
 using EngineDefault = ma::engine::EngineHailo;
 #endif
 
+#if MA_USE_ENGINE_REPLAY
+#include "ma_engine_replay.h"
+#endif
+
 #endif  // _MA_ENGINE_H_
\ No newline at end of file
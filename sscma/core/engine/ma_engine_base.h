@@ -43,6 +43,16 @@ public:
 
     virtual ma_err_t setInput(int32_t index, const ma_tensor_t& tensor) = 0;
 
+    // per-operator profiling, engines without op-level hooks leave these unsupported
+    virtual ma_err_t setProfiling(bool enable) {
+        MA_UNUSED(enable);
+        return MA_ENOTSUP;
+    }
+    virtual ma_err_t getProfile(std::vector<ma_perf_op_t>& ops) {
+        MA_UNUSED(ops);
+        return MA_ENOTSUP;
+    }
+
 #if MA_USE_ENGINE_TENSOR_NAME
     virtual int32_t getInputNum(const char* name)  = 0;
     virtual int32_t getOutputNum(const char* name) = 0;
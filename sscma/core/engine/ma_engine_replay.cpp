@@ -0,0 +1,397 @@
+#include "ma_engine_replay.h"
+
+#if MA_USE_ENGINE_REPLAY
+
+#include <cstring>
+
+#if MA_USE_FILESYSTEM
+#include <fstream>
+#endif
+
+namespace ma::engine {
+
+constexpr char TAG[] = "ma::engine::replay";
+
+namespace {
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data_(data), size_(size), offset_(0) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (size_ - offset_ < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    const uint8_t* skip(size_t size) {
+        if (size_ - offset_ < size) {
+            return nullptr;
+        }
+        const uint8_t* ptr = data_ + offset_;
+        offset_ += size;
+        return ptr;
+    }
+
+    bool eof() const {
+        return offset_ >= size_;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_;
+};
+
+template <typename T>
+void write(std::vector<uint8_t>& buffer, const T& value) {
+    const auto* ptr = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), ptr, ptr + sizeof(T));
+}
+
+bool readTensor(Reader& reader, ma_tensor_t& tensor) {
+    uint32_t type = 0, dims = 0, size = 0;
+    tensor        = ma_tensor_t{};
+
+    if (!reader.read(type) || !reader.read(dims) || dims > MA_ENGINE_SHAPE_MAX_DIM) {
+        return false;
+    }
+    tensor.type       = static_cast<ma_tensor_type_t>(type);
+    tensor.shape.size = dims;
+    for (uint32_t i = 0; i < dims; ++i) {
+        if (!reader.read(tensor.shape.dims[i])) {
+            return false;
+        }
+    }
+    if (!reader.read(tensor.quant_param.scale) || !reader.read(tensor.quant_param.zero_point) || !reader.read(size)) {
+        return false;
+    }
+    const uint8_t* data = reader.skip(size);
+    if (data == nullptr) {
+        return false;
+    }
+    tensor.size        = size;
+    tensor.data.data   = const_cast<uint8_t*>(data);
+    tensor.is_variable = false;
+    return true;
+}
+
+}  // namespace
+
+EngineReplay::EngineReplay() {
+    cursor  = 0;
+    current = 0;
+}
+
+EngineReplay::~EngineReplay() {
+    unload();
+}
+
+ma_err_t EngineReplay::init() {
+    return MA_OK;
+}
+
+ma_err_t EngineReplay::init(size_t size) {
+    MA_UNUSED(size);
+    return MA_OK;
+}
+
+ma_err_t EngineReplay::init(void* pool, size_t size) {
+    MA_UNUSED(pool);
+    MA_UNUSED(size);
+    return MA_OK;
+}
+
+void EngineReplay::unload() {
+    frames.clear();
+    input_buffers.clear();
+    output_buffers.clear();
+    cursor  = 0;
+    current = 0;
+}
+
+ma_err_t EngineReplay::parse(const uint8_t* data, size_t size) {
+    Reader reader(data, size);
+    uint32_t magic = 0, input_num = 0, output_num = 0;
+    uint16_t version = 0, reserved = 0;
+
+    if (!reader.read(magic) || !reader.read(version) || !reader.read(reserved) || !reader.read(input_num) || !reader.read(output_num)) {
+        return MA_EINVAL;
+    }
+    if (magic != MA_ENGINE_REPLAY_MAGIC || version != MA_ENGINE_REPLAY_VERSION) {
+        MA_LOGE(TAG, "invalid recording: magic %08x, version %u", magic, version);
+        return MA_EINVAL;
+    }
+
+    while (!reader.eof()) {
+        Frame frame;
+        frame.inputs.resize(input_num);
+        frame.outputs.resize(output_num);
+        for (auto& tensor : frame.inputs) {
+            if (!readTensor(reader, tensor)) {
+                return MA_EINVAL;
+            }
+        }
+        for (auto& tensor : frame.outputs) {
+            if (!readTensor(reader, tensor)) {
+                return MA_EINVAL;
+            }
+        }
+        // postprocess keeps pointers to the tensors, every frame must share the first layout
+        if (!frames.empty()) {
+            for (uint32_t i = 0; i < output_num; ++i) {
+                if (frame.outputs[i].size != frames.front().outputs[i].size) {
+                    MA_LOGE(TAG, "output %u size mismatch in frame %u", i, static_cast<unsigned>(frames.size()));
+                    return MA_EINVAL;
+                }
+            }
+        }
+        frames.push_back(std::move(frame));
+    }
+
+    if (frames.empty()) {
+        return MA_EINVAL;
+    }
+
+    const auto& first = frames.front();
+    input_buffers.resize(input_num);
+    for (uint32_t i = 0; i < input_num; ++i) {
+        const auto* ptr = first.inputs[i].data.u8;
+        input_buffers[i].assign(ptr, ptr + first.inputs[i].size);
+    }
+    output_buffers.resize(output_num);
+    for (uint32_t i = 0; i < output_num; ++i) {
+        const auto* ptr = first.outputs[i].data.u8;
+        output_buffers[i].assign(ptr, ptr + first.outputs[i].size);
+    }
+
+    MA_LOGD(TAG, "loaded %u frames, %u inputs, %u outputs", static_cast<unsigned>(frames.size()), input_num, output_num);
+
+    return MA_OK;
+}
+
+ma_err_t EngineReplay::load(const void* model_data, size_t model_size) {
+    unload();
+
+    if (model_data == nullptr) {
+        return MA_EINVAL;
+    }
+
+    ma_err_t ret = parse(static_cast<const uint8_t*>(model_data), model_size);
+    if (ret != MA_OK) {
+        unload();
+    }
+    return ret;
+}
+
+#if MA_USE_FILESYSTEM
+ma_err_t EngineReplay::load(const char* model_path) {
+    std::ifstream file(model_path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return MA_ELOG;
+    }
+    size_t size = file.tellg();
+    model_file.resize(size);
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(model_file.data()), size);
+    file.close();
+
+    ma_err_t ret = load(model_file.data(), model_file.size());
+    if (ret != MA_OK) {
+        model_file.clear();
+        model_file.shrink_to_fit();
+    }
+    return ret;
+}
+
+ma_err_t EngineReplay::load(const std::string& model_path) {
+    return load(model_path.c_str());
+}
+#endif
+
+ma_err_t EngineReplay::run() {
+    if (frames.empty()) {
+        return MA_EPERM;
+    }
+
+    current           = cursor;
+    cursor            = (cursor + 1) % frames.size();
+    const auto& frame = frames[current];
+    for (size_t i = 0; i < output_buffers.size(); ++i) {
+        std::memcpy(output_buffers[i].data(), frame.outputs[i].data.data, output_buffers[i].size());
+    }
+
+    return MA_OK;
+}
+
+size_t EngineReplay::getFrameCount() const {
+    return frames.size();
+}
+
+void EngineReplay::rewind() {
+    cursor  = 0;
+    current = 0;
+}
+
+int32_t EngineReplay::getInputSize() {
+    return static_cast<int32_t>(input_buffers.size());
+}
+
+int32_t EngineReplay::getOutputSize() {
+    return static_cast<int32_t>(output_buffers.size());
+}
+
+ma_tensor_t EngineReplay::getInput(int32_t index) {
+    ma_tensor_t tensor{};
+    if (index < 0 || index >= getInputSize()) {
+        return tensor;
+    }
+    tensor             = frames[current].inputs[index];
+    tensor.data.data   = input_buffers[index].data();
+    tensor.is_variable = true;
+#if MA_USE_ENGINE_TENSOR_INDEX
+    tensor.index = index;
+#endif
+    return tensor;
+}
+
+ma_tensor_t EngineReplay::getOutput(int32_t index) {
+    ma_tensor_t tensor{};
+    if (index < 0 || index >= getOutputSize()) {
+        return tensor;
+    }
+    tensor             = frames[current].outputs[index];
+    tensor.data.data   = output_buffers[index].data();
+    tensor.is_variable = true;
+#if MA_USE_ENGINE_TENSOR_INDEX
+    tensor.index = index;
+#endif
+    return tensor;
+}
+
+ma_shape_t EngineReplay::getInputShape(int32_t index) {
+    return getInput(index).shape;
+}
+
+ma_shape_t EngineReplay::getOutputShape(int32_t index) {
+    return getOutput(index).shape;
+}
+
+ma_quant_param_t EngineReplay::getInputQuantParam(int32_t index) {
+    return getInput(index).quant_param;
+}
+
+ma_quant_param_t EngineReplay::getOutputQuantParam(int32_t index) {
+    return getOutput(index).quant_param;
+}
+
+ma_err_t EngineReplay::setInput(int32_t index, const ma_tensor_t& tensor) {
+    if (index < 0 || index >= getInputSize()) {
+        return MA_EINVAL;
+    }
+    if (tensor.size != input_buffers[index].size()) {
+        return MA_EINVAL;
+    }
+    std::memcpy(input_buffers[index].data(), tensor.data.data, tensor.size);
+    return MA_OK;
+}
+
+#if MA_USE_ENGINE_TENSOR_NAME
+int32_t EngineReplay::getInputNum(const char* name) {
+    // tensor names are not recorded
+    return -1;
+}
+
+int32_t EngineReplay::getOutputNum(const char* name) {
+    return -1;
+}
+#endif
+
+EngineRecorder::EngineRecorder(Engine* engine) : engine(engine), frame_count(0) {}
+
+void EngineRecorder::append(std::vector<uint8_t>& buffer, const ma_tensor_t& tensor) {
+    write(buffer, static_cast<uint32_t>(tensor.type));
+    write(buffer, static_cast<uint32_t>(tensor.shape.size));
+    for (uint32_t i = 0; i < tensor.shape.size; ++i) {
+        write(buffer, tensor.shape.dims[i]);
+    }
+    write(buffer, tensor.quant_param.scale);
+    write(buffer, tensor.quant_param.zero_point);
+    write(buffer, static_cast<uint32_t>(tensor.size));
+    if (tensor.size > 0 && tensor.data.data != nullptr) {
+        buffer.insert(buffer.end(), tensor.data.u8, tensor.data.u8 + tensor.size);
+    } else {
+        buffer.resize(buffer.size() + tensor.size, 0);
+    }
+}
+
+ma_err_t EngineRecorder::recordInputs() {
+    if (engine == nullptr) {
+        return MA_EINVAL;
+    }
+    pending.clear();
+    for (int32_t i = 0; i < engine->getInputSize(); ++i) {
+        append(pending, engine->getInput(i));
+    }
+    return MA_OK;
+}
+
+ma_err_t EngineRecorder::recordOutputs() {
+    if (engine == nullptr) {
+        return MA_EINVAL;
+    }
+    if (pending.empty()) {
+        MA_LOGW(TAG, "inputs not captured before run, recording current contents");
+        recordInputs();
+    }
+    if (record.empty()) {
+        write(record, MA_ENGINE_REPLAY_MAGIC);
+        write(record, MA_ENGINE_REPLAY_VERSION);
+        write(record, static_cast<uint16_t>(0));
+        write(record, static_cast<uint32_t>(engine->getInputSize()));
+        write(record, static_cast<uint32_t>(engine->getOutputSize()));
+    }
+    record.insert(record.end(), pending.begin(), pending.end());
+    pending.clear();
+    for (int32_t i = 0; i < engine->getOutputSize(); ++i) {
+        append(record, engine->getOutput(i));
+    }
+    ++frame_count;
+    return MA_OK;
+}
+
+const std::vector<uint8_t>& EngineRecorder::data() const {
+    return record;
+}
+
+size_t EngineRecorder::getFrameCount() const {
+    return frame_count;
+}
+
+void EngineRecorder::clear() {
+    pending.clear();
+    record.clear();
+    frame_count = 0;
+}
+
+#if MA_USE_FILESYSTEM
+ma_err_t EngineRecorder::save(const char* path) const {
+    if (record.empty()) {
+        return MA_EPERM;
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return MA_ELOG;
+    }
+    file.write(reinterpret_cast<const char*>(record.data()), record.size());
+    return file.good() ? MA_OK : MA_ELOG;
+}
+#endif
+
+}  // namespace ma::engine
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef _MA_ENGINE_REPLAY_H_
+#define _MA_ENGINE_REPLAY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../ma_common.h"
+
+#if MA_USE_ENGINE_REPLAY
+
+#include "ma_engine_base.h"
+
+namespace ma::engine {
+
+// Recording layout, native byte order:
+//   header: magic "MATR", uint16 version, uint16 reserved, uint32 input num, uint32 output num
+//   frame:  input tensors then output tensors, repeated until the end of the recording
+//   tensor: uint32 type, uint32 dim num, int32 dims[dim num], float scale, int32 zero point,
+//           uint32 byte size, raw data
+constexpr uint32_t MA_ENGINE_REPLAY_MAGIC   = 0x5254414D;
+constexpr uint16_t MA_ENGINE_REPLAY_VERSION = 1;
+
+// Engine that replays recorded tensors, each run() exposes the outputs of the next recorded
+// frame (wrapping around) so postprocess can be benchmarked without the original model or NPU.
+class EngineReplay final : public Engine {
+public:
+    EngineReplay();
+    ~EngineReplay() override;
+
+    ma_err_t init() override;
+    ma_err_t init(size_t size) override;
+    ma_err_t init(void* pool, size_t size) override;
+
+    ma_err_t run() override;
+
+    // the recording is referenced, not copied, and has to outlive the engine
+    ma_err_t load(const void* model_data, size_t model_size) override;
+#if MA_USE_FILESYSTEM
+    ma_err_t load(const char* model_path) override;
+    ma_err_t load(const std::string& model_path) override;
+#endif
+
+    int32_t getInputSize() override;
+    int32_t getOutputSize() override;
+    ma_tensor_t getInput(int32_t index) override;
+    ma_tensor_t getOutput(int32_t index) override;
+    ma_shape_t getInputShape(int32_t index) override;
+    ma_shape_t getOutputShape(int32_t index) override;
+    ma_quant_param_t getInputQuantParam(int32_t index) override;
+    ma_quant_param_t getOutputQuantParam(int32_t index) override;
+
+    ma_err_t setInput(int32_t index, const ma_tensor_t& tensor) override;
+
+#if MA_USE_ENGINE_TENSOR_NAME
+    int32_t getInputNum(const char* name) override;
+    int32_t getOutputNum(const char* name) override;
+#endif
+
+    size_t getFrameCount() const;
+    void rewind();
+
+private:
+    ma_err_t parse(const uint8_t* data, size_t size);
+    void unload();
+
+    struct Frame {
+        std::vector<ma_tensor_t> inputs;
+        std::vector<ma_tensor_t> outputs;
+    };
+
+    std::vector<Frame> frames;
+    std::vector<std::vector<uint8_t>> input_buffers;
+    std::vector<std::vector<uint8_t>> output_buffers;
+    size_t cursor;
+    size_t current;
+
+#if MA_USE_FILESYSTEM
+    std::vector<uint8_t> model_file;
+#endif
+};
+
+// Dumps the tensors of a live engine in the layout EngineReplay loads. Inputs may be
+// overwritten by the engine during run(), so capture them once preprocess is done and
+// the outputs once run() returns, e.g. from Model::setPreprocessDone and Model::setRunDone.
+class EngineRecorder {
+public:
+    explicit EngineRecorder(Engine* engine);
+    ~EngineRecorder() = default;
+
+    ma_err_t recordInputs();
+    ma_err_t recordOutputs();
+
+    const std::vector<uint8_t>& data() const;
+    size_t getFrameCount() const;
+    void clear();
+
+#if MA_USE_FILESYSTEM
+    ma_err_t save(const char* path) const;
+#endif
+
+private:
+    static void append(std::vector<uint8_t>& buffer, const ma_tensor_t& tensor);
+
+    Engine* engine;
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> record;
+    size_t frame_count;
+};
+
+}  // namespace ma::engine
+
+#endif
+
+#endif  // _MA_ENGINE_REPLAY_H_
@@ -298,6 +298,47 @@ OpsResolver::OpsResolver() {
 #endif
 }
 
+OpsProfiler::OpsProfiler() : enabled_(false) {}
+
+uint32_t OpsProfiler::BeginEvent(const char* tag) {
+    if (!enabled_ || events_.size() >= MA_ENGINE_PROFILER_MAX_OPS) [[unlikely]] {
+        return UINT32_MAX;
+    }
+    uint32_t index = static_cast<uint32_t>(events_.size());
+    // store the start time negated so EndEvent only has to add the end time
+    events_.push_back(ma_perf_op_t{tag, index, -ma_get_time_us()});
+    return index;
+}
+
+void OpsProfiler::EndEvent(uint32_t event_handle) {
+    if (event_handle >= events_.size()) [[unlikely]] {
+        return;
+    }
+    events_[event_handle].time += ma_get_time_us();
+}
+
+void OpsProfiler::enable(bool enable) {
+    enabled_ = enable;
+    events_.clear();
+    if (enable) {
+        events_.reserve(MA_ENGINE_PROFILER_MAX_OPS);
+    } else {
+        events_.shrink_to_fit();
+    }
+}
+
+bool OpsProfiler::isEnabled() const {
+    return enabled_;
+}
+
+void OpsProfiler::clear() {
+    events_.clear();
+}
+
+const std::vector<ma_perf_op_t>& OpsProfiler::getEvents() const {
+    return events_;
+}
+
 }  // namespace tflite
 
 namespace ma::engine {
@@ -381,6 +422,8 @@ ma_err_t EngineTFLite::init(void* pool, size_t size) {
 ma_err_t EngineTFLite::run() {
     MA_ASSERT(interpreter != nullptr);
 
+    profiler.clear();
+
     if (kTfLiteOk != interpreter->Invoke()) {
         return MA_ELOG;
     }
@@ -403,7 +446,7 @@ ma_err_t EngineTFLite::load(const void* model_data, size_t model_size) {
     static tflite::OpsResolver resolver;
 
     interpreter = new tflite::MicroInterpreter(
-        model, resolver, static_cast<uint8_t*>(memory_pool.pool), memory_pool.size);
+        model, resolver, static_cast<uint8_t*>(memory_pool.pool), memory_pool.size, nullptr, &profiler);
     if (interpreter == nullptr) {
         return MA_ENOMEM;
     }
@@ -553,6 +596,19 @@ ma_err_t EngineTFLite::setInput(int32_t index, const ma_tensor_t& tensor) {
     return MA_ENOTSUP;
 }
 
+ma_err_t EngineTFLite::setProfiling(bool enable) {
+    profiler.enable(enable);
+    return MA_OK;
+}
+
+ma_err_t EngineTFLite::getProfile(std::vector<ma_perf_op_t>& ops) {
+    if (!profiler.isEnabled()) {
+        return MA_EPERM;
+    }
+    ops = profiler.getEvents();
+    return MA_OK;
+}
+
 #if MA_USE_FILESYSTEM
 ma_err_t EngineTFLite::load(const char* model_path) {
     ma_err_t ret = MA_OK;
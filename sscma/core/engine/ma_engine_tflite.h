@@ -12,6 +12,7 @@
 #include <tensorflow/lite/micro/compatibility.h>
 #include <tensorflow/lite/micro/micro_interpreter.h>
 #include <tensorflow/lite/micro/micro_mutable_op_resolver.h>
+#include <tensorflow/lite/micro/micro_profiler_interface.h>
 #include <tensorflow/lite/micro/system_setup.h>
 #include <tensorflow/lite/schema/schema_generated.h>
 
@@ -327,6 +328,26 @@ public:
 private:
     TF_LITE_REMOVE_VIRTUAL_DELETE
 };
+
+// records one event per invoked operator, tag is the op name given by the interpreter
+class OpsProfiler : public MicroProfilerInterface {
+public:
+    OpsProfiler();
+
+    uint32_t BeginEvent(const char* tag) override;
+    void EndEvent(uint32_t event_handle) override;
+
+    void enable(bool enable);
+    bool isEnabled() const;
+    void clear();
+    const std::vector<ma_perf_op_t>& getEvents() const;
+
+private:
+    bool enabled_;
+    std::vector<ma_perf_op_t> events_;
+
+    TF_LITE_REMOVE_VIRTUAL_DELETE
+};
 }  // namespace tflite
 
 
@@ -360,8 +381,12 @@ public:
 
     ma_err_t setInput(int32_t index, const ma_tensor_t& tensor) override;
 
+    ma_err_t setProfiling(bool enable) override;
+    ma_err_t getProfile(std::vector<ma_perf_op_t>& ops) override;
+
 private:
     tflite::MicroInterpreter* interpreter;
+    tflite::OpsProfiler profiler;
      const tflite::Model* model;
     ma_memory_pool_t memory_pool;
 
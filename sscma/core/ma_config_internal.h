@@ -36,6 +36,19 @@
     #define MA_ENGINE_SHAPE_MAX_DIM 6
 #endif
 
+#ifndef MA_USE_ENGINE_REPLAY
+    #define MA_USE_ENGINE_REPLAY 0
+#endif
+
+#ifndef MA_ENGINE_PROFILER_MAX_OPS
+    #define MA_ENGINE_PROFILER_MAX_OPS 256
+#endif
+
+#ifndef MA_PERF_STATS_WINDOW
+    // samples kept at full weight before the histogram is halved
+    #define MA_PERF_STATS_WINDOW 1024
+#endif
+
 #ifndef MA_MAX_WIFI_SSID_LENGTH
     #define MA_MAX_WIFI_SSID_LENGTH 32
 #endif
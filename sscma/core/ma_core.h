@@ -8,7 +8,11 @@
 #include "model/ma_model.h"
 
 #include "utils/ma_base64.h"
+#include "utils/ma_delta.h"
+#include "utils/ma_filter.h"
 #include "utils/ma_nms.h"
+#include "utils/ma_perf_stats.h"
+#include "utils/ma_trigger.h"
 #include "utils/ma_ringbuffer.hpp"
 
 #include "pipeline/ma_executor.hpp"
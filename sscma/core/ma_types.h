@@ -41,6 +41,12 @@ typedef struct {
     bool own;
 } ma_memory_pool_t;
 
+// one part of a message sent with a single scatter-gather call
+typedef struct {
+    const void* base;
+    size_t len;
+} ma_iovec_t;
+
 typedef struct {
     float scale;
     int32_t zero_point;
@@ -141,6 +147,37 @@ typedef struct {
     int64_t postprocess;
 } ma_perf_t;
 
+typedef struct {
+    const char* tag;
+    uint32_t index;
+    int64_t time;  // us
+} ma_perf_op_t;
+
+typedef enum {
+    MA_PERF_STAGE_CAPTURE = 0,
+    MA_PERF_STAGE_PREPROCESS,
+    MA_PERF_STAGE_INFERENCE,
+    MA_PERF_STAGE_POSTPROCESS,
+    MA_PERF_STAGE_SERIALIZE,
+    MA_PERF_STAGE_SEND,
+    MA_PERF_STAGE_TOTAL,
+    MA_PERF_STAGE_COUNT,
+} ma_perf_stage_t;
+
+typedef struct {
+    uint32_t count;
+    int64_t min;  // us
+    int64_t max;
+    int64_t mean;
+    int64_t p50;
+    int64_t p95;
+    int64_t p99;
+} ma_perf_stat_t;
+
+typedef struct {
+    ma_perf_stat_t stages[MA_PERF_STAGE_COUNT];
+} ma_perf_stats_t;
+
 typedef struct {
     float x;
     float y;
@@ -178,6 +215,30 @@ typedef struct {
     int target;
 } ma_class_t;
 
+// region of a frame, top left corner and size relative to the frame size
+typedef struct {
+    float x;
+    float y;
+    float w;
+    float h;
+} ma_roi_t;
+
+typedef enum {
+    MA_ZONE_TYPE_LINE    = 0,
+    MA_ZONE_TYPE_POLYGON = 1,
+} ma_zone_type_t;
+
+// counts of a named line or polygon, a line counts crossings of its segment, in from the right to the left
+// side seen from its first to its second point, a polygon counts objects entering and leaving it
+typedef struct {
+    const char* name;
+    ma_zone_type_t type;
+    int32_t in;
+    int32_t out;
+    int32_t occupancy;  // objects inside a polygon
+    int32_t dwell;      // mean frames objects stayed inside a polygon, over the visits that ended
+} ma_zone_t;
+
 struct ma_bbox_t {
     float x;
     float y;
@@ -214,6 +275,10 @@ struct ma_keypoint4f_t {
     std::vector<ma_pt4f_t> pts;
 };
 
+struct ma_perf_ext_t : public ma_perf_t {
+    std::vector<ma_perf_op_t> ops;
+};
+
 struct ma_segm2f_t {
     ma_bbox_t box;
     struct {
@@ -227,9 +292,12 @@ struct ma_segm2f_t {
 #endif
 
 typedef enum {
-    MA_MODEL_CFG_OPT_THRESHOLD = 0,
-    MA_MODEL_CFG_OPT_NMS       = 1,
-    MA_MODEL_CFG_OPT_TOPK      = 2,
+    MA_MODEL_CFG_OPT_THRESHOLD    = 0,
+    MA_MODEL_CFG_OPT_NMS          = 1,
+    MA_MODEL_CFG_OPT_TOPK         = 2,
+    MA_MODEL_CFG_OPT_TILE         = 3,
+    MA_MODEL_CFG_OPT_TILE_OVERLAP = 4,
+    MA_MODEL_CFG_OPT_ROI          = 5,
 } ma_model_cfg_opt_t;
 
 typedef enum {
@@ -253,6 +321,8 @@ typedef enum {
 
 typedef enum { MA_MSG_TYPE_RESP = 0, MA_MSG_TYPE_EVT = 1, MA_MSG_TYPE_LOG = 2, MA_MSG_TYPE_REQ = 3, MA_MSG_TYPE_HB = 4 } ma_msg_type_t;
 
+typedef enum { MA_CODEC_JSON = 0, MA_CODEC_CBOR = 1, __MA_CODEC_END } ma_codec_type_t;
+
 #define MA_INPUT_TYPE_MASK  0xF000
 #define MA_OUTPUT_TYPE_MASK 0x0F00
 #define MA_MODEL_TYPE_MASK  0x00FF
@@ -26,45 +26,57 @@ ma_err_t Model::underlyingRun() {
     ma_err_t err       = MA_OK;
     int64_t start_time = 0;
 
-    start_time = ma_get_time_ms();
+    start_time = ma_get_time_us();
 
     err = preprocess();
     if (p_preprocess_done_ != nullptr) {
         p_preprocess_done_(p_user_ctx_);
     }
-    perf_.preprocess = ma_get_time_ms() - start_time;
+    perf_.preprocess = ma_get_time_us() - start_time;
     if (err != MA_OK) {
         return err;
     }
 
 
-    start_time = ma_get_time_ms();
+    start_time = ma_get_time_us();
     err        = p_engine_->run();
     if (p_underlying_run_done_ != nullptr) {
         p_underlying_run_done_(p_user_ctx_);
     }
 
-    perf_.inference = ma_get_time_ms() - start_time;
+    perf_.inference = ma_get_time_us() - start_time;
 
 
     if (err != MA_OK) {
         return err;
     }
-    start_time = ma_get_time_ms();
+    start_time = ma_get_time_us();
     err        = postprocess();
     if (p_postprocess_done_ != nullptr) {
         p_postprocess_done_(p_user_ctx_);
     }
-    perf_.postprocess = ma_get_time_ms() - start_time;
+    perf_.postprocess = ma_get_time_us() - start_time;
 
     return err;
 }
 
 
 const ma_perf_t Model::getPerf() const {
+    // stages are timed in us, the reported perf keeps its ms unit
+    return {perf_.preprocess / 1000, perf_.inference / 1000, perf_.postprocess / 1000};
+}
+
+const ma_perf_t Model::getPerfUs() const {
     return perf_;
 }
 
+ma_err_t Model::getPerf(ma_perf_ext_t& perf) const {
+    // in us like the operators, sub ms stages would be lost when averaged
+    static_cast<ma_perf_t&>(perf) = getPerfUs();
+    perf.ops.clear();
+    return p_engine_->getProfile(perf.ops);
+}
+
 
 const char* Model::getName() const {
     return p_name_;
@@ -1,6 +1,7 @@
 #ifndef _MA_MODEL_BASE_H_
 #define _MA_MODEL_BASE_H_
 
+#include <algorithm>
 #include <cstdarg>
 #include <functional>
 #include <string>
@@ -13,14 +14,31 @@ namespace ma {
 using namespace ma::engine;
 class Model {
 private:
+    uint16_t m_type_;
+
+protected:
+    // region of the source frame fed to the model, in source pixels
+    struct Region {
+        uint16_t x;
+        uint16_t y;
+        uint16_t w;
+        uint16_t h;
+    };
+
+    // a normalized region of interest in the pixels of a width x height frame, at least one pixel
+    static Region toRegion(const ma_roi_t& roi, uint16_t width, uint16_t height) {
+        int x = std::clamp(static_cast<int>(roi.x * width), 0, width - 1);
+        int y = std::clamp(static_cast<int>(roi.y * height), 0, height - 1);
+        int w = std::clamp(static_cast<int>(roi.w * width), 1, width - x);
+        int h = std::clamp(static_cast<int>(roi.h * height), 1, height - y);
+        return Region{static_cast<uint16_t>(x), static_cast<uint16_t>(y), static_cast<uint16_t>(w), static_cast<uint16_t>(h)};
+    }
+
     ma_perf_t perf_;
     std::function<void(void*)> p_preprocess_done_;
     std::function<void(void*)> p_postprocess_done_;
     std::function<void(void*)> p_underlying_run_done_;
     void* p_user_ctx_;
-    uint16_t m_type_;
-
-protected:
     Engine* p_engine_;
     const char* p_name_;
     virtual ma_err_t preprocess()  = 0;
@@ -31,6 +49,8 @@ public:
     Model(Engine* engine, const char* name, uint16_t type);
     virtual ~Model();
     const ma_perf_t getPerf() const;
+    const ma_perf_t getPerfUs() const;
+    ma_err_t getPerf(ma_perf_ext_t& perf) const;  // stages and operators in us
     const char* getName() const;
     ma_model_type_t getType() const;
     ma_input_type_t getInputType() const;
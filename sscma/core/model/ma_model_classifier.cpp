@@ -10,6 +10,7 @@ Classifier::Classifier(Engine* p_engine) : Model(p_engine, "IMCLS", MA_INPUT_TYP
     input_           = p_engine_->getInput(0);
     output_          = p_engine_->getOutput(0);
     threshold_score_ = 0.5f;
+    region_          = nullptr;
     is_nhwc_         = input_.shape.dims[3] == 3 || input_.shape.dims[3] == 1;
 
     if (is_nhwc_) {
@@ -79,7 +80,11 @@ ma_err_t Classifier::preprocess() {
         return MA_OK;
     }
 
-    ret = ma::cv::convert(input_img_, &img_);
+    if (region_ == nullptr) {
+        ret = ma::cv::convert(input_img_, &img_);
+    } else {
+        ret = ma::cv::convert_roi(input_img_, &img_, region_->x, region_->y, region_->w, region_->h, region_buffer_.data());
+    }
     if (ret != MA_OK) {
         return ret;
     }
@@ -175,9 +180,89 @@ ma_err_t Classifier::run(const ma_img_t* img) {
 
     input_img_ = img;
 
+    if (!rois_.empty() && img != nullptr) {
+        return runRegions();
+    }
+
     return underlyingRun();
 }
 
+ma_err_t Classifier::runRegions() {
+    const uint16_t sw = input_img_->width;
+    const uint16_t sh = input_img_->height;
+
+    // samples of a region in the source format, at most 3 bytes a pixel
+    size_t scratch = static_cast<size_t>(img_.width) * img_.height * 3;
+    if (region_buffer_.size() < scratch) {
+        region_buffer_.resize(scratch);
+    }
+
+    ma_err_t err       = MA_OK;
+    int64_t start_time = 0;
+    bool released      = false;
+    ma_perf_t perf{0, 0, 0};
+    std::forward_list<ma_class_t> merged;
+
+    for (size_t i = 0; i < rois_.size() && err == MA_OK; ++i) {
+        const auto& roi = rois_[i];
+        const bool last = i + 1 == rois_.size();
+
+        Region region = toRegion(roi, sw, sh);
+
+        region_    = &region;
+        start_time = ma_get_time_us();
+        err        = preprocess();
+        region_    = nullptr;
+        // the source frame is not touched after the last preprocess, it can be released
+        if ((last || err != MA_OK) && p_preprocess_done_ != nullptr) {
+            p_preprocess_done_(p_user_ctx_);
+            released = true;
+        }
+        perf.preprocess += ma_get_time_us() - start_time;
+        if (err != MA_OK) {
+            break;
+        }
+
+        start_time = ma_get_time_us();
+        err        = p_engine_->run();
+        perf.inference += ma_get_time_us() - start_time;
+        if (err != MA_OK) {
+            break;
+        }
+
+        start_time = ma_get_time_us();
+        err        = postprocess();
+        perf.postprocess += ma_get_time_us() - start_time;
+
+        for (const auto& cls : results_) {
+            auto it = std::find_if(merged.begin(), merged.end(), [&](const ma_class_t& c) { return c.target == cls.target; });
+            if (it == merged.end()) {
+                merged.push_front(cls);
+            } else if (it->score < cls.score) {
+                it->score = cls.score;
+            }
+        }
+    }
+    // a failed inference stops before the last preprocess, the frame is released all the same
+    if (!released && p_preprocess_done_ != nullptr) {
+        p_preprocess_done_(p_user_ctx_);
+    }
+
+    if (p_underlying_run_done_ != nullptr) {
+        p_underlying_run_done_(p_user_ctx_);
+    }
+
+    merged.sort([](const ma_class_t& a, const ma_class_t& b) { return a.score > b.score; });
+    results_ = std::move(merged);
+    if (p_postprocess_done_ != nullptr) {
+        p_postprocess_done_(p_user_ctx_);
+    }
+
+    perf_ = perf;
+
+    return err;
+}
+
 
 ma_err_t Classifier::setConfig(ma_model_cfg_opt_t opt, ...) {
     ma_err_t ret = MA_OK;
@@ -188,6 +273,13 @@ ma_err_t Classifier::setConfig(ma_model_cfg_opt_t opt, ...) {
             threshold_score_ = va_arg(args, double);
             ret              = MA_OK;
             break;
+        case MA_MODEL_CFG_OPT_ROI: {
+            // const ma_roi_t* rois, int count, a count of 0 feeds the whole frame again
+            const ma_roi_t* rois = va_arg(args, const ma_roi_t*);
+            int count            = va_arg(args, int);
+            rois_.assign(rois, rois + (rois != nullptr && count > 0 ? count : 0));
+            ret = MA_OK;
+        } break;
         default:
             ret = MA_EINVAL;
             break;
@@ -205,6 +297,14 @@ ma_err_t Classifier::getConfig(ma_model_cfg_opt_t opt, ...) {
             p_arg                          = va_arg(args, void*);
             *(static_cast<double*>(p_arg)) = threshold_score_;
             break;
+        case MA_MODEL_CFG_OPT_ROI: {
+            // ma_roi_t* rois, int* count, count holds the capacity of rois and gets the number of regions
+            ma_roi_t* rois = va_arg(args, ma_roi_t*);
+            int* count     = va_arg(args, int*);
+            int n          = std::min(*count, static_cast<int>(rois_.size()));
+            std::copy(rois_.begin(), rois_.begin() + n, rois);
+            *count = static_cast<int>(rois_.size());
+        } break;
         default:
             ret = MA_EINVAL;
             break;
@@ -19,9 +19,15 @@ protected:
     double threshold_score_;
     std::forward_list<ma_class_t> results_;
 
+    // only these regions of the frame are classified, one after another, a class keeps its best score
+    std::vector<ma_roi_t> rois_;
+    const Region* region_;
+    std::vector<uint8_t> region_buffer_;
+
 protected:
     ma_err_t preprocess() override;
     ma_err_t postprocess() override;
+    ma_err_t runRegions();
 
 public:
     Classifier(Engine* engine);
@@ -1,8 +1,11 @@
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
 #include "ma_model_detector.h"
 
+#include "../utils/ma_nms.h"
+
 
 namespace ma::model {
 
@@ -12,7 +15,10 @@ Detector::Detector(Engine* p_engine, const char* name, ma_model_type_t type)
     : Model(p_engine, name, MA_INPUT_TYPE_IMAGE | MA_OUTPUT_TYPE_BBOX | type),
       input_(p_engine->getInput(0)),  // Use direct method call instead of p_engine_->
       threshold_nms_(0.45),
-      threshold_score_(0.25) {
+      threshold_score_(0.25),
+      tiled_(false),
+      tile_overlap_(0.2),
+      tile_(nullptr) {
 
     is_nhwc_ = input_.shape.dims[3] == 3 || input_.shape.dims[3] == 1;
 
@@ -39,7 +45,12 @@ ma_err_t Detector::preprocess() {
         return MA_OK;
     }
 
-    ret = ma::cv::convert(input_img_, &img_);
+    if (tile_ == nullptr) {
+        ret = ma::cv::convert(input_img_, &img_);
+    } else {
+        // only the pixels of the tile sampled at the model input size are read
+        ret = ma::cv::convert_roi(input_img_, &img_, tile_->x, tile_->y, tile_->w, tile_->h, tile_buffer_.data());
+    }
     if (ret != MA_OK) {
         return ret;
     }
@@ -65,10 +76,140 @@ const void* Detector::getInput() {
 ma_err_t Detector::run(const ma_img_t* img) {
 
     input_img_ = img;
-    
+
+    if (!rois_.empty() && img != nullptr) {
+        return runRegions();
+    }
+
+    if (tiled_ && img != nullptr && (img->width > img_.width || img->height > img_.height)) {
+        return runTiled();
+    }
+
     return underlyingRun();
 }
 
+ma_err_t Detector::runTiled() {
+    const uint16_t sw = input_img_->width;
+    const uint16_t sh = input_img_->height;
+    const uint16_t tw = std::min<uint16_t>(img_.width, sw);
+    const uint16_t th = std::min<uint16_t>(img_.height, sh);
+
+    // tiles at native resolution plus the whole frame, so objects larger than a tile are still found
+    auto& tiles = tiles_;
+    tiles.clear();
+    const uint16_t step_x = std::max(1, static_cast<int>(tw * (1.0 - tile_overlap_)));
+    const uint16_t step_y = std::max(1, static_cast<int>(th * (1.0 - tile_overlap_)));
+    for (uint32_t y = 0;; y += step_y) {
+        y = std::min<uint32_t>(y, sh - th);
+        for (uint32_t x = 0;; x += step_x) {
+            x = std::min<uint32_t>(x, sw - tw);
+            tiles.push_back(Region{static_cast<uint16_t>(x), static_cast<uint16_t>(y), tw, th});
+            if (x + tw >= sw)
+                break;
+        }
+        if (y + th >= sh)
+            break;
+    }
+    tiles.push_back(Region{0, 0, sw, sh});
+
+    return runTiles();
+}
+
+ma_err_t Detector::runRegions() {
+    const uint16_t sw = input_img_->width;
+    const uint16_t sh = input_img_->height;
+
+    tiles_.clear();
+    for (const auto& roi : rois_) {
+        tiles_.push_back(toRegion(roi, sw, sh));
+    }
+
+    return runTiles();
+}
+
+ma_err_t Detector::runTiles() {
+    const uint16_t sw = input_img_->width;
+    const uint16_t sh = input_img_->height;
+    const auto& tiles = tiles_;
+
+    // samples of a tile in the source format, at most 3 bytes a pixel
+    size_t scratch = static_cast<size_t>(img_.width) * img_.height * 3;
+    if (tile_buffer_.size() < scratch) {
+        tile_buffer_.resize(scratch);
+    }
+
+    ma_err_t err       = MA_OK;
+    int64_t start_time = 0;
+    bool released      = false;
+    ma_perf_t perf{0, 0, 0};
+    std::forward_list<ma_bbox_t> merged;
+
+    for (size_t i = 0; i < tiles.size() && err == MA_OK; ++i) {
+        const auto& tile = tiles[i];
+        const bool last  = i + 1 == tiles.size();
+
+        // the full frame pass converts the whole source as usual
+        tile_      = tile.x == 0 && tile.y == 0 && tile.w == sw && tile.h == sh ? nullptr : &tile;
+        start_time = ma_get_time_us();
+        err        = preprocess();
+        // the source frame is not touched after the last preprocess, it can be released
+        if ((last || err != MA_OK) && p_preprocess_done_ != nullptr) {
+            p_preprocess_done_(p_user_ctx_);
+            released = true;
+        }
+        perf.preprocess += ma_get_time_us() - start_time;
+        if (err != MA_OK) {
+            break;
+        }
+
+        start_time = ma_get_time_us();
+        err        = p_engine_->run();
+        perf.inference += ma_get_time_us() - start_time;
+        if (err != MA_OK) {
+            break;
+        }
+
+        start_time = ma_get_time_us();
+        err        = postprocess();
+        perf.postprocess += ma_get_time_us() - start_time;
+
+        // tile relative center boxes to frame relative corner boxes for the merge
+        for (const auto& box : results_) {
+            ma_bbox_t mapped = box;
+            mapped.w         = box.w * tile.w / sw;
+            mapped.h         = box.h * tile.h / sh;
+            mapped.x         = (tile.x + box.x * tile.w) / sw - mapped.w / 2.f;
+            mapped.y         = (tile.y + box.y * tile.h) / sh - mapped.h / 2.f;
+            merged.push_front(mapped);
+        }
+    }
+    tile_ = nullptr;
+    // a failed inference stops before the last preprocess, the frame is released all the same
+    if (!released && p_preprocess_done_ != nullptr) {
+        p_preprocess_done_(p_user_ctx_);
+    }
+
+    if (p_underlying_run_done_ != nullptr) {
+        p_underlying_run_done_(p_user_ctx_);
+    }
+
+    start_time = ma_get_time_us();
+    ma::utils::nms(merged, threshold_nms_, threshold_score_, false, true);
+    for (auto& box : merged) {
+        box.x += box.w / 2.f;
+        box.y += box.h / 2.f;
+    }
+    results_ = std::move(merged);
+    if (p_postprocess_done_ != nullptr) {
+        p_postprocess_done_(p_user_ctx_);
+    }
+    perf.postprocess += ma_get_time_us() - start_time;
+
+    perf_ = perf;
+
+    return err;
+}
+
 ma_err_t Detector::setConfig(ma_model_cfg_opt_t opt, ...) {
     ma_err_t ret = MA_OK;
     va_list args;
@@ -82,6 +223,21 @@ ma_err_t Detector::setConfig(ma_model_cfg_opt_t opt, ...) {
             threshold_nms_ = va_arg(args, double);
             ret            = MA_OK;
             break;
+        case MA_MODEL_CFG_OPT_TILE:
+            tiled_ = va_arg(args, int) != 0;
+            ret    = MA_OK;
+            break;
+        case MA_MODEL_CFG_OPT_TILE_OVERLAP:
+            tile_overlap_ = std::clamp(va_arg(args, double), 0.0, 0.5);
+            ret           = MA_OK;
+            break;
+        case MA_MODEL_CFG_OPT_ROI: {
+            // const ma_roi_t* rois, int count, a count of 0 feeds the whole frame again
+            const ma_roi_t* rois = va_arg(args, const ma_roi_t*);
+            int count            = va_arg(args, int);
+            rois_.assign(rois, rois + (rois != nullptr && count > 0 ? count : 0));
+            ret = MA_OK;
+        } break;
         default:
             ret = MA_EINVAL;
             break;
@@ -104,6 +260,22 @@ ma_err_t Detector::getConfig(ma_model_cfg_opt_t opt, ...) {
             p_arg                          = va_arg(args, void*);
             *(static_cast<double*>(p_arg)) = threshold_nms_;
             break;
+        case MA_MODEL_CFG_OPT_TILE:
+            p_arg                        = va_arg(args, void*);
+            *(static_cast<bool*>(p_arg)) = tiled_;
+            break;
+        case MA_MODEL_CFG_OPT_TILE_OVERLAP:
+            p_arg                          = va_arg(args, void*);
+            *(static_cast<double*>(p_arg)) = tile_overlap_;
+            break;
+        case MA_MODEL_CFG_OPT_ROI: {
+            // ma_roi_t* rois, int* count, count holds the capacity of rois and gets the number of regions
+            ma_roi_t* rois = va_arg(args, ma_roi_t*);
+            int* count     = va_arg(args, int*);
+            int n          = std::min(*count, static_cast<int>(rois_.size()));
+            std::copy(rois_.begin(), rois_.begin() + n, rois);
+            *count = static_cast<int>(rois_.size());
+        } break;
         default:
             ret = MA_EINVAL;
             break;
@@ -19,8 +19,21 @@ protected:
     bool is_nhwc_;
     std::forward_list<ma_bbox_t> results_;
 
+    bool tiled_;
+    double tile_overlap_;
+    const Region* tile_;
+    std::vector<Region> tiles_;
+    std::vector<uint8_t> tile_buffer_;
+
+    // only these regions of the frame are fed to the model, one after another, tiling is off then
+    std::vector<ma_roi_t> rois_;
+
 protected:
     ma_err_t preprocess() override;
+    ma_err_t runTiled();
+    ma_err_t runRegions();
+    // runs the model on each of tiles_ and merges the results, a tile of the whole frame is converted as usual
+    ma_err_t runTiles();
 
 public:
     Detector(Engine* engine, const char* name, ma_model_type_t type);
@@ -6,6 +6,7 @@
 #include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "../ma_common.h"
 #include "porting/ma_osal.h"
@@ -14,10 +15,11 @@ namespace ma {
 
 typedef std::function<void(std::atomic<bool>&)> task_t;
 
+// a single worker thread running the submitted tasks one after another, in submission order
 class Executor {
    public:
     Executor(std::size_t stack_size = MA_SEVER_AT_EXECUTOR_STACK_SIZE, std::size_t priority = MA_SEVER_AT_EXECUTOR_TASK_PRIO)
-        : _task_queue_lock(), _task_reload(false), _worker_name(MA_EXECUTOR_WORKER_NAME_PREFIX), _worker_handler() {
+        : _task_queue_lock(), _task_reload(false), _worker_name(MA_EXECUTOR_WORKER_NAME_PREFIX), _worker_handler(), _capture(nullptr), _capture_thread(nullptr) {
         static uint8_t     worker_id    = 0u;
         static const char* hex_literals = "0123456789ABCDEF";
 
@@ -47,10 +49,21 @@ class Executor {
     // the Callable must be a function object or a lambda, the prototype is task_t
     template <typename Callable> inline void submit(Callable&& callable) {
         const Guard guard(_task_queue_lock);
+        if (_capture && Thread::self() == _capture_thread) [[unlikely]] {
+            _capture->emplace_back(std::forward<Callable>(callable));
+            return;
+        }
         _task_queue.push(std::forward<Callable>(callable));
         MA_LOGD("E", "Executor::submit: %s, task count = %zu", _worker_name.c_str(), _task_queue.size());
     }
 
+    // tasks submitted by the calling thread are appended to tasks instead of queued, until called with nullptr
+    inline void capture(std::vector<task_t>* tasks) {
+        const Guard guard(_task_queue_lock);
+        _capture        = tasks;
+        _capture_thread = tasks ? Thread::self() : nullptr;
+    }
+
     inline void cancel() {
         const Guard guard(_task_queue_lock);
         while (!_task_queue.empty()) _task_queue.pop();
@@ -85,6 +98,9 @@ class Executor {
     Thread*           _worker_handler;
 
     std::queue<task_t> _task_queue;
+
+    std::vector<task_t>* _capture;
+    ma_thread_t*         _capture_thread;
 };
 
 }  // namespace ma
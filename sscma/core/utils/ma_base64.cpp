@@ -1,11 +1,26 @@
 #include "ma_base64.h"
 #include <array>
 #include <cstdio>
+#include <cstring>
 
 namespace ma::utils {
 
 constexpr static const char* BASE64_CHARS_TABLE = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+// both characters of every 12-bit group, in flash, so each 3 input bytes take 2 lookups
+struct Base64Pair {
+    char c[2];
+};
+
+constexpr static std::array<Base64Pair, 4096> BASE64_PAIRS_TABLE = []() {
+    std::array<Base64Pair, 4096> table{};
+    for (int i = 0; i < 4096; i++) {
+        table[i].c[0] = BASE64_CHARS_TABLE[i >> 6];
+        table[i].c[1] = BASE64_CHARS_TABLE[i & 0x3f];
+    }
+    return table;
+}();
+
 static std::array<int, 256> BASE64_DECODE_TABLE = []() {
     std::array<int, 256> table;
     for (auto& v : table) {
@@ -17,72 +32,92 @@ static std::array<int, 256> BASE64_DECODE_TABLE = []() {
     return table;
 }();
 
-std::string base64_decode(const std::string& in) {
-    std::string out;
-    out.reserve(in.size() * 3 / 4);
+static inline void base64_encode_group(const unsigned char* in, char* out) {
+    uint32_t v = (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2];
+    std::memcpy(out, BASE64_PAIRS_TABLE[v >> 12].c, 2);
+    std::memcpy(out + 2, BASE64_PAIRS_TABLE[v & 0xfff].c, 2);
+}
+
+size_t base64_decode(const char* in, size_t in_len, unsigned char* out) {
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(in);
+    unsigned char* dst       = out;
+    size_t i                 = 0;
+
+    // whole blocks of 4 characters, until the first one holding an invalid character
+    for (; i + 4 <= in_len; i += 4) {
+        int a = BASE64_DECODE_TABLE[src[i]];
+        int b = BASE64_DECODE_TABLE[src[i + 1]];
+        int c = BASE64_DECODE_TABLE[src[i + 2]];
+        int d = BASE64_DECODE_TABLE[src[i + 3]];
+        if ((a | b | c | d) < 0) {
+            break;
+        }
+        uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+        dst[0]     = static_cast<unsigned char>(v >> 16);
+        dst[1]     = static_cast<unsigned char>(v >> 8);
+        dst[2]     = static_cast<unsigned char>(v);
+        dst += 3;
+    }
 
     int val  = 0;
     int valb = -8;
-    for (unsigned char c : in) {
-        if (BASE64_DECODE_TABLE[c] == -1) {
+    for (; i < in_len; i++) {
+        int d = BASE64_DECODE_TABLE[src[i]];
+        if (d == -1) {
             break;
         }
-        val = (val << 6) + BASE64_DECODE_TABLE[c];
+        val = (val << 6) + d;
         valb += 6;
         if (valb >= 0) {
-            out.push_back(char((val >> valb) & 0xff));
+            *dst++ = static_cast<unsigned char>((val >> valb) & 0xff);
             valb -= 8;
         }
     }
-    
+
+    return dst - out;
+}
+
+std::string base64_decode(const std::string& in) {
+    std::string out;
+    out.resize(in.size() / 4 * 3 + 3);
+    out.resize(base64_decode(in.data(), in.size(), reinterpret_cast<unsigned char*>(out.data())));
     return out;
 }
 
 ma_err_t base64_encode(const unsigned char* in, int in_len, char* out, int* out_len) {
-    int i = 0;
-    int j = 0;
-    unsigned char char_array_3[3];
-    unsigned char char_array_4[4];
-
-    if (*out_len < 4 * ((in_len + 2) / 3)) {
-        *out_len = 4 * ((in_len + 2) / 3);
+    if (*out_len < static_cast<int>(base64_encoded_size(in_len))) {
+        *out_len = base64_encoded_size(in_len);
         return MA_OVERFLOW;
     }
 
-    *out_len = 4 * ((in_len + 2) / 3);
-
-    while (in_len--) {
-        char_array_3[i++] = *(in++);
-        if (i == 3) {
-            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-            char_array_4[3] = char_array_3[2] & 0x3f;
-
-            for (i = 0; i < 4; i++)
-                *out++ = BASE64_CHARS_TABLE[char_array_4[i]];
-
-            i = 0;
-        }
+    *out_len = base64_encoded_size(in_len);
+
+    // blocks of 12 bytes to 16 characters
+    while (in_len >= 12) {
+        base64_encode_group(in, out);
+        base64_encode_group(in + 3, out + 4);
+        base64_encode_group(in + 6, out + 8);
+        base64_encode_group(in + 9, out + 12);
+        in += 12;
+        out += 16;
+        in_len -= 12;
+    }
+    while (in_len >= 3) {
+        base64_encode_group(in, out);
+        in += 3;
+        out += 4;
+        in_len -= 3;
     }
 
-    if (i) {
-        for (j = i; j < 3; j++)
-            char_array_3[j] = '\0';
-
-        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-        char_array_4[3] = char_array_3[2] & 0x3f;
-
-        for (j = 0; j < i + 1; j++) {
-            *out++ = BASE64_CHARS_TABLE[char_array_4[j]];
+    if (in_len) {
+        unsigned char tail[3] = {in[0], static_cast<unsigned char>(in_len > 1 ? in[1] : 0), 0};
+        base64_encode_group(tail, out);
+        out[3] = '=';
+        if (in_len == 1) {
+            out[2] = '=';
         }
-
-        while (i++ < 3)
-            *out++ = '=';
     }
     return MA_OK;
 }
 
-}  // namespace ma::utils
\ No newline at end of file
+}  // namespace ma::utils
@@ -3,13 +3,22 @@
 #include "../ma_types.h"
 
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
 namespace ma::utils {
 
+// length of the base64 text of in_len bytes, padding included
+constexpr size_t base64_encoded_size(size_t in_len) {
+    return 4 * ((in_len + 2) / 3);
+}
+
 ma_err_t base64_encode(const unsigned char* in, int in_len, char* out, int* out_len);
 
+// decodes until the first character outside the alphabet (padding included), out holds at least in_len * 3 / 4 bytes
+size_t base64_decode(const char* in, size_t in_len, unsigned char* out);
+
 std::string base64_decode(const std::string &in);
 
 }  // namespace ma::utils
@@ -0,0 +1,152 @@
+#include "ma_delta.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ma_nms.h"
+
+namespace ma::utils {
+
+// side of the box a point is compared with, in the normalized frame
+constexpr float kPointExtent = 0.05f;
+
+ResultDelta::ResultDelta() : published_(false), published_ms_(0) {}
+
+void ResultDelta::setConfig(const Config& config) {
+    config_ = config;
+    reset();
+}
+
+const ResultDelta::Config& ResultDelta::getConfig() const {
+    return config_;
+}
+
+void ResultDelta::reset() {
+    last_.clear();
+    published_ = false;
+}
+
+bool ResultDelta::update(const std::forward_list<ma_bbox_t>& results, int64_t now_ms) {
+    // boxes are center based
+    current_.clear();
+    for (const auto& r : results) {
+        current_.push_back({r.target, r.x - r.w / 2, r.y - r.h / 2, r.w, r.h, r.score});
+    }
+    return commit(now_ms);
+}
+
+bool ResultDelta::update(const std::forward_list<ma_class_t>& results, int64_t now_ms) {
+    current_.clear();
+    for (const auto& r : results) {
+        current_.push_back({r.target, 0.f, 0.f, 1.f, 1.f, r.score});
+    }
+    return commit(now_ms);
+}
+
+bool ResultDelta::update(const std::forward_list<ma_point_t>& results, int64_t now_ms) {
+    current_.clear();
+    for (const auto& r : results) {
+        current_.push_back({r.target, r.x - kPointExtent / 2, r.y - kPointExtent / 2, kPointExtent, kPointExtent, r.score});
+    }
+    return commit(now_ms);
+}
+
+bool ResultDelta::update(const std::forward_list<ma_keypoint3f_t>& results, int64_t now_ms) {
+    // the keypoints follow their box, center based like the others
+    current_.clear();
+    for (const auto& r : results) {
+        current_.push_back({r.box.target, r.box.x - r.box.w / 2, r.box.y - r.box.h / 2, r.box.w, r.box.h, r.box.score});
+    }
+    return commit(now_ms);
+}
+
+bool ResultDelta::commit(int64_t now_ms) {
+    std::sort(current_.begin(), current_.end(), [](const Item& a, const Item& b) { return a.target != b.target ? a.target < b.target : a.x < b.x; });
+
+    bool publish = !published_ || (config_.keepalive_ms != 0 && now_ms - published_ms_ >= config_.keepalive_ms) || changed();
+    if (publish) {
+        last_.swap(current_);
+        published_    = true;
+        published_ms_ = now_ms;
+    }
+    return publish;
+}
+
+bool ResultDelta::changed() {
+    size_t cur = 0, last = 0;
+    while (cur < current_.size() || last < last_.size()) {
+        // the next class present in either set
+        int target = cur < current_.size() ? current_[cur].target : last_[last].target;
+        if (last < last_.size()) {
+            target = std::min(target, last_[last].target);
+        }
+
+        size_t cur_end = cur;
+        while (cur_end < current_.size() && current_[cur_end].target == target) {
+            ++cur_end;
+        }
+        size_t last_end = last;
+        while (last_end < last_.size() && last_[last_end].target == target) {
+            ++last_end;
+        }
+
+        if (classChanged(cur, cur_end, last, last_end)) {
+            return true;
+        }
+        cur  = cur_end;
+        last = last_end;
+    }
+    return false;
+}
+
+bool ResultDelta::classChanged(size_t cur_begin, size_t cur_end, size_t last_begin, size_t last_end) {
+    const size_t n_cur  = cur_end - cur_begin;
+    const size_t n_last = last_end - last_begin;
+    if ((n_cur > n_last ? n_cur - n_last : n_last - n_cur) > config_.count) {
+        return true;
+    }
+    if (n_cur == 0 || n_last == 0) {
+        return false;
+    }
+
+    float max_w = 0.f;
+    for (size_t i = last_begin; i < last_end; ++i) {
+        max_w = std::max(max_w, last_[i].w);
+    }
+    used_.assign(n_last, 0);
+
+    // results beyond the published count may be new ones, the others have to match
+    size_t unmatched = 0;
+    const size_t new_ones = n_cur > n_last ? n_cur - n_last : 0;
+    const auto last_first = last_.begin() + last_begin;
+    const auto last_last  = last_.begin() + last_end;
+    for (size_t i = cur_begin; i < cur_end; ++i) {
+        const Item& c = current_[i];
+        // only published results overlapping in x can reach the IoU
+        auto it = std::lower_bound(last_first, last_last, c.x - max_w, [](const Item& a, float x) { return a.x < x; });
+        // the best overlap is taken, a first fit could steal the match of a later result
+        size_t best    = n_last;
+        float best_iou = config_.iou;
+        ma_bbox_t a{c.x, c.y, c.w, c.h, c.score, c.target};
+        for (; it != last_last && it->x < c.x + c.w; ++it) {
+            size_t k = static_cast<size_t>(it - last_first);
+            if (used_[k] || std::abs(it->score - c.score) > config_.score) {
+                continue;
+            }
+            ma_bbox_t b{it->x, it->y, it->w, it->h, it->score, it->target};
+            float iou = compute_iou(a, b);
+            if (iou >= best_iou) {
+                best     = k;
+                best_iou = iou;
+            }
+        }
+        if (best < n_last) {
+            used_[best] = 1;
+        } else if (++unmatched > new_ones) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace ma::utils
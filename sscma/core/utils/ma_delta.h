@@ -0,0 +1,69 @@
+#ifndef _MA_DELTA_H_
+#define _MA_DELTA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <vector>
+
+#include "../ma_common.h"
+
+namespace ma::utils {
+
+// Decides whether results differ enough from the last published ones to be worth
+// an event. Results are sorted by class then x once, each class is compared with a
+// sweep over the x order, so a frame costs O(n log n). A result of the current frame
+// matches a published one of its class when their IoU is at least iou and their
+// scores are within score, classes and points get a full frame and a small box so
+// the same rule applies. A class changes when its count moves by more than count,
+// or one of its results can't be matched beyond the ones that count allows to be new.
+// Buffers are reused between frames. Not thread safe.
+class ResultDelta {
+public:
+    struct Config {
+        float iou             = 0.85f;  // normalized boxes with at least this IoU are the same
+        float score           = 0.1f;   // score changes up to this much are ignored
+        uint32_t count        = 0;      // per class count changes up to this much are ignored
+        uint32_t keepalive_ms = 5000;   // publish anyway after this long, 0 for never
+    };
+
+    ResultDelta();
+
+    void setConfig(const Config& config);
+    const Config& getConfig() const;
+
+    // forgets the published results, the next update publishes
+    void reset();
+
+    // true when the results are to be published, they are the reference for the next frames then
+    bool update(const std::forward_list<ma_bbox_t>& results, int64_t now_ms);
+    bool update(const std::forward_list<ma_class_t>& results, int64_t now_ms);
+    bool update(const std::forward_list<ma_point_t>& results, int64_t now_ms);
+    bool update(const std::forward_list<ma_keypoint3f_t>& results, int64_t now_ms);
+
+private:
+    // top left based, as compute_iou() expects
+    struct Item {
+        int target;
+        float x;
+        float y;
+        float w;
+        float h;
+        float score;
+    };
+
+    bool commit(int64_t now_ms);
+    bool changed();
+    bool classChanged(size_t cur_begin, size_t cur_end, size_t last_begin, size_t last_end);
+
+    Config config_;
+    std::vector<Item> current_;
+    std::vector<Item> last_;
+    std::vector<uint8_t> used_;
+    bool published_;
+    int64_t published_ms_;
+};
+
+}  // namespace ma::utils
+
+#endif  // _MA_DELTA_H_
@@ -0,0 +1,197 @@
+#include "ma_filter.h"
+
+#include <algorithm>
+
+namespace ma::utils {
+
+static inline float iou(const float ax, const float ay, const float aw, const float ah, const float bx, const float by, const float bw, const float bh) {
+    // center based boxes
+    float w = std::min(ax + aw / 2.f, bx + bw / 2.f) - std::max(ax - aw / 2.f, bx - bw / 2.f);
+    float h = std::min(ay + ah / 2.f, by + bh / 2.f) - std::max(ay - ah / 2.f, by - bh / 2.f);
+    if (w <= 0.f || h <= 0.f) {
+        return 0.f;
+    }
+    float inter = w * h;
+    return inter / (aw * ah + bw * bh - inter);
+}
+
+ResultFilter::ResultFilter() {
+    ids_.reserve(kSlots);
+    reset();
+}
+
+void ResultFilter::setConfig(const Config& config) {
+    config_       = config;
+    config_.alpha = std::min(std::max(config_.alpha, 0.01f), 1.f);
+    config_.rise  = std::max<uint32_t>(config_.rise, 1);
+    config_.fall  = std::max<uint32_t>(config_.fall, 1);
+    reset();
+}
+
+const ResultFilter::Config& ResultFilter::getConfig() const {
+    return config_;
+}
+
+void ResultFilter::reset() {
+    for (auto& slot : slots_) {
+        slot.used      = false;
+        slot.published = false;
+    }
+    boxes_.clear();
+    ids_.clear();
+    classes_.clear();
+}
+
+void ResultFilter::begin() {
+    for (auto& slot : slots_) {
+        slot.seen = false;
+    }
+}
+
+void ResultFilter::observe(int target, int32_t id, float x, float y, float w, float h, float score, bool boxed) {
+    Slot* match = nullptr;
+    Slot* free  = nullptr;
+    float best  = config_.iou;
+    for (auto& slot : slots_) {
+        if (!slot.used) {
+            free = free ? free : &slot;
+            continue;
+        }
+        if (slot.seen || slot.target != target) {
+            continue;
+        }
+        if (!boxed || id >= 0) {
+            // classes by class, tracks by id
+            if (slot.id == id) {
+                match = &slot;
+                break;
+            }
+            continue;
+        }
+        if (slot.id < 0) {
+            float overlap = iou(slot.x, slot.y, slot.w, slot.h, x, y, w, h);
+            if (overlap >= best) {
+                best  = overlap;
+                match = &slot;
+            }
+        }
+    }
+
+    if (match == nullptr) {
+        if (free == nullptr) {
+            return;  // full, the published slots are kept
+        }
+        match            = free;
+        match->used      = true;
+        match->published = false;
+        match->target    = target;
+        match->id        = boxed ? id : -1;
+        match->x         = x;
+        match->y         = y;
+        match->w         = w;
+        match->h         = h;
+        match->score     = score;
+        match->hits      = 0;
+    } else {
+        const float a = config_.alpha;
+        match->x += a * (x - match->x);
+        match->y += a * (y - match->y);
+        match->w += a * (w - match->w);
+        match->h += a * (h - match->h);
+        match->score += a * (score - match->score);
+    }
+    match->seen   = true;
+    match->hits   = match->hits + 1;
+    match->misses = 0;
+}
+
+bool ResultFilter::commit(bool boxed) {
+    bool changed = false;
+    size_t count = 0;
+    ids_.clear();
+
+    for (auto& slot : slots_) {
+        if (!slot.used) {
+            continue;
+        }
+        if (slot.seen) {
+            if (!slot.published && slot.hits >= config_.rise) {
+                slot.published = true;
+                changed        = true;
+            }
+        } else {
+            slot.hits = 0;
+            slot.misses += 1;
+            if (!slot.published || slot.misses >= config_.fall) {
+                changed   = changed || slot.published;
+                slot.used = false;
+                continue;
+            }
+        }
+        if (!slot.published) {
+            continue;
+        }
+
+        if (boxed) {
+            auto& box  = boxes_out_[count];
+            box.x      = slot.x;
+            box.y      = slot.y;
+            box.w      = slot.w;
+            box.h      = slot.h;
+            box.score  = slot.score;
+            box.target = slot.target;
+            ids_.push_back(slot.id);
+        } else {
+            classes_out_[count].score  = slot.score;
+            classes_out_[count].target = slot.target;
+        }
+        count += 1;
+    }
+
+    // assign reuses the nodes of the lists
+    if (boxed) {
+        boxes_.assign(boxes_out_, boxes_out_ + count);
+    } else {
+        classes_.assign(classes_out_, classes_out_ + count);
+    }
+    return changed;
+}
+
+bool ResultFilter::update(const std::forward_list<ma_bbox_t>& results) {
+    begin();
+    for (const auto& r : results) {
+        observe(r.target, -1, r.x, r.y, r.w, r.h, r.score, true);
+    }
+    return commit(true);
+}
+
+bool ResultFilter::update(const std::vector<ma_bbox_t>& boxes, const std::vector<int32_t>& ids) {
+    begin();
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        const auto& r = boxes[i];
+        observe(r.target, i < ids.size() ? ids[i] : -1, r.x, r.y, r.w, r.h, r.score, true);
+    }
+    return commit(true);
+}
+
+bool ResultFilter::update(const std::forward_list<ma_class_t>& results) {
+    begin();
+    for (const auto& r : results) {
+        observe(r.target, -1, 0.f, 0.f, 1.f, 1.f, r.score, false);
+    }
+    return commit(false);
+}
+
+const std::forward_list<ma_bbox_t>& ResultFilter::getBoxes() const {
+    return boxes_;
+}
+
+const std::vector<int32_t>& ResultFilter::getIds() const {
+    return ids_;
+}
+
+const std::forward_list<ma_class_t>& ResultFilter::getClasses() const {
+    return classes_;
+}
+
+}  // namespace ma::utils
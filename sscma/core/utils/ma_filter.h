@@ -0,0 +1,82 @@
+#ifndef _MA_FILTER_H_
+#define _MA_FILTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <vector>
+
+#include "../ma_common.h"
+
+namespace ma::utils {
+
+// Temporal filter between the results of a model and what is published from them. A result
+// is followed in a slot, matched by track id when there is one, by IoU within its class
+// otherwise, classes are matched by class. A slot is published once it was seen rise frames
+// in a row and dropped once it was missed fall frames in a row, while missed it keeps its last
+// box. Boxes and scores of a slot are smoothed exponentially with alpha as the weight of the
+// new one. State is a fixed array of kSlots, results beyond are ignored, and the outputs reuse
+// their memory, so a steady scene runs without heap allocations. Not thread safe.
+class ResultFilter {
+public:
+    struct Config {
+        float alpha   = 0.5f;  // weight of the new box and score, 1 for no smoothing
+        uint32_t rise = 2;     // frames in a row a result is seen before it is published
+        uint32_t fall = 3;     // frames in a row a published result is missed before it is dropped
+        float iou     = 0.3f;  // untracked boxes of a class with at least this IoU are the same
+    };
+
+    static constexpr size_t kSlots = 64;
+
+    ResultFilter();
+
+    void setConfig(const Config& config);
+    const Config& getConfig() const;
+
+    // forgets all results
+    void reset();
+
+    // true when a result was published or dropped
+    bool update(const std::forward_list<ma_bbox_t>& results);
+    // tracked boxes, ids holds the track id of each box, -1 for one without
+    bool update(const std::vector<ma_bbox_t>& boxes, const std::vector<int32_t>& ids);
+    bool update(const std::forward_list<ma_class_t>& results);
+
+    // the published results of the last update, getIds holds the track id of each box
+    const std::forward_list<ma_bbox_t>& getBoxes() const;
+    const std::vector<int32_t>& getIds() const;
+    const std::forward_list<ma_class_t>& getClasses() const;
+
+private:
+    struct Slot {
+        bool used;
+        bool seen;
+        bool published;
+        int target;
+        int32_t id;
+        float x;
+        float y;
+        float w;
+        float h;
+        float score;
+        uint32_t hits;
+        uint32_t misses;
+    };
+
+    void begin();
+    void observe(int target, int32_t id, float x, float y, float w, float h, float score, bool boxed);
+    bool commit(bool boxed);
+
+    Config config_;
+    Slot slots_[kSlots];
+
+    ma_bbox_t boxes_out_[kSlots];
+    ma_class_t classes_out_[kSlots];
+    std::forward_list<ma_bbox_t> boxes_;
+    std::vector<int32_t> ids_;
+    std::forward_list<ma_class_t> classes_;
+};
+
+}  // namespace ma::utils
+
+#endif  // _MA_FILTER_H_
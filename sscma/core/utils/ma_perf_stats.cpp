@@ -0,0 +1,117 @@
+#include "ma_perf_stats.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ma::utils {
+
+static_assert(MA_PERF_STATS_WINDOW > 1 && MA_PERF_STATS_WINDOW <= UINT16_MAX, "MA_PERF_STATS_WINDOW out of range");
+
+PerfStats::PerfStats() {
+    reset();
+}
+
+void PerfStats::reset() {
+    std::memset(buckets_, 0, sizeof(buckets_));
+    count_ = 0;
+    sum_   = 0;
+    min_   = INT64_MAX;
+    max_   = 0;
+}
+
+size_t PerfStats::bucketOf(int64_t value) {
+    if (value < static_cast<int64_t>(kSubs)) {
+        return value < 0 ? 0 : static_cast<size_t>(value);
+    }
+    size_t exp    = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+    size_t sub    = (static_cast<uint64_t>(value) >> (exp - kSubBits)) & (kSubs - 1);
+    size_t bucket = kSubs + (exp - kSubBits) * kSubs + sub;
+    return std::min(bucket, kBuckets - 1);
+}
+
+int64_t PerfStats::lowerOf(size_t bucket) {
+    if (bucket < kSubs) {
+        return static_cast<int64_t>(bucket);
+    }
+    size_t shift = (bucket - kSubs) / kSubs;
+    size_t sub   = (bucket - kSubs) % kSubs;
+    return static_cast<int64_t>(kSubs + sub) << shift;
+}
+
+int64_t PerfStats::valueOf(size_t bucket) {
+    if (bucket < kSubs) {
+        return static_cast<int64_t>(bucket);
+    }
+    size_t shift = (bucket - kSubs) / kSubs;
+    return lowerOf(bucket) + ((int64_t{1} << shift) >> 1);
+}
+
+void PerfStats::record(int64_t value) {
+    if (value < 0) [[unlikely]] {
+        value = 0;
+    }
+
+    if (count_ >= MA_PERF_STATS_WINDOW) [[unlikely]] {
+        uint32_t count = count_;
+        count_         = 0;
+        for (auto& bucket : buckets_) {
+            bucket >>= 1;
+            count_ += bucket;
+        }
+        sum_ = sum_ * count_ / count;
+        // min and max follow the samples left, they are kept while their buckets still hold some
+        if (count_ == 0) {
+            min_ = INT64_MAX;
+            max_ = 0;
+        } else {
+            size_t first = 0;
+            size_t last  = kBuckets - 1;
+            while (buckets_[first] == 0) {
+                ++first;
+            }
+            while (buckets_[last] == 0) {
+                --last;
+            }
+            min_ = std::max(min_, lowerOf(first));
+            // the last bucket holds everything beyond
+            if (last + 1 < kBuckets) {
+                max_ = std::min(max_, lowerOf(last + 1) - 1);
+            }
+        }
+    }
+
+    ++buckets_[bucketOf(value)];
+    ++count_;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+int64_t PerfStats::percentile(uint32_t percent) const {
+    uint32_t rank = (count_ * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            return std::clamp(valueOf(i), min_, max_);
+        }
+    }
+    return max_;
+}
+
+ma_perf_stat_t PerfStats::get() const {
+    ma_perf_stat_t stat{};
+    if (count_ == 0) {
+        return stat;
+    }
+    stat.count = count_;
+    stat.min   = min_;
+    stat.max   = max_;
+    stat.mean  = sum_ / count_;
+    stat.p50   = percentile(50);
+    stat.p95   = percentile(95);
+    stat.p99   = percentile(99);
+    return stat;
+}
+
+}  // namespace ma::utils
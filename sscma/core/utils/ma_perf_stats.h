@@ -0,0 +1,43 @@
+#ifndef _MA_PERF_STATS_H_
+#define _MA_PERF_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../ma_common.h"
+
+namespace ma::utils {
+
+// Fixed size log-linear latency histogram, 8 sub-buckets per power of two so a
+// reported percentile is within ~6% of the real sample. Once MA_PERF_STATS_WINDOW
+// samples are recorded all counts are halved, older frames fade out without any
+// allocation, min and max are narrowed to the buckets left. Not thread safe, record
+// and get from the same task.
+class PerfStats {
+public:
+    PerfStats();
+
+    void reset();
+    void record(int64_t value);
+    ma_perf_stat_t get() const;
+
+private:
+    static constexpr size_t kSubBits = 3;
+    static constexpr size_t kSubs    = 1 << kSubBits;
+    static constexpr size_t kBuckets = kSubs + (26 - kSubBits) * kSubs;  // up to 2^26 us
+
+    static size_t bucketOf(int64_t value);
+    static int64_t lowerOf(size_t bucket);
+    static int64_t valueOf(size_t bucket);
+    int64_t percentile(uint32_t percent) const;
+
+    uint16_t buckets_[kBuckets];
+    uint32_t count_;
+    int64_t sum_;
+    int64_t min_;
+    int64_t max_;
+};
+
+}  // namespace ma::utils
+
+#endif  // _MA_PERF_STATS_H_
@@ -0,0 +1,246 @@
+#include "ma_trigger.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ma::utils {
+
+// class ids of a table, a rule beyond is invalid
+constexpr int kClassLimit = 4096;
+
+static inline bool compare(TriggerTable::Condition condition, float a, float b) {
+    switch (condition) {
+        case TriggerTable::kGreater:
+            return a > b;
+        case TriggerTable::kLess:
+            return a < b;
+        case TriggerTable::kGreaterEqual:
+            return a >= b;
+        case TriggerTable::kLessEqual:
+            return a <= b;
+        case TriggerTable::kEqual:
+            return a == b;
+        case TriggerTable::kNotEqual:
+            return a != b;
+    }
+    return false;
+}
+
+TriggerTable::TriggerTable() : any_(0) {}
+
+void TriggerTable::clear() {
+    rules_.clear();
+    offsets_.clear();
+    slots_.clear();
+    any_ = 0;
+    hits_.clear();
+    streak_.clear();
+    active_.clear();
+    pin_of_.clear();
+    pins_.clear();
+    wanted_.clear();
+    levels_.clear();
+    outputs_.clear();
+}
+
+bool TriggerTable::compile(const std::string& rules) {
+    clear();
+
+    for (size_t i = 0, j = 0; i < rules.size(); i = j + 1) {
+        j = rules.find('|', i);
+        if (j == std::string::npos) {
+            j = rules.size();
+        }
+
+        std::vector<std::string> tokens;
+        for (size_t k = i, l = i; k < j; k = l + 1) {
+            l = std::min(rules.find(',', k), j);
+            tokens.push_back(rules.substr(k, l - k));
+        }
+        // extra fields are ignored as before, a kind needs its debounce and a zone all 4 sides
+        if (tokens.size() < 6) {
+            clear();
+            return false;
+        }
+
+        Rule rule{};
+        rule.target        = std::atoi(tokens[0].c_str());
+        int condition      = std::atoi(tokens[1].c_str());
+        int value          = std::atoi(tokens[2].c_str());
+        rule.pin           = std::atoi(tokens[3].c_str());
+        rule.default_level = std::atoi(tokens[4].c_str());
+        rule.trigger_level = std::atoi(tokens[5].c_str());
+        int kind           = tokens.size() >= 8 ? std::atoi(tokens[6].c_str()) : kScore;
+        int debounce       = tokens.size() >= 8 ? std::atoi(tokens[7].c_str()) : 0;
+
+        bool valid = rule.target >= -1 && rule.target < kClassLimit && condition >= kGreater && condition <= kNotEqual && kind >= kScore && kind <= kArea &&
+                     value >= 0 && (kind == kCount || value <= 100) && debounce >= 0 && (rule.default_level == 0 || rule.default_level == 1) &&
+                     (rule.trigger_level == 0 || rule.trigger_level == 1);
+        rule.condition = static_cast<Condition>(condition);
+        rule.kind      = static_cast<Kind>(kind);
+        rule.value     = kind == kCount ? static_cast<float>(value) : value / 100.f;
+        rule.debounce  = static_cast<uint32_t>(debounce);
+
+        rule.left   = 0.f;
+        rule.top    = 0.f;
+        rule.right  = 1.f;
+        rule.bottom = 1.f;
+        if (tokens.size() >= 12) {
+            int x = std::atoi(tokens[8].c_str());
+            int y = std::atoi(tokens[9].c_str());
+            int w = std::atoi(tokens[10].c_str());
+            int h = std::atoi(tokens[11].c_str());
+            valid = valid && x >= 0 && y >= 0 && w > 0 && h > 0 && x + w <= 100 && y + h <= 100;
+            rule.zoned  = true;
+            rule.left   = x / 100.f;
+            rule.top    = y / 100.f;
+            rule.right  = (x + w) / 100.f;
+            rule.bottom = (y + h) / 100.f;
+        }
+
+        if (!valid) {
+            clear();
+            return false;
+        }
+        rules_.push_back(rule);
+    }
+
+    // class id -> rules, counted then filled, the rules of all classes at the end
+    int classes = 0;
+    for (const auto& rule : rules_) {
+        classes = std::max(classes, rule.target + 1);
+    }
+    offsets_.assign(classes + 2, 0);
+    for (const auto& rule : rules_) {
+        offsets_[(rule.target < 0 ? classes : rule.target) + 1] += 1;
+    }
+    for (size_t c = 1; c < offsets_.size(); ++c) {
+        offsets_[c] += offsets_[c - 1];
+    }
+    any_ = offsets_[classes];
+    slots_.resize(rules_.size());
+    std::vector<uint32_t> fill(offsets_.begin(), offsets_.end() - 1);
+    for (uint32_t i = 0; i < rules_.size(); ++i) {
+        slots_[fill[rules_[i].target < 0 ? classes : rules_[i].target]++] = i;
+    }
+    offsets_.pop_back();
+
+    for (const auto& rule : rules_) {
+        auto it = std::find(pins_.begin(), pins_.end(), rule.pin);
+        pin_of_.push_back(static_cast<uint32_t>(it - pins_.begin()));
+        if (it == pins_.end()) {
+            pins_.push_back(rule.pin);
+        }
+    }
+    hits_.assign(rules_.size(), 0);
+    streak_.assign(rules_.size(), 0);
+    active_.assign(rules_.size(), 0);
+    wanted_.assign(pins_.size(), 0);
+    levels_.assign(pins_.size(), -1);
+
+    return true;
+}
+
+const std::vector<TriggerTable::Rule>& TriggerTable::getRules() const {
+    return rules_;
+}
+
+inline void TriggerTable::test(uint32_t index, float x, float y, float area, float score) {
+    const Rule& rule = rules_[index];
+    if (rule.zoned && (x < rule.left || x >= rule.right || y < rule.top || y >= rule.bottom)) {
+        return;
+    }
+    switch (rule.kind) {
+        case kScore:
+            hits_[index] += compare(rule.condition, score, rule.value);
+            break;
+        case kCount:
+            hits_[index] += 1;
+            break;
+        case kArea:
+            hits_[index] += compare(rule.condition, area, rule.value);
+            break;
+    }
+}
+
+inline void TriggerTable::visit(int target, float x, float y, float area, float score) {
+    const uint32_t classes = offsets_.size() - 1;
+    if (target >= 0 && static_cast<uint32_t>(target) < classes) {
+        for (uint32_t i = offsets_[target]; i < offsets_[target + 1]; ++i) {
+            test(slots_[i], x, y, area, score);
+        }
+    }
+    for (uint32_t i = any_; i < slots_.size(); ++i) {
+        test(slots_[i], x, y, area, score);
+    }
+}
+
+const std::vector<TriggerTable::Output>& TriggerTable::update(const std::forward_list<ma_bbox_t>& results) {
+    std::fill(hits_.begin(), hits_.end(), 0);
+    if (!rules_.empty()) {
+        for (const auto& r : results) {
+            visit(r.target, r.x, r.y, r.w * r.h, r.score);
+        }
+    }
+    return commit();
+}
+
+const std::vector<TriggerTable::Output>& TriggerTable::update(const std::forward_list<ma_class_t>& results) {
+    // a class covers the whole frame
+    std::fill(hits_.begin(), hits_.end(), 0);
+    if (!rules_.empty()) {
+        for (const auto& r : results) {
+            visit(r.target, 0.5f, 0.5f, 1.f, r.score);
+        }
+    }
+    return commit();
+}
+
+const std::vector<TriggerTable::Output>& TriggerTable::update(const std::forward_list<ma_point_t>& results) {
+    std::fill(hits_.begin(), hits_.end(), 0);
+    if (!rules_.empty()) {
+        for (const auto& r : results) {
+            visit(r.target, r.x, r.y, 0.f, r.score);
+        }
+    }
+    return commit();
+}
+
+const std::vector<TriggerTable::Output>& TriggerTable::update(const std::forward_list<ma_keypoint3f_t>& results) {
+    // the keypoints follow their box
+    std::fill(hits_.begin(), hits_.end(), 0);
+    if (!rules_.empty()) {
+        for (const auto& r : results) {
+            visit(r.box.target, r.box.x, r.box.y, r.box.w * r.box.h, r.box.score);
+        }
+    }
+    return commit();
+}
+
+const std::vector<TriggerTable::Output>& TriggerTable::commit() {
+    for (uint32_t i = 0; i < rules_.size(); ++i) {
+        const Rule& rule = rules_[i];
+        bool fit         = rule.kind == kCount ? compare(rule.condition, static_cast<float>(hits_[i]), rule.value) : hits_[i] != 0;
+        if (fit == static_cast<bool>(active_[i])) {
+            streak_[i] = 0;
+        } else if (++streak_[i] >= rule.debounce) {
+            active_[i] = fit;
+            streak_[i] = 0;
+        }
+    }
+
+    // the last write of a pin is the first rule of it
+    for (uint32_t i = rules_.size(); i-- > 0;) {
+        wanted_[pin_of_[i]] = active_[i] ? rules_[i].trigger_level : rules_[i].default_level;
+    }
+    outputs_.clear();
+    for (uint32_t p = 0; p < pins_.size(); ++p) {
+        if (wanted_[p] != levels_[p]) {
+            levels_[p] = wanted_[p];
+            outputs_.push_back({pins_[p], levels_[p]});
+        }
+    }
+    return outputs_;
+}
+
+}  // namespace ma::utils
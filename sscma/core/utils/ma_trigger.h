@@ -0,0 +1,102 @@
+#ifndef _MA_TRIGGER_H_
+#define _MA_TRIGGER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <string>
+#include <vector>
+
+#include "../ma_common.h"
+
+namespace ma::utils {
+
+// Trigger rules compiled into a table, evaluated in a single pass over the results of a frame.
+// A rule is "class,condition,value,pin,default level,trigger level[,kind,debounce[,x,y,w,h]]":
+// kind 0 compares the score of a result of the class with value percent, kind 1 the number of
+// results of the class with value, kind 2 the area of a result of the class with value percent
+// of the frame. Only results centered in the optional zone (percent of the frame) are seen, a
+// class id of -1 matches all classes. A rule changes its level after its condition held or
+// failed for debounce frames in a row. The rules of a class are found through an offset table
+// indexed by the class id, so a result only visits the rules of its class. Levels are resolved
+// per pin, the first rule of a pin wins as before, and only pins whose level changed are output.
+// Not thread safe, the table is meant to be replaced as a whole.
+class TriggerTable {
+public:
+    enum Condition : uint8_t {
+        kGreater      = 0,
+        kLess         = 1,
+        kGreaterEqual = 2,
+        kLessEqual    = 3,
+        kEqual        = 4,
+        kNotEqual     = 5,
+    };
+
+    enum Kind : uint8_t {
+        kScore = 0,
+        kCount = 1,
+        kArea  = 2,
+    };
+
+    struct Rule {
+        int target;
+        Condition condition;
+        Kind kind;
+        float value;
+        int pin;
+        int default_level;
+        int trigger_level;
+        uint32_t debounce;
+        bool zoned;
+        float left;
+        float top;
+        float right;
+        float bottom;
+    };
+
+    struct Output {
+        int pin;
+        int level;
+    };
+
+    TriggerTable();
+
+    // rules separated by '|', false on an invalid rule, the table is left empty then
+    bool compile(const std::string& rules);
+    const std::vector<Rule>& getRules() const;
+
+    // the pins whose level changed with the results, all pins on the first update
+    const std::vector<Output>& update(const std::forward_list<ma_bbox_t>& results);
+    const std::vector<Output>& update(const std::forward_list<ma_class_t>& results);
+    const std::vector<Output>& update(const std::forward_list<ma_point_t>& results);
+    const std::vector<Output>& update(const std::forward_list<ma_keypoint3f_t>& results);
+
+private:
+    void clear();
+    void visit(int target, float x, float y, float area, float score);
+    void test(uint32_t index, float x, float y, float area, float score);
+    const std::vector<Output>& commit();
+
+    std::vector<Rule> rules_;
+    // rules of class c are slots_[offsets_[c], offsets_[c + 1]), the ones of all classes follow
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> slots_;
+    uint32_t any_;
+
+    // per rule
+    std::vector<uint32_t> hits_;
+    std::vector<uint32_t> streak_;
+    std::vector<uint8_t> active_;
+    std::vector<uint32_t> pin_of_;
+
+    // per pin
+    std::vector<int> pins_;
+    std::vector<int> wanted_;
+    std::vector<int> levels_;
+
+    std::vector<Output> outputs_;
+};
+
+}  // namespace ma::utils
+
+#endif  // _MA_TRIGGER_H_
@@ -7,14 +7,12 @@
 
 #include "byte_tracker.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cfloat>
-#include <cstdbool>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <cstdio>
-#include <map>
-#include <new>
 #include <utility>
 #include <vector>
 
@@ -22,7 +20,7 @@
 
 using namespace std;
 
-BYTETracker::BYTETracker(int frame_rate, int track_buffer, float track_thresh, float high_thresh, float match_thresh, float scale_factor) {
+BYTETracker::BYTETracker(int frame_rate, int track_buffer, float track_thresh, float high_thresh, float match_thresh, float scale_factor, size_t max_tracks, size_t max_detections) {
     this->track_thresh = track_thresh;
     this->high_thresh  = high_thresh;
     this->match_thresh = match_thresh;
@@ -30,32 +28,81 @@ BYTETracker::BYTETracker(int frame_rate, int track_buffer, float track_thresh, f
 
     frame_id      = 0;
     max_time_lost = int(frame_rate / 30.0 * track_buffer);
+    gated         = true;
+
+    stracks.resize(max_tracks);
+    detections.resize(max_detections);
+    kalman_filter.resize(max_tracks);
+
+    free_stracks.reserve(max_tracks);
+    for (vector<int>* list : {&tracked_stracks, &lost_stracks, &unconfirmed, &strack_pool, &r_tracked_stracks, &refind_stracks, &new_stracks, &tracked_swap, &lost_swap, &output_stracks}) {
+        list->reserve(max_tracks);
+    }
+    for (vector<int>* list : {&detections_high, &detections_low, &detections_cp}) {
+        list->reserve(max_detections);
+    }
+
+    update_stracks.reserve(max_tracks);
+    update_detections.reserve(max_tracks);
+    update_xyah.reserve(max_tracks * 4);
+
+    size_t max_size = max(max_tracks, max_detections);
+    matches.reserve(max_size);
+    u_track.reserve(max_size);
+    u_detection.reserve(max_size);
+    rowsol.reserve(max_size);
+    colsol.reserve(max_size);
+    duplicated.reserve(max_tracks);
+
+    clear();
 }
 
 BYTETracker::~BYTETracker() {}
 
 vector<int> BYTETracker::inplace_update(vector<ma_bbox_t>& objects) {
-    auto stracks = update(objects);
+    vector<int> res;
+    inplace_update(objects, res);
+    return res;
+}
 
-    objects.clear();
+void BYTETracker::inplace_update(vector<ma_bbox_t>& objects, vector<int>& ids) {
+    update(objects);
+    output(objects, ids);
+}
 
-    vector<int> res(stracks.size());
+void BYTETracker::inplace_predict(vector<ma_bbox_t>& objects, vector<int>& ids) {
+    predict();
+    output(objects, ids);
+}
+
+float BYTETracker::uncertainty() const {
+    float ratio = 0.f;
+    for (int index : output_stracks) {
+        const STrack& strack = stracks[index];
+        float h              = kalman_filter.mean(strack.slot, 3);
+        if (h <= 0.f) {
+            continue;
+        }
+        float var = std::max(kalman_filter.variance(strack.slot, 0), kalman_filter.variance(strack.slot, 1));
+        ratio     = std::max(ratio, std::sqrt(var) / h);
+    }
+    return ratio;
+}
+
+void BYTETracker::output(vector<ma_bbox_t>& objects, vector<int>& ids) const {
+    objects.clear();
+    ids.clear();
 
-    size_t i = 0;
-    for (const auto& strack : stracks) {
+    for (int index : output_stracks) {
+        const STrack& strack = stracks[index];
         objects.push_back(ma_bbox_t{.x      = strack.tlwh[0] / scale_factor,
                                     .y      = strack.tlwh[1] / scale_factor,
                                     .w      = strack.tlwh[2] / scale_factor,
                                     .h      = strack.tlwh[3] / scale_factor,
                                     .score  = strack.score,
                                     .target = strack.label});
-        res[i] = strack.track_id;
-        ++i;
+        ids.push_back(strack.track_id);
     }
-
-    objects.shrink_to_fit();
-
-    return res;
 }
 
 void BYTETracker::clear() {
@@ -63,547 +110,524 @@ void BYTETracker::clear() {
 
     tracked_stracks.clear();
     lost_stracks.clear();
-    removed_stracks.clear();
+    output_stracks.clear();
+
+    // slots are taken from the back, the first ones go first
+    free_stracks.clear();
+    for (int i = static_cast<int>(stracks.size()) - 1; i >= 0; --i) {
+        free_stracks.push_back(i);
+    }
 }
 
-vector<STrack> BYTETracker::update(const vector<ma_bbox_t>& objects) {
-    ////////////////// Step 1: Get detections //////////////////
-    this->frame_id += 1;
+void BYTETracker::set_gated_assignment(bool enable) {
+    gated = enable;
+}
 
-    vector<STrack> activated_stracks;
-    vector<STrack> refind_stracks;
-    vector<STrack> removed_stracks;
-    vector<STrack> lost_stracks;
-    vector<STrack> detections;
-    vector<STrack> detections_low;
+int BYTETracker::alloc_strack() {
+    if (free_stracks.empty()) {
+        return -1;
+    }
+    int index = free_stracks.back();
+    free_stracks.pop_back();
+    return index;
+}
 
-    vector<STrack> detections_cp;
-    vector<STrack> tracked_stracks_swap;
-    vector<STrack> resa, resb;
-    vector<STrack> output_stracks;
+void BYTETracker::free_strack(int index) {
+    free_stracks.push_back(index);
+}
 
-    vector<STrack*> unconfirmed;
-    vector<STrack*> tracked_stracks;
-    vector<STrack*> strack_pool;
-    vector<STrack*> r_tracked_stracks;
+void BYTETracker::update(const vector<ma_bbox_t>& objects) {
+    ////////////////// Step 1: Get detections //////////////////
+    this->frame_id += 1;
 
+    detections_high.clear();
+    detections_low.clear();
+    detections_cp.clear();
+    unconfirmed.clear();
+    strack_pool.clear();
+    r_tracked_stracks.clear();
+    refind_stracks.clear();
+    new_stracks.clear();
+
+    int count = 0;
     for (const auto& obj : objects) {
-        vector<float> tlwh_;
-        tlwh_.resize(4);
+        if (count >= static_cast<int>(detections.size())) {
+            break;
+        }
 
+        float tlwh_[4];
         tlwh_[0] = obj.x * scale_factor;
         tlwh_[1] = obj.y * scale_factor;
         tlwh_[2] = obj.w * scale_factor;
         tlwh_[3] = obj.h * scale_factor;
 
         float score = obj.score;
+        detections[count].reset(tlwh_, score, obj.target);
         if (score >= track_thresh) {
-            detections.emplace_back(tlwh_, score, obj.target);
+            detections_high.push_back(count);
         } else {
-            detections_low.emplace_back(tlwh_, score, obj.target);
+            detections_low.push_back(count);
         }
+        ++count;
     }
 
     // Add newly detected tracklets to tracked_stracks
-    for (size_t i = 0; i < this->tracked_stracks.size(); ++i) {
-        if (!this->tracked_stracks[i].is_activated)
-            unconfirmed.push_back(&this->tracked_stracks[i]);
+    for (int index : this->tracked_stracks) {
+        if (!stracks[index].is_activated)
+            unconfirmed.push_back(index);
         else
-            tracked_stracks.push_back(&this->tracked_stracks[i]);
+            strack_pool.push_back(index);
     }
 
     ////////////////// Step 2: First association, with IoU //////////////////
-    strack_pool = joint_stracks(tracked_stracks, this->lost_stracks);
-    STrack::multi_predict(strack_pool, this->kalman_filter);
-
-    vector<vector<float>> dists;
-    int dist_size = 0, dist_size_size = 0;
-    dists = iou_distance(strack_pool, detections, dist_size, dist_size_size);
-
-    vector<vector<int>> matches;
-    vector<int> u_track, u_detection;
-    linear_assignment(dists, dist_size, dist_size_size, match_thresh, matches, u_track, u_detection);
-
-    for (int i = 0; i < matches.size(); ++i) {
-        STrack* track = strack_pool[matches[i][0]];
-        STrack* det   = &detections[matches[i][1]];
-        if (track->state == TrackState::Tracked) {
-            track->update(*det, this->frame_id);
-            activated_stracks.push_back(*track);
-        } else {
-            track->re_activate(*det, this->frame_id, false);
-            refind_stracks.push_back(*track);
-        }
+    // a slot is in a single list, joining needs no deduplication
+    strack_pool.insert(strack_pool.end(), this->lost_stracks.begin(), this->lost_stracks.end());
+    STrack::multi_predict(stracks.data(), strack_pool.data(), strack_pool.size(), this->kalman_filter);
+
+    associate(stracks.data(), strack_pool.data(), strack_pool.size(), detections.data(), detections_high.data(), detections_high.size(), match_thresh);
+
+    for (const auto& match : matches) {
+        queue_update(strack_pool[match.first], detections[detections_high[match.second]]);
     }
+    apply_updates();
 
     ////////////////// Step 3: Second association, using low score dets //////////////////
-    for (int i = 0; i < u_detection.size(); ++i) {
-        detections_cp.push_back(detections[u_detection[i]]);
+    for (int i : u_detection) {
+        detections_cp.push_back(detections_high[i]);
     }
-    detections.clear();
-    detections.assign(detections_low.begin(), detections_low.end());
 
-    for (int i = 0; i < u_track.size(); ++i) {
-        auto idx = u_track[i];
-        auto st  = strack_pool[idx];
-        if (st->state == TrackState::Tracked) {
-            r_tracked_stracks.push_back(st);
+    for (int i : u_track) {
+        int index = strack_pool[i];
+        if (stracks[index].state == TrackState::Tracked) {
+            r_tracked_stracks.push_back(index);
         }
     }
 
-    dists.clear();
-    dists = iou_distance(r_tracked_stracks, detections, dist_size, dist_size_size);
+    associate(stracks.data(), r_tracked_stracks.data(), r_tracked_stracks.size(), detections.data(), detections_low.data(), detections_low.size(), 0.5);
 
-    matches.clear();
-    u_track.clear();
-    u_detection.clear();
-    linear_assignment(dists, dist_size, dist_size_size, 0.5, matches, u_track, u_detection);
-
-    for (int i = 0; i < matches.size(); ++i) {
-        STrack* track = r_tracked_stracks[matches[i][0]];
-        STrack* det   = &detections[matches[i][1]];
-        if (track->state == TrackState::Tracked) {
-            track->update(*det, this->frame_id);
-            activated_stracks.push_back(*track);
-        } else {
-            track->re_activate(*det, this->frame_id, false);
-            refind_stracks.push_back(*track);
-        }
+    for (const auto& match : matches) {
+        queue_update(r_tracked_stracks[match.first], detections[detections_low[match.second]]);
     }
+    apply_updates();
 
-    for (int i = 0; i < u_track.size(); ++i) {
-        STrack* track = r_tracked_stracks[u_track[i]];
-        if (track->state != TrackState::Lost) {
-            track->mark_lost();
-            lost_stracks.push_back(*track);
+    for (int i : u_track) {
+        STrack& track = stracks[r_tracked_stracks[i]];
+        if (track.state != TrackState::Lost) {
+            track.mark_lost();
         }
     }
 
     // Deal with unconfirmed tracks, usually tracks with only one beginning frame
-    detections.clear();
-    detections.assign(detections_cp.begin(), detections_cp.end());
-
-    dists.clear();
-    dists = iou_distance(unconfirmed, detections, dist_size, dist_size_size);
-
-    matches.clear();
-    vector<int> u_unconfirmed;
-    u_detection.clear();
-    linear_assignment(dists, dist_size, dist_size_size, 0.7, matches, u_unconfirmed, u_detection);
+    associate(stracks.data(), unconfirmed.data(), unconfirmed.size(), detections.data(), detections_cp.data(), detections_cp.size(), 0.7);
 
-    for (int i = 0; i < matches.size(); ++i) {
-        unconfirmed[matches[i][0]]->update(detections[matches[i][1]], this->frame_id);
-        activated_stracks.push_back(*unconfirmed[matches[i][0]]);
+    for (const auto& match : matches) {
+        queue_update(unconfirmed[match.first], detections[detections_cp[match.second]]);
     }
+    apply_updates();
 
-    for (int i = 0; i < u_unconfirmed.size(); ++i) {
-        STrack* track = unconfirmed[u_unconfirmed[i]];
-        track->mark_removed();
-        removed_stracks.push_back(*track);
+    for (int i : u_track) {
+        stracks[unconfirmed[i]].mark_removed();
     }
 
     ////////////////// Step 4: Init new stracks //////////////////
-    for (int i = 0; i < u_detection.size(); ++i) {
-        STrack* track = &detections[u_detection[i]];
-        if (track->score < this->high_thresh)
+    for (int i : u_detection) {
+        const STrack& det = detections[detections_cp[i]];
+        if (det.score < this->high_thresh)
             continue;
-        track->activate(this->kalman_filter, this->frame_id);
-        activated_stracks.push_back(*track);
+        int index = alloc_strack();
+        if (index < 0)
+            break;
+        stracks[index] = det;
+        stracks[index].activate(this->kalman_filter, index, this->frame_id);
+        new_stracks.push_back(index);
     }
 
     ////////////////// Step 5: Update state //////////////////
-    for (int i = 0; i < this->lost_stracks.size(); ++i) {
-        if (this->frame_id - this->lost_stracks[i].end_frame() > this->max_time_lost) {
-            this->lost_stracks[i].mark_removed();
-            removed_stracks.push_back(this->lost_stracks[i]);
+    for (int index : this->lost_stracks) {
+        STrack& track = stracks[index];
+        if (track.state == TrackState::Lost && this->frame_id - track.end_frame() > this->max_time_lost) {
+            track.mark_removed();
         }
     }
 
-    for (int i = 0; i < this->tracked_stracks.size(); ++i) {
-        if (this->tracked_stracks[i].state == TrackState::Tracked) {
-            tracked_stracks_swap.push_back(this->tracked_stracks[i]);
+    // tracked: the ones still tracked, then the new ones, then the refound ones
+    // lost: the ones still lost and the newly lost ones, by track id
+    tracked_swap.clear();
+    lost_swap.clear();
+    for (int index : this->tracked_stracks) {
+        switch (stracks[index].state) {
+        case TrackState::Tracked:
+            tracked_swap.push_back(index);
+            break;
+        case TrackState::Lost:
+            lost_swap.push_back(index);
+            break;
+        default:
+            free_strack(index);
+            break;
         }
     }
-    this->tracked_stracks.clear();
-    this->tracked_stracks.assign(tracked_stracks_swap.begin(), tracked_stracks_swap.end());
-
-    this->tracked_stracks = joint_stracks(this->tracked_stracks, activated_stracks);
-    this->tracked_stracks = joint_stracks(this->tracked_stracks, refind_stracks);
-
-    this->lost_stracks = sub_stracks(this->lost_stracks, this->tracked_stracks);
-    for (int i = 0; i < lost_stracks.size(); ++i) {
-        this->lost_stracks.push_back(lost_stracks[i]);
-    }
-
-    this->lost_stracks = sub_stracks(this->lost_stracks, this->removed_stracks);
-    for (int i = 0; i < removed_stracks.size(); ++i) {
-        this->removed_stracks.push_back(removed_stracks[i]);
+    tracked_swap.insert(tracked_swap.end(), new_stracks.begin(), new_stracks.end());
+    tracked_swap.insert(tracked_swap.end(), refind_stracks.begin(), refind_stracks.end());
+
+    for (int index : this->lost_stracks) {
+        switch (stracks[index].state) {
+        case TrackState::Lost:
+            lost_swap.push_back(index);
+            break;
+        case TrackState::Removed:
+            free_strack(index);
+            break;
+        default:  // refound, in tracked_swap
+            break;
+        }
     }
+    sort(lost_swap.begin(), lost_swap.end(), [this](int a, int b) { return stracks[a].track_id < stracks[b].track_id; });
 
-    remove_duplicate_stracks(resa, resb, this->tracked_stracks, this->lost_stracks);
+    this->tracked_stracks.swap(tracked_swap);
+    this->lost_stracks.swap(lost_swap);
 
-    this->tracked_stracks.clear();
-    this->tracked_stracks.assign(resa.begin(), resa.end());
-    this->lost_stracks.clear();
-    this->lost_stracks.assign(resb.begin(), resb.end());
+    remove_duplicate_stracks();
 
-    for (int i = 0; i < this->tracked_stracks.size(); ++i) {
-        if (this->tracked_stracks[i].is_activated) {
-            output_stracks.push_back(this->tracked_stracks[i]);
+    output_stracks.clear();
+    for (int index : this->tracked_stracks) {
+        if (stracks[index].is_activated) {
+            output_stracks.push_back(index);
         }
     }
-    return output_stracks;
 }
 
-vector<STrack*> BYTETracker::joint_stracks(vector<STrack*>& tlista, vector<STrack>& tlistb) {
-    std::map<int, int> exists;
-    vector<STrack*> res;
-    for (int i = 0; i < tlista.size(); i++) {
-        exists.insert(pair<int, int>(tlista[i]->track_id, 1));
-        res.push_back(tlista[i]);
-    }
-    for (int i = 0; i < tlistb.size(); i++) {
-        int tid = tlistb[i].track_id;
-        if (!exists[tid] || exists.count(tid) == 0) {
-            exists[tid] = 1;
-            res.push_back(&tlistb[i]);
-        }
-    }
-    return res;
-}
+void BYTETracker::predict() {
+    this->frame_id += 1;
 
-vector<STrack> BYTETracker::joint_stracks(vector<STrack>& tlista, vector<STrack>& tlistb) {
-    std::map<int, int> exists;
-    vector<STrack> res;
-    for (int i = 0; i < tlista.size(); i++) {
-        exists.insert(pair<int, int>(tlista[i].track_id, 1));
-        res.push_back(tlista[i]);
-    }
-    for (int i = 0; i < tlistb.size(); i++) {
-        int tid = tlistb[i].track_id;
-        if (!exists[tid] || exists.count(tid) == 0) {
-            exists[tid] = 1;
-            res.push_back(tlistb[i]);
-        }
+    // the tracks update() would predict, unconfirmed ones wait for their next detection
+    strack_pool.clear();
+    for (int index : this->tracked_stracks) {
+        if (stracks[index].is_activated)
+            strack_pool.push_back(index);
     }
-    return res;
+    strack_pool.insert(strack_pool.end(), this->lost_stracks.begin(), this->lost_stracks.end());
+    STrack::multi_predict(stracks.data(), strack_pool.data(), strack_pool.size(), this->kalman_filter);
 }
 
-vector<STrack> BYTETracker::sub_stracks(vector<STrack>& tlista, vector<STrack>& tlistb) {
-    std::map<int, STrack> stracks;
-    for (int i = 0; i < tlista.size(); i++) {
-        stracks.insert(pair<int, STrack>(tlista[i].track_id, tlista[i]));
-    }
-    for (int i = 0; i < tlistb.size(); i++) {
-        int tid = tlistb[i].track_id;
-        if (stracks.count(tid) != 0) {
-            stracks.erase(tid);
-        }
-    }
+void BYTETracker::queue_update(int index, const STrack& det) {
+    float xyah[4];
+    det.to_xyah(xyah);
 
-    vector<STrack> res;
-    std::map<int, STrack>::iterator it;
-    for (it = stracks.begin(); it != stracks.end(); ++it) {
-        res.push_back(it->second);
-    }
-
-    return res;
+    update_stracks.push_back(index);
+    update_detections.push_back(static_cast<int>(&det - detections.data()));
+    update_xyah.insert(update_xyah.end(), xyah, xyah + 4);
 }
 
-void BYTETracker::remove_duplicate_stracks(vector<STrack>& resa, vector<STrack>& resb, vector<STrack>& stracksa, vector<STrack>& stracksb) {
-    vector<vector<float>> pdist = iou_distance(stracksa, stracksb);
-    vector<pair<int, int>> pairs;
-    for (int i = 0; i < pdist.size(); i++) {
-        for (int j = 0; j < pdist[i].size(); j++) {
-            if (pdist[i][j] < 0.15) {
-                pairs.push_back(pair<int, int>(i, j));
-            }
+void BYTETracker::apply_updates() {
+    kalman_filter.update(update_stracks.data(), update_xyah.data(), update_stracks.size());
+
+    for (size_t i = 0; i < update_stracks.size(); i++) {
+        STrack& track     = stracks[update_stracks[i]];
+        const STrack& det = detections[update_detections[i]];
+        if (track.state == TrackState::Tracked) {
+            track.update(this->kalman_filter, det, this->frame_id);
+        } else {
+            track.re_activate(this->kalman_filter, det, this->frame_id, false);
+            refind_stracks.push_back(update_stracks[i]);
         }
     }
 
-    vector<int> dupa, dupb;
-    for (int i = 0; i < pairs.size(); i++) {
-        int timep = stracksa[pairs[i].first].frame_id - stracksa[pairs[i].first].start_frame;
-        int timeq = stracksb[pairs[i].second].frame_id - stracksb[pairs[i].second].start_frame;
+    update_stracks.clear();
+    update_detections.clear();
+    update_xyah.clear();
+}
+
+void BYTETracker::remove_duplicate_stracks() {
+    const int asize = tracked_stracks.size();
+    const int bsize = lost_stracks.size();
+    iou_edges(stracks.data(), tracked_stracks.data(), asize, stracks.data(), lost_stracks.data(), bsize, 0.15);
+
+    // the younger track of each pair goes, flags of tracked then lost
+    duplicated.assign(asize + bsize, 0);
+    for (const auto& edge : edges) {
+        const STrack& a = stracks[tracked_stracks[edge.a]];
+        const STrack& b = stracks[lost_stracks[edge.b]];
+        int timep       = a.frame_id - a.start_frame;
+        int timeq       = b.frame_id - b.start_frame;
         if (timep > timeq)
-            dupb.push_back(pairs[i].second);
+            duplicated[asize + edge.b] = 1;
         else
-            dupa.push_back(pairs[i].first);
-    }
-
-    for (int i = 0; i < stracksa.size(); i++) {
-        vector<int>::iterator iter = find(dupa.begin(), dupa.end(), i);
-        if (iter == dupa.end()) {
-            resa.push_back(stracksa[i]);
-        }
+            duplicated[edge.a] = 1;
     }
 
-    for (int i = 0; i < stracksb.size(); i++) {
-        vector<int>::iterator iter = find(dupb.begin(), dupb.end(), i);
-        if (iter == dupb.end()) {
-            resb.push_back(stracksb[i]);
+    auto drop = [this](vector<int>& list, const uint8_t* flags) {
+        size_t kept = 0;
+        for (size_t i = 0; i < list.size(); i++) {
+            if (flags[i]) {
+                free_strack(list[i]);
+            } else {
+                list[kept++] = list[i];
+            }
         }
-    }
+        list.resize(kept);
+    };
+    drop(tracked_stracks, duplicated.data());
+    drop(lost_stracks, duplicated.data() + asize);
 }
 
-void BYTETracker::linear_assignment(
-    vector<vector<float>>& cost_matrix, int cost_matrix_size, int cost_matrix_size_size, float thresh, vector<vector<int>>& matches, vector<int>& unmatched_a, vector<int>& unmatched_b) {
-    if (cost_matrix.size() == 0) {
-        for (int i = 0; i < cost_matrix_size; i++) {
-            unmatched_a.push_back(i);
-        }
-        for (int i = 0; i < cost_matrix_size_size; i++) {
-            unmatched_b.push_back(i);
-        }
-        return;
+void BYTETracker::associate(const STrack* apool, const int* atracks, int asize, const STrack* bpool, const int* btracks, int bsize, float thresh) {
+    // pairs without overlap cost 1, gating them out needs them to be out of reach
+    if (gated && thresh <= 1) {
+        iou_edges(apool, atracks, asize, bpool, btracks, bsize, thresh);
+        sparse_assignment(asize, bsize, thresh);
+    } else {
+        iou_distance(apool, atracks, asize, bpool, btracks, bsize);
+        linear_assignment(asize, bsize, thresh);
     }
+}
 
-    vector<int> rowsol;
-    vector<int> colsol;
-
-    lapjv(cost_matrix, rowsol, colsol, true, thresh);
+void BYTETracker::linear_assignment(int rows, int cols, float thresh) {
+    rowsol.assign(rows, -1);
+    colsol.assign(cols, -1);
 
-    auto rowsol_size = rowsol.size();
-    for (int i = 0; i < rowsol_size; i++) {
-        if (rowsol[i] >= 0) {
-            matches.emplace_back(vector<int>{i, rowsol[i]});
-        } else {
-            unmatched_a.push_back(i);
-        }
+    if (rows * cols != 0) {
+        lapjv(cost_matrix.data(), rows, cols, thresh, rowsol.data(), colsol.data());
     }
 
-    auto colsol_size = colsol.size();
-    for (int i = 0; i < colsol_size; i++) {
-        if (colsol[i] < 0) {
-            unmatched_b.push_back(i);
-        }
+    collect_assignment(rows, cols);
+}
+
+int BYTETracker::find_component(int node) {
+    while (node_parent[node] != node) {
+        node_parent[node] = node_parent[node_parent[node]];
+        node              = node_parent[node];
     }
+    return node;
 }
 
-vector<vector<float>> BYTETracker::ious(vector<vector<float>>& atlbrs, vector<vector<float>>& btlbrs) {
-    vector<vector<float>> ious;
-    if (atlbrs.size() * btlbrs.size() == 0)
-        return ious;
+void BYTETracker::sparse_assignment(int rows, int cols, float thresh) {
+    const int n_nodes = rows + cols;
 
-    ious.resize(atlbrs.size());
-    auto ious_size = ious.size();
-    for (int i = 0; i < ious_size; i++) {
-        ious[i].resize(btlbrs.size());
-    }
+    rowsol.assign(rows, -1);
+    colsol.assign(cols, -1);
 
-    // bbox_ious
-    auto btlbrs_size = btlbrs.size();
-    auto atlbrs_size = atlbrs.size();
-    for (int k = 0; k < btlbrs_size; k++) {
-        float box_area = (btlbrs[k][2] - btlbrs[k][0] + 1) * (btlbrs[k][3] - btlbrs[k][1] + 1);
-        for (int n = 0; n < atlbrs_size; n++) {
-            float iw = min(atlbrs[n][2], btlbrs[k][2]) - max(atlbrs[n][0], btlbrs[k][0]) + 1;
-            if (iw > 0) {
-                float ih = min(atlbrs[n][3], btlbrs[k][3]) - max(atlbrs[n][1], btlbrs[k][1]) + 1;
-                if (ih > 0) {
-                    float ua   = (atlbrs[n][2] - atlbrs[n][0] + 1) * (atlbrs[n][3] - atlbrs[n][1] + 1) + box_area - iw * ih;
-                    ious[n][k] = iw * ih / ua;
-                } else {
-                    ious[n][k] = 0.0;
-                }
-            } else {
-                ious[n][k] = 0.0;
-            }
+    // connected components of the overlap graph
+    node_parent.resize(n_nodes);
+    for (int i = 0; i < n_nodes; i++) {
+        node_parent[i] = i;
+    }
+    node_component.assign(n_nodes, -1);
+    for (const auto& edge : edges) {
+        int a = find_component(edge.a);
+        int b = find_component(rows + edge.b);
+        if (a != b) {
+            node_parent[a] = b;
+        }
+        node_component[edge.a]        = -2;
+        node_component[rows + edge.b] = -2;
+    }
+
+    // numbered in node order, so are the rows and cols in a component
+    int n_components = 0;
+    component_of.assign(n_nodes, -1);
+    component_rows.clear();
+    component_cols.clear();
+    node_local.resize(n_nodes);
+    for (int i = 0; i < n_nodes; i++) {
+        if (node_component[i] != -2) {
+            continue;
         }
+        int root = find_component(i);
+        if (component_of[root] < 0) {
+            component_of[root] = n_components++;
+            component_rows.push_back(0);
+            component_cols.push_back(0);
+        }
+        int c             = component_of[root];
+        node_component[i] = c;
+        node_local[i]     = i < rows ? component_rows[c]++ : component_cols[c]++;
     }
 
-    return ious;
-}
-
-vector<vector<float>> BYTETracker::iou_distance(vector<STrack*>& atracks, vector<STrack>& btracks, int& dist_size, int& dist_size_size) {
-    vector<vector<float>> cost_matrix;
-    if (atracks.size() * btracks.size() == 0) {
-        dist_size      = atracks.size();
-        dist_size_size = btracks.size();
-        return cost_matrix;
+    // edges grouped by component, component_edges[c] is the end of the group of c
+    component_edges.assign(n_components + 1, 0);
+    for (const auto& edge : edges) {
+        component_edges[node_component[edge.a] + 1]++;
     }
-
-    auto atracks_size = atracks.size();
-    auto btracks_size = btracks.size();
-
-    vector<vector<float>> atlbrs, btlbrs;
-    atlbrs.resize(atracks_size);
-    btlbrs.resize(btracks_size);
-    for (int i = 0; i < atracks_size; i++) {
-        atlbrs[i] = atracks[i]->tlbr;
+    for (int c = 0; c < n_components; c++) {
+        component_edges[c + 1] += component_edges[c];
     }
-    for (int i = 0; i < btracks_size; i++) {
-        btlbrs[i] = btracks[i].tlbr;
+    edge_order.resize(edges.size());
+    for (int e = 0; e < static_cast<int>(edges.size()); e++) {
+        edge_order[component_edges[node_component[edges[e].a]]++] = e;
     }
 
-    dist_size      = atracks.size();
-    dist_size_size = btracks.size();
+    int begin = 0;
+    for (int c = 0; c < n_components; c++) {
+        const int end = component_edges[c];
+        const int nr  = component_rows[c];
+        const int nc  = component_cols[c];
 
-    vector<vector<float>> _ious{ious(atlbrs, btlbrs)};
-    auto _ious_size = _ious.size();
-    cost_matrix.resize(_ious_size);
+        if (nr == 1 && nc == 1) {
+            const Edge& edge = edges[edge_order[begin]];
+            rowsol[edge.a]   = edge.b;
+            colsol[edge.b]   = edge.a;
+            begin            = end;
+            continue;
+        }
 
-    for (int i = 0; i < _ious_size; i++) {
-        vector<float> _iou;
-        auto _ious_i_size = _ious[i].size();
-        _iou.resize(_ious_i_size);
-        for (int j = 0; j < _ious_i_size; j++) {
-            _iou[j] = 1 - _ious[i][j];
+        local_cost.assign(static_cast<size_t>(nr) * nc, 1.0f);
+        local_rows.resize(nr);
+        local_cols.resize(nc);
+        for (int k = begin; k < end; k++) {
+            const Edge& edge = edges[edge_order[k]];
+            const int lr     = node_local[edge.a];
+            const int lc     = node_local[rows + edge.b];
+            local_cost[static_cast<size_t>(lr) * nc + lc] = edge.cost;
+            local_rows[lr]                                = edge.a;
+            local_cols[lc]                                = edge.b;
+        }
+
+        local_rowsol.assign(nr, -1);
+        local_colsol.assign(nc, -1);
+        lapjv(local_cost.data(), nr, nc, thresh, local_rowsol.data(), local_colsol.data());
+        for (int lr = 0; lr < nr; lr++) {
+            if (local_rowsol[lr] >= 0) {
+                const int r = local_rows[lr];
+                const int b = local_cols[local_rowsol[lr]];
+                rowsol[r]   = b;
+                colsol[b]   = r;
+            }
         }
-        cost_matrix[i] = _iou;
+        begin = end;
     }
 
-    return cost_matrix;
+    collect_assignment(rows, cols);
 }
 
-vector<vector<float>> BYTETracker::iou_distance(vector<STrack>& atracks, vector<STrack>& btracks) {
-    auto atracks_size = atracks.size();
-    auto btracks_size = btracks.size();
-
-    static vector<vector<float>> atlbrs, btlbrs;
+void BYTETracker::collect_assignment(int rows, int cols) {
+    matches.clear();
+    u_track.clear();
+    u_detection.clear();
 
-    atlbrs.resize(atracks_size);
-    btlbrs.resize(btracks_size);
-    for (int i = 0; i < atracks_size; i++) {
-        atlbrs[i] = atracks[i].tlbr;
-    }
-    for (int i = 0; i < btracks_size; i++) {
-        btlbrs[i] = btracks[i].tlbr;
+    for (int i = 0; i < rows; i++) {
+        if (rowsol[i] >= 0) {
+            matches.emplace_back(i, rowsol[i]);
+        } else {
+            u_track.push_back(i);
+        }
     }
 
-    vector<vector<float>> _ious{ious(atlbrs, btlbrs)};
-    auto _ious_size = _ious.size();
-    vector<vector<float>> cost_matrix;
-    cost_matrix.resize(_ious_size);
-
-    for (int i = 0; i < _ious_size; i++) {
-        vector<float> _iou;
-        auto _ious_i_size = _ious[i].size();
-        _iou.resize(_ious_i_size);
-        for (int j = 0; j < _ious_i_size; j++) {
-            _iou[j] = 1 - _ious[i][j];
+    for (int i = 0; i < cols; i++) {
+        if (colsol[i] < 0) {
+            u_detection.push_back(i);
         }
-        cost_matrix[i] = _iou;
     }
-
-    return cost_matrix;
 }
 
-double BYTETracker::lapjv(const vector<vector<float>>& cost, vector<int>& rowsol, vector<int>& colsol, bool extend_cost, float cost_limit, bool return_cost) {
-    vector<vector<float>> cost_c;
-    cost_c.assign(cost.begin(), cost.end());
-
-    vector<vector<float>> cost_c_extended;
-
-    int n_rows = cost.size();
-    int n_cols = cost[0].size();
-    rowsol.resize(n_rows);
-    colsol.resize(n_cols);
+void BYTETracker::iou_distance(const STrack* apool, const int* atracks, int asize, const STrack* bpool, const int* btracks, int bsize) {
+    cost_matrix.resize(static_cast<size_t>(asize) * bsize);
 
-    int n = 0;
-    if (n_rows == n_cols) {
-        n = n_rows;
-    } else {
-        extend_cost = true;
+    // bbox_ious
+    for (int k = 0; k < bsize; k++) {
+        const float* btlbr = bpool[btracks[k]].tlbr;
+        float box_area     = (btlbr[2] - btlbr[0] + 1) * (btlbr[3] - btlbr[1] + 1);
+        for (int n = 0; n < asize; n++) {
+            const float* atlbr = apool[atracks[n]].tlbr;
+            float iou          = 0.0;
+            float iw           = min(atlbr[2], btlbr[2]) - max(atlbr[0], btlbr[0]) + 1;
+            if (iw > 0) {
+                float ih = min(atlbr[3], btlbr[3]) - max(atlbr[1], btlbr[1]) + 1;
+                if (ih > 0) {
+                    float ua = (atlbr[2] - atlbr[0] + 1) * (atlbr[3] - atlbr[1] + 1) + box_area - iw * ih;
+                    iou      = iw * ih / ua;
+                }
+            }
+            cost_matrix[n * bsize + k] = 1 - iou;
+        }
     }
+}
 
-    if (extend_cost || cost_limit < LONG_MAX) {
-        n = n_rows + n_cols;
-        cost_c_extended.resize(n);
-        for (int i = 0; i < n; i++)
-            cost_c_extended[i].resize(n);
+void BYTETracker::iou_edges(const STrack* apool, const int* atracks, int asize, const STrack* bpool, const int* btracks, int bsize, double max_cost) {
+    edges.clear();
+    if (asize * bsize == 0) {
+        return;
+    }
 
-        if (cost_limit < LONG_MAX) {
-            for (int i = 0; i < n; i++) {
-                for (int j = 0; j < cost_c_extended[i].size(); j++) {
-                    cost_c_extended[i][j] = cost_limit / 2.0;
-                }
+    // btracks by left edge, a box reaches at most max_w to the right of it
+    float max_w = 0;
+    bucket_order.resize(bsize);
+    for (int k = 0; k < bsize; k++) {
+        const float* btlbr = bpool[btracks[k]].tlbr;
+        bucket_order[k]    = k;
+        max_w              = max(max_w, btlbr[2] - btlbr[0]);
+    }
+    sort(bucket_order.begin(), bucket_order.end(), [&](int a, int b) { return bpool[btracks[a]].tlbr[0] < bpool[btracks[b]].tlbr[0]; });
+
+    // the same costs as iou_distance, boxes overlap when both intersections are positive
+    for (int n = 0; n < asize; n++) {
+        const float* atlbr = apool[atracks[n]].tlbr;
+        auto it = lower_bound(bucket_order.begin(), bucket_order.end(), atlbr[0] - max_w - 1, [&](int k, float x) { return bpool[btracks[k]].tlbr[0] < x; });
+        for (; it != bucket_order.end(); ++it) {
+            const int k        = *it;
+            const float* btlbr = bpool[btracks[k]].tlbr;
+            if (btlbr[0] >= atlbr[2] + 1) {
+                break;
             }
-        } else {
-            float cost_max = -1.0;
-            for (int i = 0; i < cost_c.size(); i++) {
-                for (int j = 0; j < cost_c[i].size(); j++) {
-                    if (cost_c[i][j] > cost_max)
-                        cost_max = cost_c[i][j];
-                }
+            float iw = min(atlbr[2], btlbr[2]) - max(atlbr[0], btlbr[0]) + 1;
+            if (iw <= 0) {
+                continue;
             }
-            for (int i = 0; i < n; i++) {
-                for (int j = 0; j < cost_c_extended[i].size(); j++) {
-                    cost_c_extended[i][j] = cost_max + 1;
-                }
+            float ih = min(atlbr[3], btlbr[3]) - max(atlbr[1], btlbr[1]) + 1;
+            if (ih <= 0) {
+                continue;
             }
-        }
-
-        for (int i = n_rows; i < n; i++) {
-            for (int j = n_cols; j < cost_c_extended[i].size(); j++) {
-                cost_c_extended[i][j] = 0;
-            }
-        }
-        for (int i = 0; i < n_rows; i++) {
-            for (int j = 0; j < n_cols; j++) {
-                cost_c_extended[i][j] = cost_c[i][j];
+            float box_area = (btlbr[2] - btlbr[0] + 1) * (btlbr[3] - btlbr[1] + 1);
+            float ua       = (atlbr[2] - atlbr[0] + 1) * (atlbr[3] - atlbr[1] + 1) + box_area - iw * ih;
+            float cost     = 1 - iw * ih / ua;
+            if (cost < max_cost) {
+                edges.push_back(Edge{n, k, cost});
             }
         }
-
-        cost_c.clear();
-        cost_c.swap(cost_c_extended);
     }
+}
 
-    double** cost_ptr;
-    cost_ptr = new double*[sizeof(double*) * n];
-    for (int i = 0; i < n; i++)
-        cost_ptr[i] = new double[sizeof(double) * n];
+void BYTETracker::lapjv(const float* cost, int n_rows, int n_cols, float cost_limit, int* rowsol, int* colsol) {
+    // extended to a square of n_rows + n_cols, a row or column left unmatched costs cost_limit / 2,
+    // rowsol and colsol are only written on success
+    const int n = n_rows + n_cols;
+
+    lap_cost.resize(static_cast<size_t>(n) * n);
+    lap_rows.resize(n);
+    lap_x.resize(n);
+    lap_y.resize(n);
+    lap_workspace.resize((lapjv_workspace_size(n) + sizeof(double) - 1) / sizeof(double));
 
     for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            cost_ptr[i][j] = cost_c[i][j];
+        double* row = lap_cost.data() + static_cast<size_t>(i) * n;
+        lap_rows[i] = row;
+        if (i < n_rows) {
+            const float* cost_row = cost + static_cast<size_t>(i) * n_cols;
+            for (int j = 0; j < n_cols; j++) {
+                row[j] = cost_row[j];
+            }
+            for (int j = n_cols; j < n; j++) {
+                row[j] = cost_limit / 2.0;
+            }
+        } else {
+            for (int j = 0; j < n_cols; j++) {
+                row[j] = cost_limit / 2.0;
+            }
+            for (int j = n_cols; j < n; j++) {
+                row[j] = 0;
+            }
         }
     }
 
-    int* x_c = new int[sizeof(int) * n];
-    int* y_c = new int[sizeof(int) * n];
-
-    double opt = 0.0;
-
-    int ret = lapjv_internal(n, cost_ptr, x_c, y_c);
+    int ret = lapjv_internal(n, lap_rows.data(), lap_x.data(), lap_y.data(), lap_workspace.data());
     if (ret != 0) {
-        goto ReleaseMemory;
+        return;
     }
 
-    if (n != n_rows) {
-        for (int i = 0; i < n; i++) {
-            if (x_c[i] >= n_cols)
-                x_c[i] = -1;
-            if (y_c[i] >= n_rows)
-                y_c[i] = -1;
-        }
-        for (int i = 0; i < n_rows; i++) {
-            rowsol[i] = x_c[i];
-        }
-        for (int i = 0; i < n_cols; i++) {
-            colsol[i] = y_c[i];
-        }
-
-        if (return_cost) {
-            for (int i = 0; i < rowsol.size(); i++) {
-                if (rowsol[i] != -1) {
-                    opt += cost_ptr[i][rowsol[i]];
-                }
-            }
-        }
-    } else if (return_cost) {
-        for (int i = 0; i < rowsol.size(); i++) {
-            opt += cost_ptr[i][rowsol[i]];
-        }
+    for (int i = 0; i < n_rows; i++) {
+        rowsol[i] = lap_x[i] < n_cols ? lap_x[i] : -1;
     }
-
-ReleaseMemory:
-    for (int i = 0; i < n; i++) {
-        delete[] cost_ptr[i];
+    for (int i = 0; i < n_cols; i++) {
+        colsol[i] = lap_y[i] < n_rows ? lap_y[i] : -1;
     }
-    delete[] cost_ptr;
-    delete[] x_c;
-    delete[] y_c;
-
-    return opt;
 }
@@ -10,42 +10,83 @@
 
 #include <cfloat>
 #include <climits>
+#include <cstddef>
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "core/ma_types.h"
 #include "strack.h"
 
+// Tracks live in a pool of max_tracks slots allocated once, the tracked and lost lists
+// hold slot indices and removed tracks give their slot back. Detections of a frame are
+// written to a pool of max_detections slots, detections beyond it are ignored. Cost
+// matrices are flat row-major buffers kept between frames, they only grow when a frame
+// needs more than any frame before, so a steady scene runs without heap allocations.
+//
+// A track and a detection without overlap never match, so by default only overlapping pairs
+// are costed (found with a sweep over the detections sorted by left edge) and the pairs
+// are split into connected components, each solved on its own: a single pair directly, larger
+// ones with LAPJV on their own small matrix. The cost follows the number of overlaps instead
+// of tracks x detections, set_gated_assignment(false) goes back to a single dense LAPJV.
 class BYTETracker {
 public:
-    BYTETracker(int frame_rate = 10, int track_buffer = 30, float track_thresh = 0.5, float high_thresh = 0.6, float match_thresh = 0.8, float scale_factor = 1000.0);
+    BYTETracker(int frame_rate      = 10,
+                int track_buffer    = 30,
+                float track_thresh  = 0.5,
+                float high_thresh   = 0.6,
+                float match_thresh  = 0.8,
+                float scale_factor  = 1000.0,
+                size_t max_tracks     = 256,
+                size_t max_detections = 256);
     ~BYTETracker();
 
     std::vector<int> inplace_update(std::vector<ma_bbox_t>& objects);
+    // same as above, the track ids are written to ids, whose memory is reused
+    void inplace_update(std::vector<ma_bbox_t>& objects, std::vector<int>& ids);
+    // advances the tracks a frame without detections, objects and ids get the predicted boxes
+    // of the activated tracks, a lost track is kept as long as with an update without a match
+    void inplace_predict(std::vector<ma_bbox_t>& objects, std::vector<int>& ids);
+    // largest standard deviation of the predicted center of an activated track relative to
+    // its height, grows with every frame predicted without a detection, 0 without tracks
+    float uncertainty() const;
     void clear();
 
+    void set_gated_assignment(bool enable);
+
 protected:
-    std::vector<STrack> update(const std::vector<ma_bbox_t>& objects);
+    // runs a frame, output_stracks holds the slots of the activated tracks afterwards
+    void update(const std::vector<ma_bbox_t>& objects);
+    void predict();
+    void output(std::vector<ma_bbox_t>& objects, std::vector<int>& ids) const;
 
 private:
-    std::vector<STrack*> joint_stracks(std::vector<STrack*>& tlista, std::vector<STrack>& tlistb);
-    std::vector<STrack> joint_stracks(std::vector<STrack>& tlista, std::vector<STrack>& tlistb);
+    int alloc_strack();
+    void free_strack(int index);
+
+    void remove_duplicate_stracks();
+
+    // measurements of matched tracks are queued, then the filter updates them at once
+    void queue_update(int index, const STrack& det);
+    void apply_updates();
 
-    std::vector<STrack> sub_stracks(std::vector<STrack>& tlista, std::vector<STrack>& tlistb);
-    void remove_duplicate_stracks(std::vector<STrack>& resa, std::vector<STrack>& resb, std::vector<STrack>& stracksa, std::vector<STrack>& stracksb);
+    struct Edge {
+        int a;
+        int b;
+        float cost;
+    };
 
-    void linear_assignment(std::vector<std::vector<float>>& cost_matrix,
-                           int cost_matrix_size,
-                           int cost_matrix_size_size,
-                           float thresh,
-                           std::vector<std::vector<int>>& matches,
-                           std::vector<int>& unmatched_a,
-                           std::vector<int>& unmatched_b);
-    std::vector<std::vector<float>> iou_distance(std::vector<STrack*>& atracks, std::vector<STrack>& btracks, int& dist_size, int& dist_size_size);
-    std::vector<std::vector<float>> iou_distance(std::vector<STrack>& atracks, std::vector<STrack>& btracks);
-    std::vector<std::vector<float>> ious(std::vector<std::vector<float>>& atlbrs, std::vector<std::vector<float>>& btlbrs);
+    // matches atracks (rows) with btracks (cols) with a cost below thresh into matches, u_track and u_detection
+    void associate(const STrack* apool, const int* atracks, int asize, const STrack* bpool, const int* btracks, int bsize, float thresh);
 
-    double lapjv(const std::vector<std::vector<float>>& cost, std::vector<int>& rowsol, std::vector<int>& colsol, bool extend_cost = false, float cost_limit = LONG_MAX, bool return_cost = true);
+    void linear_assignment(int rows, int cols, float thresh);
+    void sparse_assignment(int rows, int cols, float thresh);
+    void collect_assignment(int rows, int cols);
+    int find_component(int node);
+
+    void iou_distance(const STrack* apool, const int* atracks, int asize, const STrack* bpool, const int* btracks, int bsize);
+    void iou_edges(const STrack* apool, const int* atracks, int asize, const STrack* bpool, const int* btracks, int bsize, double max_cost);
+    void lapjv(const float* cost, int n_rows, int n_cols, float cost_limit, int* rowsol, int* colsol);
 
 private:
     float track_thresh;
@@ -54,11 +95,69 @@ private:
     float scale_factor;
     int frame_id;
     int max_time_lost;
+    bool gated;
+
+    KalmanFilterBatch kalman_filter;
+
+    // pools
+    std::vector<STrack> stracks;
+    std::vector<int> free_stracks;
+    std::vector<STrack> detections;
+
+    // slots of stracks
+    std::vector<int> tracked_stracks;
+    std::vector<int> lost_stracks;
+    std::vector<int> unconfirmed;
+    std::vector<int> strack_pool;
+    std::vector<int> r_tracked_stracks;
+    std::vector<int> refind_stracks;
+    std::vector<int> new_stracks;
+    std::vector<int> tracked_swap;
+    std::vector<int> lost_swap;
+    std::vector<int> output_stracks;
+
+    // queued updates, slots of stracks and detections with the measurements as (x, y, a, h)
+    std::vector<int> update_stracks;
+    std::vector<int> update_detections;
+    std::vector<float> update_xyah;
+
+    // slots of detections
+    std::vector<int> detections_high;
+    std::vector<int> detections_low;
+    std::vector<int> detections_cp;
+
+    // assignment, costs are rows x cols in row-major order
+    std::vector<float> cost_matrix;
+    std::vector<std::pair<int, int>> matches;
+    std::vector<int> u_track;
+    std::vector<int> u_detection;
+    std::vector<int> rowsol;
+    std::vector<int> colsol;
+    std::vector<uint8_t> duplicated;
+
+    // gated assignment, nodes are rows then cols
+    std::vector<Edge> edges;
+    std::vector<int> bucket_order;
+    std::vector<int> node_parent;
+    std::vector<int> node_component;
+    std::vector<int> node_local;
+    std::vector<int> component_of;
+    std::vector<int> component_rows;
+    std::vector<int> component_cols;
+    std::vector<int> component_edges;
+    std::vector<int> edge_order;
+    std::vector<float> local_cost;
+    std::vector<int> local_rows;
+    std::vector<int> local_cols;
+    std::vector<int> local_rowsol;
+    std::vector<int> local_colsol;
 
-    std::vector<STrack> tracked_stracks;
-    std::vector<STrack> lost_stracks;
-    std::vector<STrack> removed_stracks;
-    KalmanFilter kalman_filter;
+    // lapjv buffers, the extended problem is square
+    std::vector<double> lap_cost;
+    std::vector<double*> lap_rows;
+    std::vector<int> lap_x;
+    std::vector<int> lap_y;
+    std::vector<double> lap_workspace;
 };
 
 #endif
@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Seeed Technology Co.,Ltd
+ */
+
+#include "kalman_filter_batch.h"
+
+// noise of the aspect ratio, which KalmanFilter does not scale with the height
+static constexpr float kInitStdA    = 1e-2f;
+static constexpr float kInitStdVelA = 1e-5f;
+static constexpr float kStdA        = 1e-2f;
+static constexpr float kStdVelA     = 1e-5f;
+static constexpr float kMeasureStdA = 1e-1f;
+
+KalmanFilterBatch::KalmanFilterBatch(size_t capacity) : _capacity(0) {
+    this->_std_weight_position = 1. / 20;
+    this->_std_weight_velocity = 1. / 160;
+
+    resize(capacity);
+}
+
+void KalmanFilterBatch::resize(size_t capacity) {
+    _capacity = capacity;
+    for (int k = 0; k < 8; k++) {
+        _mean[k].resize(capacity);
+    }
+    for (int k = 0; k < 4; k++) {
+        _cov_pp[k].resize(capacity);
+        _cov_pv[k].resize(capacity);
+        _cov_vv[k].resize(capacity);
+    }
+}
+
+size_t KalmanFilterBatch::capacity() const { return _capacity; }
+
+void KalmanFilterBatch::initiate(int index, const float measurement[4]) {
+    const float h       = measurement[3];
+    const float std_pos = 2 * _std_weight_position * h;
+    const float std_vel = 10 * _std_weight_velocity * h;
+
+    for (int k = 0; k < 4; k++) {
+        const float sp = k == 2 ? kInitStdA : std_pos;
+        const float sv = k == 2 ? kInitStdVelA : std_vel;
+
+        _mean[k][index]     = measurement[k];
+        _mean[k + 4][index] = 0;
+        _cov_pp[k][index]   = sp * sp;
+        _cov_pv[k][index]   = 0;
+        _cov_vv[k][index]   = sv * sv;
+    }
+}
+
+void KalmanFilterBatch::predict(const int* indices, size_t count) {
+    float* const h = _mean[3].data();
+
+    for (int k = 0; k < 4; k++) {
+        float* const pos = _mean[k].data();
+        float* const vel = _mean[k + 4].data();
+        float* const pp  = _cov_pp[k].data();
+        float* const pv  = _cov_pv[k].data();
+        float* const vv  = _cov_vv[k].data();
+
+        // noise variance is a + b * h^2, the height is predicted last so the one before the step is used
+        const bool  fixed = k == 2;
+        const float ap    = fixed ? kStdA * kStdA : 0;
+        const float bp    = fixed ? 0 : _std_weight_position * _std_weight_position;
+        const float av    = fixed ? kStdVelA * kStdVelA : 0;
+        const float bv    = fixed ? 0 : _std_weight_velocity * _std_weight_velocity;
+
+        for (size_t n = 0; n < count; n++) {
+            const int   i  = indices[n];
+            const float h2 = h[i] * h[i];
+            const float qp = ap + bp * h2;
+            const float qv = av + bv * h2;
+
+            // x' = F x, P' = F P F^T + Q on the block [[pp, pv], [pv, vv]] with F = [[1, 1], [0, 1]]
+            pos[i] += vel[i];
+            pp[i] += 2 * pv[i] + vv[i] + qp;
+            pv[i] += vv[i];
+            vv[i] += qv;
+        }
+    }
+}
+
+void KalmanFilterBatch::update(const int* indices, const float* measurements, size_t count) {
+    const float* const h = _mean[3].data();
+
+    for (int k = 0; k < 4; k++) {
+        float* const pos = _mean[k].data();
+        float* const vel = _mean[k + 4].data();
+        float* const pp  = _cov_pp[k].data();
+        float* const pv  = _cov_pv[k].data();
+        float* const vv  = _cov_vv[k].data();
+
+        // noise variance is a + b * h^2, the height is updated last so the predicted one is used
+        const bool  fixed = k == 2;
+        const float ar    = fixed ? kMeasureStdA * kMeasureStdA : 0;
+        const float br    = fixed ? 0 : _std_weight_position * _std_weight_position;
+
+        for (size_t n = 0; n < count; n++) {
+            const int   i = indices[n];
+            const float r = ar + br * h[i] * h[i];
+
+            // S = H P H^T + R, K = P H^T S^-1, x' = x + K (z - H x), P' = P - K S K^T
+            const float s          = pp[i] + r;
+            const float k0         = pp[i] / s;
+            const float k1         = pv[i] / s;
+            const float innovation = measurements[n * 4 + k] - pos[i];
+
+            pos[i] += k0 * innovation;
+            vel[i] += k1 * innovation;
+            vv[i] -= k1 * pv[i];
+            pv[i] -= k0 * pv[i];
+            pp[i] -= k0 * pp[i];
+        }
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Seeed Technology Co.,Ltd
+ */
+
+#ifndef _BYTETRACK_KALMAN_FILTER_BATCH_H_
+#define _BYTETRACK_KALMAN_FILTER_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The constant velocity filter of KalmanFilter for a whole track pool, the state of a track
+// is (x, y, a, h) and their velocities, indexed by the slot of the track.
+//
+// Both the motion and the measurement matrices only tie a coordinate to its own velocity,
+// and the initial and the noise covariances are diagonal, so the 8x8 covariance stays four
+// independent 2x2 blocks. Each block is kept as 3 floats (position variance, covariance,
+// velocity variance), the measurement covariance is diagonal and the gain needs no solve.
+// Means and blocks are stored per component (structure of arrays), predict and update run
+// over many tracks in one call with a few multiply-adds each.
+class KalmanFilterBatch {
+   public:
+    explicit KalmanFilterBatch(size_t capacity = 0);
+
+    void   resize(size_t capacity);
+    size_t capacity() const;
+
+    void initiate(int index, const float measurement[4]);
+    void predict(const int* indices, size_t count);
+    // measurements holds count rows of (x, y, a, h)
+    void update(const int* indices, const float* measurements, size_t count);
+
+    // component k of the mean, 0 to 3 for (x, y, a, h) and 4 to 7 for their velocities
+    float& mean(int index, int k) { return _mean[k][index]; }
+    float  mean(int index, int k) const { return _mean[k][index]; }
+    // variance of component k of the position, 0 to 3 for (x, y, a, h)
+    float variance(int index, int k) const { return _cov_pp[k][index]; }
+
+   private:
+    size_t _capacity;
+
+    std::vector<float> _mean[8];
+    std::vector<float> _cov_pp[4];
+    std::vector<float> _cov_pv[4];
+    std::vector<float> _cov_vv[4];
+
+    float _std_weight_position;
+    float _std_weight_velocity;
+};
+
+#endif
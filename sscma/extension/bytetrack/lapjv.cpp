@@ -25,9 +25,8 @@
         x = nullptr;    \
     }
 
-int _ccrrt_dense(const unsigned int n, double* cost[], int* free_rows, int* x, int* y, double* v) {
-    int   n_free_rows;
-    char* unique;
+int _ccrrt_dense(const unsigned int n, double* cost[], int* free_rows, int* x, int* y, double* v, char* unique) {
+    int n_free_rows;
 
     for (unsigned int i = 0; i < n; i++) {
         x[i] = -1;
@@ -44,7 +43,6 @@ int _ccrrt_dense(const unsigned int n, double* cost[], int* free_rows, int* x, i
         }
     }
 
-    NEW(unique, char, n);
     std::memset(unique, 1, n);
     {
         int j = n;
@@ -79,7 +77,6 @@ int _ccrrt_dense(const unsigned int n, double* cost[], int* free_rows, int* x, i
             v[j] -= min;
         }
     }
-    FREE(unique);
     return n_free_rows;
 }
 
@@ -202,15 +199,10 @@ int _scan_dense(const unsigned int n,
     return -1;
 }
 
-int find_path_dense(const unsigned int n, double* cost[], const int start_i, int* y, double* v, int* pred) {
+int find_path_dense(const unsigned int n, double* cost[], const int start_i, int* y, double* v, int* pred, int* cols, double* d) {
     unsigned int lo = 0, hi = 0;
     int          final_j = -1;
     unsigned int n_ready = 0;
-    int*         cols;
-    double*      d;
-
-    NEW(cols, int, n);
-    NEW(d, double, n);
 
     for (unsigned int i = 0; i < n; i++) {
         cols[i] = i;
@@ -243,26 +235,27 @@ int find_path_dense(const unsigned int n, double* cost[], const int start_i, int
         }
     }
 
-    FREE(cols);
-    FREE(d);
-
     return final_j;
 }
 
-int _ca_dense(
-  const unsigned int n, double* cost[], const unsigned int n_free_rows, int* free_rows, int* x, int* y, double* v) {
-    int* pred;
-
-    NEW(pred, int, n);
+int _ca_dense(const unsigned int n,
+              double*            cost[],
+              const unsigned int n_free_rows,
+              int*               free_rows,
+              int*               x,
+              int*               y,
+              double*            v,
+              int*               pred,
+              int*               cols,
+              double*            d) {
 
     for (int* pfree_i = free_rows; pfree_i < free_rows + n_free_rows; pfree_i++) {
         int          i = -1, j;
         unsigned int k = 0;
 
-        j = find_path_dense(n, cost, *pfree_i, y, v, pred);
+        j = find_path_dense(n, cost, *pfree_i, y, v, pred, cols, d);
 
         if (j < 0 || j >= n) {
-            FREE(pred);
             return -1;
         }
 
@@ -274,34 +267,46 @@ int _ca_dense(
             SWAP_INDICES(j, x[i]);
             k++;
             if (k >= n) {
-                FREE(pred);
                 return -1;
             }
         }
     }
 
-    FREE(pred);
     return 0;
 }
 
-int lapjv_internal(const unsigned int n, double* cost[], int* x, int* y) {
-    int     ret;
-    int*    free_rows;
-    double* v;
-
-    NEW(free_rows, int, n);
-    NEW(v, double, n);
-    ret   = _ccrrt_dense(n, cost, free_rows, x, y, v);
-    int i = 0;
+size_t lapjv_workspace_size(const unsigned int n) {
+    // v and d, then free_rows, pred and cols, then unique
+    return n * (2 * sizeof(double) + 3 * sizeof(int) + sizeof(char));
+}
+
+int lapjv_internal(const unsigned int n, double* cost[], int* x, int* y, void* workspace) {
+    double* v         = static_cast<double*>(workspace);
+    double* d         = v + n;
+    int*    free_rows = reinterpret_cast<int*>(d + n);
+    int*    pred      = free_rows + n;
+    int*    cols      = pred + n;
+    char*   unique    = reinterpret_cast<char*>(cols + n);
+
+    int ret = _ccrrt_dense(n, cost, free_rows, x, y, v, unique);
+    int i   = 0;
     while (ret > 0 && i < 2) {
         ret = _carr_dense(n, cost, ret, free_rows, x, y, v);
         i++;
     }
     if (ret > 0) {
-        ret = _ca_dense(n, cost, ret, free_rows, x, y, v);
+        ret = _ca_dense(n, cost, ret, free_rows, x, y, v, pred, cols, d);
     }
-    FREE(v);
-    FREE(free_rows);
 
     return ret;
-}
\ No newline at end of file
+}
+
+int lapjv_internal(const unsigned int n, double* cost[], int* x, int* y) {
+    double* workspace;
+
+    NEW(workspace, double, (lapjv_workspace_size(n) + sizeof(double) - 1) / sizeof(double));
+    int ret = lapjv_internal(n, cost, x, y, workspace);
+    FREE(workspace);
+
+    return ret;
+}
@@ -1,8 +1,13 @@
 #ifndef _BYTETRACK_LAPJV_H_
 #define _BYTETRACK_LAPJV_H_
 
+#include <cstddef>
 #include <cstdint>
 
+// bytes of scratch memory lapjv_internal needs for a n x n problem, aligned as double
+size_t lapjv_workspace_size(const unsigned int n);
+
+int lapjv_internal(const unsigned int n, double* cost[], int* x, int* y, void* workspace);
 int lapjv_internal(const unsigned int n, double* cost[], int* x, int* y);
 
-#endif
\ No newline at end of file
+#endif
@@ -7,22 +7,29 @@
 
 #include "strack.h"
 
-using namespace std;
+STrack::STrack() {
+    const float zero[4] = {0, 0, 0, 0};
+    reset(zero, 0, 0);
+}
+
+STrack::~STrack() {}
 
-STrack::STrack(vector<float> tlwh_, float score, int label) {
-    _tlwh.resize(4);
-    _tlwh.assign(tlwh_.begin(), tlwh_.end());
+void STrack::reset(const float tlwh_[4], float score, int label) {
+    for (int i = 0; i < 4; ++i) {
+        _tlwh[i] = tlwh_[i];
+    }
 
     is_activated = false;
     track_id     = 0;
     state        = TrackState::New;
 
-    tlwh.resize(4);
-    tlbr.resize(4);
-
-    static_tlwh();
+    tlwh[0] = _tlwh[0];
+    tlwh[1] = _tlwh[1];
+    tlwh[2] = _tlwh[2];
+    tlwh[3] = _tlwh[3];
     static_tlbr();
 
+    slot         = -1;
     frame_id     = 0;
     tracklet_len = 0;
     this->score  = score;
@@ -31,29 +38,15 @@ STrack::STrack(vector<float> tlwh_, float score, int label) {
     this->label = label;
 }
 
-STrack::~STrack() {}
+void STrack::activate(KalmanFilterBatch& kalman_filter, int slot, int frame_id) {
+    this->track_id = this->next_id();
+    this->slot     = slot;
 
-void STrack::activate(KalmanFilter& kalman_filter, int frame_id) {
-    this->kalman_filter = kalman_filter;
-    this->track_id      = this->next_id();
-
-    vector<float> _tlwh_tmp(4);
-    _tlwh_tmp[0] = this->_tlwh[0];
-    _tlwh_tmp[1] = this->_tlwh[1];
-    _tlwh_tmp[2] = this->_tlwh[2];
-    _tlwh_tmp[3] = this->_tlwh[3];
-
-    vector<float> xyah = tlwh_to_xyah(_tlwh_tmp);
-    DETECTBOX     xyah_box;
-    xyah_box[0]      = xyah[0];
-    xyah_box[1]      = xyah[1];
-    xyah_box[2]      = xyah[2];
-    xyah_box[3]      = xyah[3];
-    auto mc          = this->kalman_filter.initiate(xyah_box);
-    this->mean       = mc.first;
-    this->covariance = mc.second;
-
-    static_tlwh();
+    float xyah[4];
+    tlwh_to_xyah(this->_tlwh, xyah);
+    kalman_filter.initiate(slot, xyah);
+
+    static_tlwh(kalman_filter);
     static_tlbr();
 
     this->tracklet_len = 0;
@@ -65,18 +58,8 @@ void STrack::activate(KalmanFilter& kalman_filter, int frame_id) {
     this->start_frame = frame_id;
 }
 
-void STrack::re_activate(STrack& new_track, int frame_id, bool new_id) {
-    vector<float> xyah = tlwh_to_xyah(new_track.tlwh);
-    DETECTBOX     xyah_box;
-    xyah_box[0]      = xyah[0];
-    xyah_box[1]      = xyah[1];
-    xyah_box[2]      = xyah[2];
-    xyah_box[3]      = xyah[3];
-    auto mc          = this->kalman_filter.update(this->mean, this->covariance, xyah_box);
-    this->mean       = mc.first;
-    this->covariance = mc.second;
-
-    static_tlwh();
+void STrack::re_activate(const KalmanFilterBatch& kalman_filter, const STrack& new_track, int frame_id, bool new_id) {
+    static_tlwh(kalman_filter);
     static_tlbr();
 
     this->tracklet_len = 0;
@@ -87,22 +70,11 @@ void STrack::re_activate(STrack& new_track, int frame_id, bool new_id) {
     if (new_id) this->track_id = next_id();
 }
 
-void STrack::update(STrack& new_track, int frame_id) {
+void STrack::update(const KalmanFilterBatch& kalman_filter, const STrack& new_track, int frame_id) {
     this->frame_id = frame_id;
     this->tracklet_len++;
 
-    vector<float> xyah = tlwh_to_xyah(new_track.tlwh);
-    DETECTBOX     xyah_box;
-    xyah_box[0] = xyah[0];
-    xyah_box[1] = xyah[1];
-    xyah_box[2] = xyah[2];
-    xyah_box[3] = xyah[3];
-
-    auto mc          = this->kalman_filter.update(this->mean, this->covariance, xyah_box);
-    this->mean       = mc.first;
-    this->covariance = mc.second;
-
-    static_tlwh();
+    static_tlwh(kalman_filter);
     static_tlbr();
 
     this->state        = TrackState::Tracked;
@@ -111,19 +83,11 @@ void STrack::update(STrack& new_track, int frame_id) {
     this->score = new_track.score;
 }
 
-void STrack::static_tlwh() {
-    if (this->state == TrackState::New) {
-        tlwh[0] = _tlwh[0];
-        tlwh[1] = _tlwh[1];
-        tlwh[2] = _tlwh[2];
-        tlwh[3] = _tlwh[3];
-        return;
-    }
-
-    tlwh[0] = mean[0];
-    tlwh[1] = mean[1];
-    tlwh[2] = mean[2];
-    tlwh[3] = mean[3];
+void STrack::static_tlwh(const KalmanFilterBatch& kalman_filter) {
+    tlwh[0] = kalman_filter.mean(slot, 0);
+    tlwh[1] = kalman_filter.mean(slot, 1);
+    tlwh[2] = kalman_filter.mean(slot, 2);
+    tlwh[3] = kalman_filter.mean(slot, 3);
 
     tlwh[2] *= tlwh[3];
     tlwh[0] -= tlwh[2] / 2;
@@ -131,26 +95,20 @@ void STrack::static_tlwh() {
 }
 
 void STrack::static_tlbr() {
-    tlbr.clear();
-    tlbr.assign(tlwh.begin(), tlwh.end());
-    tlbr[2] += tlbr[0];
-    tlbr[3] += tlbr[1];
+    tlbr[0] = tlwh[0];
+    tlbr[1] = tlwh[1];
+    tlbr[2] = tlwh[0] + tlwh[2];
+    tlbr[3] = tlwh[1] + tlwh[3];
 }
 
-vector<float> STrack::tlwh_to_xyah(vector<float> tlwh_tmp) {
-    tlwh_tmp[0] += tlwh_tmp[2] / 2;
-    tlwh_tmp[1] += tlwh_tmp[3] / 2;
-    tlwh_tmp[2] /= tlwh_tmp[3];
-    return tlwh_tmp;
+void STrack::tlwh_to_xyah(const float tlwh_tmp[4], float xyah[4]) {
+    xyah[0] = tlwh_tmp[0] + tlwh_tmp[2] / 2;
+    xyah[1] = tlwh_tmp[1] + tlwh_tmp[3] / 2;
+    xyah[2] = tlwh_tmp[2] / tlwh_tmp[3];
+    xyah[3] = tlwh_tmp[3];
 }
 
-vector<float> STrack::to_xyah() { return tlwh_to_xyah(tlwh); }
-
-vector<float> STrack::tlbr_to_tlwh(vector<float>& tlbr) {
-    tlbr[2] -= tlbr[0];
-    tlbr[3] -= tlbr[1];
-    return tlbr;
-}
+void STrack::to_xyah(float xyah[4]) const { tlwh_to_xyah(tlwh, xyah); }
 
 void STrack::mark_lost() { state = TrackState::Lost; }
 
@@ -161,13 +119,18 @@ int STrack::next_id() {
     return ++_count;
 }
 
-int STrack::end_frame() { return this->frame_id; }
+int STrack::end_frame() const { return this->frame_id; }
 
-void STrack::multi_predict(vector<STrack*>& stracks, KalmanFilter& kalman_filter) {
-    for (int i = 0; i < stracks.size(); ++i) {
-        stracks[i]->mean[7] = !(stracks[i]->state ^ TrackState::Tracked);
-        kalman_filter.predict(stracks[i]->mean, stracks[i]->covariance);
-        stracks[i]->static_tlwh();
-        stracks[i]->static_tlbr();
+void STrack::multi_predict(STrack* stracks, const int* indices, size_t count, KalmanFilterBatch& kalman_filter) {
+    // the slots of the pool are the ones of the filter
+    for (size_t i = 0; i < count; ++i) {
+        const STrack& track               = stracks[indices[i]];
+        kalman_filter.mean(track.slot, 7) = !(track.state ^ TrackState::Tracked);
+    }
+    kalman_filter.predict(indices, count);
+    for (size_t i = 0; i < count; ++i) {
+        STrack& track = stracks[indices[i]];
+        track.static_tlwh(kalman_filter);
+        track.static_tlbr();
     }
-}
\ No newline at end of file
+}
@@ -11,53 +11,53 @@
 #include <cfloat>
 #include <cstddef>
 #include <cstdint>
-#include <vector>
 
-#include "kalman_filter.h"
+#include "kalman_filter_batch.h"
 
 enum TrackState { New = 0, Tracked, Lost, Removed };
 
+// a slot of the track pools of BYTETracker, holds no heap memory so slots are reused as is,
+// the Kalman state of a track is kept by the KalmanFilterBatch of the tracker at its slot
 class STrack {
    public:
-    STrack(std::vector<float> tlwh_, float score, int label);
+    STrack();
     ~STrack();
 
-    std::vector<float> static tlbr_to_tlwh(std::vector<float>& tlbr);
-    void static multi_predict(std::vector<STrack*>& stracks, KalmanFilter& kalman_filter);
-    void               static_tlwh();
-    void               static_tlbr();
-    std::vector<float> tlwh_to_xyah(std::vector<float> tlwh_tmp);
-    std::vector<float> to_xyah();
-    void               mark_lost();
-    void               mark_removed();
-    int                next_id();
-    int                end_frame();
-
-    void activate(KalmanFilter& kalman_filter, int frame_id);
-    void re_activate(STrack& new_track, int frame_id, bool new_id = false);
-    void update(STrack& new_track, int frame_id);
+    // makes the slot a new detection
+    void reset(const float tlwh_[4], float score, int label);
+
+    static void tlwh_to_xyah(const float tlwh_tmp[4], float xyah[4]);
+    static void multi_predict(STrack* stracks, const int* indices, size_t count, KalmanFilterBatch& kalman_filter);
+    void        static_tlwh(const KalmanFilterBatch& kalman_filter);
+    void        static_tlbr();
+    void        to_xyah(float xyah[4]) const;
+    void        mark_lost();
+    void        mark_removed();
+    int         next_id();
+    int         end_frame() const;
+
+    void activate(KalmanFilterBatch& kalman_filter, int slot, int frame_id);
+    // the filter is updated with the measurement of new_track by the caller, for many tracks at once
+    void re_activate(const KalmanFilterBatch& kalman_filter, const STrack& new_track, int frame_id, bool new_id = false);
+    void update(const KalmanFilterBatch& kalman_filter, const STrack& new_track, int frame_id);
 
    public:
     bool is_activated;
     int  track_id;
     int  state;
 
-    std::vector<float> _tlwh;
-    std::vector<float> tlwh;
-    std::vector<float> tlbr;
+    float _tlwh[4];
+    float tlwh[4];
+    float tlbr[4];
 
     int frame_id;
     int tracklet_len;
     int start_frame;
 
-    KAL_MEAN mean;
-    KAL_COVA covariance;
+    int slot;  // in the filter, -1 for a detection
 
     float score;
     int   label;
-
-   private:
-    KalmanFilter kalman_filter;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,11 +1,15 @@
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 #include "counter.h"
 
 
 Counter::Counter(int32_t frame_rate)
-    : frame_rate(frame_rate), countAB(0), countBA(0), splitter({0, 0, 0, 0}) {}
+    : frame_rate(frame_rate), frame(0), countAB(0), countBA(0), splitter({0, 0, 0, 0}), polygons(0), grid_x(0), grid_y(0), cell_w(1), cell_h(1) {
+    std::memset(grid, 0, sizeof(grid));
+}
 Counter::~Counter() {}
 
 int Counter::getSide(int16_t x, int16_t y) {
@@ -19,38 +23,143 @@ int Counter::getSide(int16_t x, int16_t y) {
     return 0;
 }
 
-void Counter::update(int32_t id, int16_t x, int16_t y) {
-    if (id != -1) {
-        if (objects.find(id) == objects.end()) {
-            objects[id]      = object{.id = id, .x = x, .y = y, .count = 0};
-            objects[id].side = getSide(x, y);
-        } else {
-            object& obj  = objects[id];
-            obj.x        = x;
-            obj.y        = y;
-            obj.count    = 0;
-            int32_t side = getSide(x, y);
-            if (obj.side == -1 && side == 1) {
-                countAB += 1;
-            } else if (obj.side == 1 && side == -1) {
-                countBA += 1;
+void Counter::move(int32_t id, int16_t x, int16_t y) {
+    if (id == -1) {
+        return;
+    }
+    auto it = objects.find(id);
+    if (it == objects.end()) {
+        object obj{};
+        obj.id    = id;
+        obj.x     = x;
+        obj.y     = y;
+        obj.count = 0;
+        obj.side  = getSide(x, y);
+        cross(obj, x, y, false);
+        objects.emplace(id, obj);
+    } else {
+        object& obj = it->second;
+        cross(obj, x, y, true);
+        obj.x        = x;
+        obj.y        = y;
+        obj.count    = 0;
+        int32_t side = getSide(x, y);
+        if (side == 0) {
+            return;  // on the line, the crossing is counted once it is left on the other side
+        }
+        if (obj.side == -1 && side == 1) {
+            countAB += 1;
+        } else if (obj.side == 1 && side == -1) {
+            countBA += 1;
+        }
+        obj.side = side;
+    }
+}
+
+void Counter::cross(object& obj, int16_t x, int16_t y, bool moved) {
+    uint32_t inside = 0;
+    for (uint32_t i = 0; i < zones.size(); i++) {
+        const uint32_t bit = 1u << i;
+        zone& z            = zones[i];
+        if (z.type == MA_ZONE_TYPE_POLYGON) {
+            continue;
+        }
+        float value = (x - z.x0) * z.dy - (y - z.y0) * z.dx;
+        if (value == 0) {
+            continue;  // on the line keeps the last side
+        }
+        const bool positive = value > 0;
+        if (moved && (obj.sided & bit) && positive != ((obj.positive & bit) != 0)) {
+            // the side changed since the last position, counted if the step passes through the segment
+            float last = (obj.x - z.x0) * z.dy - (obj.y - z.y0) * z.dx;
+            float t    = last / (last - value);
+            float px   = obj.x + (x - obj.x) * t - z.x0;
+            float py   = obj.y + (y - obj.y) * t - z.y0;
+            float u    = (px * z.dx + py * z.dy) * z.inv_length2;
+            if (u >= 0.f && u <= 1.f) {
+                if (positive) {
+                    z.in += 1;
+                } else {
+                    z.out += 1;
+                }
             }
-            obj.side = side;
         }
+        obj.sided |= bit;
+        obj.positive = positive ? obj.positive | bit : obj.positive & ~bit;
     }
-    for (auto& obj : objects) {
-        obj.second.count += 1;
-        if (obj.second.count > frame_rate) {
-            obj.second.count = 0;
-            objects.erase(obj.first);  // object lost
+
+    for (uint32_t candidates = lookup(x, y); candidates != 0; candidates &= candidates - 1) {
+        uint32_t i = 0;
+        while (!(candidates & (1u << i))) {
+            i++;
+        }
+        if (contains(zones[i], x, y)) {
+            inside |= 1u << i;
+        }
+    }
+    for (uint32_t i = 0; i < zones.size(); i++) {
+        const uint32_t bit = 1u << i;
+        if ((inside & bit) && !(obj.inside & bit)) {
+            zones[i].in += 1;
+            zones[i].occupancy += 1;
+            obj.since[i] = frame;
+        } else if (!(inside & bit) && (obj.inside & bit)) {
+            leave(obj, i, frame);
+        }
+    }
+    obj.inside = inside;
+}
+
+void Counter::leave(object& obj, uint32_t i, int32_t end) {
+    zone& z = zones[i];
+    z.out += 1;
+    z.occupancy -= 1;
+    z.visits += 1;
+    z.dwell += std::max(0, end - obj.since[i]);
+}
+
+void Counter::age() {
+    for (auto it = objects.begin(); it != objects.end();) {
+        it->second.count += 1;
+        if (it->second.count > frame_rate) {
+            for (uint32_t i = 0; i < zones.size(); i++) {
+                if (it->second.inside & (1u << i)) {
+                    leave(it->second, i, frame - it->second.count + 1);  // left after it was last seen
+                }
+            }
+            it = objects.erase(it);  // object lost
+        } else {
+            ++it;
         }
     }
+    frame += 1;
+}
+
+void Counter::update(int32_t id, int16_t x, int16_t y) {
+    move(id, x, y);
+    age();
+}
+
+void Counter::update(const std::vector<int32_t>& ids, const std::vector<int16_t>& xs, const std::vector<int16_t>& ys) {
+    size_t count = std::min(ids.size(), std::min(xs.size(), ys.size()));
+    for (size_t i = 0; i < count; i++) {
+        move(ids[i], xs[i], ys[i]);
+    }
+    age();
 }
 
 void Counter::clear() {
     objects.clear();
     countAB = 0;
     countBA = 0;
+    frame   = 0;
+    for (auto& z : zones) {
+        z.in        = 0;
+        z.out       = 0;
+        z.occupancy = 0;
+        z.visits    = 0;
+        z.dwell     = 0;
+    }
 }
 
 void Counter::setSplitter(std::vector<int16_t> splitter) {
@@ -83,3 +192,157 @@ std::vector<int32_t> Counter::get() {
 std::vector<int16_t> Counter::getSplitter() {
     return splitter;
 }
+
+bool Counter::reserve(const std::string& name) {
+    if (zones.size() >= COUNTER_ZONE_MAX || name.empty()) {
+        return false;
+    }
+    for (const auto& z : zones) {
+        if (z.name == name) {
+            return false;
+        }
+    }
+    zones.emplace_back();
+    zone& z = zones.back();
+    z       = zone{};
+    z.name  = name;
+    return true;
+}
+
+bool Counter::addLine(const std::string& name, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    if ((x0 == x1 && y0 == y1) || !reserve(name)) {
+        return false;
+    }
+    zone& z       = zones.back();
+    z.type        = MA_ZONE_TYPE_LINE;
+    z.x0          = x0;
+    z.y0          = y0;
+    z.dx          = static_cast<float>(x1 - x0);
+    z.dy          = static_cast<float>(y1 - y0);
+    z.inv_length2 = 1.f / (z.dx * z.dx + z.dy * z.dy);
+    return true;
+}
+
+bool Counter::addZone(const std::string& name, const std::vector<int16_t>& points) {
+    size_t corners = points.size() / 2;
+    if (corners < 3 || !reserve(name)) {
+        return false;
+    }
+    zone& z  = zones.back();
+    z.type   = MA_ZONE_TYPE_POLYGON;
+    z.left   = INT16_MAX;
+    z.top    = INT16_MAX;
+    z.right  = INT16_MIN;
+    z.bottom = INT16_MIN;
+    z.first  = edges.size();
+    for (size_t i = 0; i < corners; i++) {
+        int16_t ax = points[i * 2], ay = points[i * 2 + 1];
+        int16_t bx = points[(i + 1) % corners * 2], by = points[(i + 1) % corners * 2 + 1];
+        z.left     = std::min(z.left, ax);
+        z.top      = std::min(z.top, ay);
+        z.right    = std::max(z.right, ax);
+        z.bottom   = std::max(z.bottom, ay);
+        if (ay == by) {
+            continue;  // a horizontal edge is never crossed by a row
+        }
+        if (ay > by) {
+            std::swap(ax, bx);
+            std::swap(ay, by);
+        }
+        edges.push_back(edge{static_cast<float>(ay), static_cast<float>(by), static_cast<float>(ax), static_cast<float>(bx - ax) / (by - ay)});
+    }
+    z.size = edges.size() - z.first;
+    if (z.size == 0) {
+        zones.pop_back();
+        return false;
+    }
+    polygons |= 1u << (zones.size() - 1);
+    index();
+    return true;
+}
+
+void Counter::clearZones() {
+    for (auto& obj : objects) {
+        obj.second.sided  = 0;
+        obj.second.inside = 0;
+    }
+    zones.clear();
+    edges.clear();
+    stats.clear();
+    polygons = 0;
+    index();
+}
+
+void Counter::index() {
+    std::memset(grid, 0, sizeof(grid));
+    if (polygons == 0) {
+        return;
+    }
+
+    int32_t left = INT16_MAX, top = INT16_MAX, right = INT16_MIN, bottom = INT16_MIN;
+    for (const auto& z : zones) {
+        if (z.type == MA_ZONE_TYPE_POLYGON) {
+            left   = std::min<int32_t>(left, z.left);
+            top    = std::min<int32_t>(top, z.top);
+            right  = std::max<int32_t>(right, z.right);
+            bottom = std::max<int32_t>(bottom, z.bottom);
+        }
+    }
+    grid_x = left;
+    grid_y = top;
+    cell_w = std::max<int32_t>(1, (right - left + COUNTER_GRID) / COUNTER_GRID);
+    cell_h = std::max<int32_t>(1, (bottom - top + COUNTER_GRID) / COUNTER_GRID);
+
+    for (uint32_t i = 0; i < zones.size(); i++) {
+        const zone& z = zones[i];
+        if (z.type != MA_ZONE_TYPE_POLYGON) {
+            continue;
+        }
+        for (int32_t cy = (z.top - grid_y) / cell_h; cy <= (z.bottom - grid_y) / cell_h; cy++) {
+            for (int32_t cx = (z.left - grid_x) / cell_w; cx <= (z.right - grid_x) / cell_w; cx++) {
+                grid[cy * COUNTER_GRID + cx] |= 1u << i;
+            }
+        }
+    }
+}
+
+uint32_t Counter::lookup(int16_t x, int16_t y) const {
+    if (polygons == 0 || x < grid_x || y < grid_y) {
+        return 0;
+    }
+    int32_t cx = (x - grid_x) / cell_w;
+    int32_t cy = (y - grid_y) / cell_h;
+    if (cx >= COUNTER_GRID || cy >= COUNTER_GRID) {
+        return 0;
+    }
+    return grid[cy * COUNTER_GRID + cx];
+}
+
+bool Counter::contains(const zone& z, int16_t x, int16_t y) const {
+    if (x < z.left || x > z.right || y < z.top || y > z.bottom) {
+        return false;
+    }
+    bool inside = false;
+    for (uint32_t i = z.first; i < z.first + z.size; i++) {
+        const edge& e = edges[i];
+        if (y >= e.y0 && y < e.y1 && x < e.x0 + (y - e.y0) * e.slope) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+const std::vector<ma_zone_t>& Counter::getZones() {
+    stats.resize(zones.size());
+    for (size_t i = 0; i < zones.size(); i++) {
+        const zone& z      = zones[i];
+        ma_zone_t& stat    = stats[i];
+        stat.name          = z.name.c_str();
+        stat.type          = z.type;
+        stat.in            = z.in;
+        stat.out           = z.out;
+        stat.occupancy     = z.occupancy;
+        stat.dwell         = z.visits > 0 ? static_cast<int32_t>(z.dwell / z.visits) : 0;
+    }
+    return stats;
+}
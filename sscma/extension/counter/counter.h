@@ -8,14 +8,28 @@
 #define _COUNTER_H_
 
 #include <stdint.h>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "core/ma_types.h"
+
+// Next to the splitter, any number of named lines and polygons (up to COUNTER_ZONE_MAX) are
+// counted in the same pass over the objects of a frame. A line keeps its (dx, dy) so the side of
+// a point is one cross product, a polygon keeps its edges as (y range, x at the start, dx/dy) so
+// the point-in-polygon test is a multiply per edge spanning the row. Polygons are found through
+// a coarse grid over their bounds, each cell holds a mask of the polygons overlapping it, so a
+// point only tests the polygons of its cell. Dwell times are in frames, one per update of a frame.
+#define COUNTER_ZONE_MAX 32
+#define COUNTER_GRID     16
+
 class Counter {
 public:
     Counter(int32_t frame_rate = 10);
     ~Counter();
     void update(int32_t id, int16_t x, int16_t y);
+    // all objects of a frame at once, objects are aged once per call
+    void update(const std::vector<int32_t>& ids, const std::vector<int16_t>& xs, const std::vector<int16_t>& ys);
     void clear();
     struct object {
         int32_t id;
@@ -23,20 +37,82 @@ public:
         int16_t y;
         int16_t side;
         int32_t count;
+        uint32_t sided;     // lines the object has been off
+        uint32_t positive;  // lines the object was last on the left of
+        uint32_t inside;    // polygons the object is in
+        int32_t since[COUNTER_ZONE_MAX];
     };
     void setSplitter(std::vector<int16_t> splitter);
     std::vector<int16_t> getSplitter();
     std::vector<int32_t> get();
 
+    // false when full, the name is taken or the shape is degenerate
+    bool addLine(const std::string& name, int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+    // points as x0, y0, x1, y1, ... of at least 3 corners
+    bool addZone(const std::string& name, const std::vector<int16_t>& points);
+    void clearZones();
+    const std::vector<ma_zone_t>& getZones();
+
 protected:
     int getSide(int16_t x, int16_t y);
+    void move(int32_t id, int16_t x, int16_t y);
+    void age();
 
 private:
+    struct edge {
+        float y0;
+        float y1;
+        float x0;
+        float slope;
+    };
+
+    struct zone {
+        std::string name;
+        ma_zone_type_t type;
+        // line
+        int16_t x0;
+        int16_t y0;
+        float dx;
+        float dy;
+        float inv_length2;
+        // polygon, edges[first, first + size)
+        int16_t left;
+        int16_t top;
+        int16_t right;
+        int16_t bottom;
+        uint32_t first;
+        uint32_t size;
+        // counts
+        int32_t in;
+        int32_t out;
+        int32_t occupancy;
+        int32_t visits;
+        int64_t dwell;
+    };
+
+    bool reserve(const std::string& name);
+    void index();
+    uint32_t lookup(int16_t x, int16_t y) const;
+    bool contains(const zone& z, int16_t x, int16_t y) const;
+    void cross(object& obj, int16_t x, int16_t y, bool moved);
+    void leave(object& obj, uint32_t i, int32_t end);
+
     int32_t frame_rate;
+    int32_t frame;
     int32_t countAB;  // A -> B
     int32_t countBA;  // B -> A
     std::vector<int16_t> splitter;
     std::unordered_map<int32_t, object> objects;
+
+    std::vector<zone> zones;
+    std::vector<edge> edges;
+    std::vector<ma_zone_t> stats;
+    uint32_t polygons;
+    int16_t grid_x;
+    int16_t grid_y;
+    int32_t cell_w;
+    int32_t cell_h;
+    uint32_t grid[COUNTER_GRID * COUNTER_GRID];
 };
 
 #endif
@@ -26,7 +26,10 @@ class Device final {
     const std::vector<Transport*>& getTransports() noexcept { return m_transports; }
     const std::vector<Sensor*>&    getSensors() noexcept { return m_sensors; }
     const std::vector<ma_model_t>& getModels() noexcept { return m_models; }
-    Storage*                       getStorage() noexcept { return m_storage; }
+    Storage*                       getStorage() noexcept { return m_storage_overlay ? m_storage_overlay : m_storage; }
+
+    // storage accesses go through overlay (a write-back cache for instance) until reset with nullptr
+    void setStorageOverlay(Storage* overlay) noexcept { m_storage_overlay = overlay; }
 
    private:
     Device(const Device&)            = delete;
@@ -44,6 +47,7 @@ class Device final {
     std::vector<Sensor*>    m_sensors;
     std::vector<ma_model_t> m_models;
     Storage*                m_storage;
+    Storage*                m_storage_overlay = nullptr;
 };
 
 }  // namespace ma
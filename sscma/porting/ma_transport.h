@@ -6,6 +6,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <new>
 
 namespace ma {
 
@@ -23,13 +25,55 @@ class Transport {
     [[nodiscard]] operator bool() const noexcept { return m_initialized; }
     [[nodiscard]] ma_transport_type_t getType() const noexcept { return m_type; }
 
+    // the transport per connection state is kept for, a wrapper running commands on behalf of another one returns it
+    [[nodiscard]] virtual Transport& underlying() noexcept { return *this; }
+
     [[nodiscard]] virtual size_t available() const noexcept                                    = 0;
     virtual size_t               send(const char* data, size_t length) noexcept                = 0;
     virtual size_t               flush() noexcept                                              = 0;
     virtual size_t               receive(char* data, size_t length) noexcept                   = 0;
     virtual size_t               receiveIf(char* data, size_t length, char delimiter) noexcept = 0;
 
+    // sends the parts in order as one message, transports able to queue several buffers (sockets, DMA) should override it,
+    // a byte stream gets the parts one after another, a message transport gets them copied into one buffer and sent once
+    virtual size_t sendv(const ma_iovec_t* iov, size_t iovcnt) noexcept {
+        if (iovcnt == 1 || !isMessageBased()) {
+            size_t sent = 0;
+            for (size_t i = 0; i < iovcnt; ++i) {
+                size_t n = send(static_cast<const char*>(iov[i].base), iov[i].len);
+                sent += n;
+                if (n != iov[i].len) {
+                    break;
+                }
+            }
+            return sent;
+        }
+
+        size_t total = 0;
+        for (size_t i = 0; i < iovcnt; ++i) {
+            total += iov[i].len;
+        }
+        // gathered per call, sends of other threads on this transport must not share it
+        char* buffer = new (std::nothrow) char[total];
+        if (buffer == nullptr) {
+            return 0;
+        }
+        size_t offset = 0;
+        for (size_t i = 0; i < iovcnt; ++i) {
+            std::memcpy(buffer + offset, iov[i].base, iov[i].len);
+            offset += iov[i].len;
+        }
+        size_t sent = send(buffer, total);
+        delete[] buffer;
+        return sent;
+    }
+
    protected:
+    // every send is delivered as a message of its own
+    [[nodiscard]] bool isMessageBased() const noexcept {
+        return m_type == MA_TRANSPORT_MQTT || m_type == MA_TRANSPORT_UDP || m_type == MA_TRANSPORT_WS || m_type == MA_TRANSPORT_RTSP;
+    }
+
     bool                m_initialized;
     ma_transport_type_t m_type;
 };
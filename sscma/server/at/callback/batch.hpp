@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+#include "server/at/ma_storage_batch.h"
+
+namespace ma::server::callback {
+
+using namespace ma;
+
+// splits on ';' outside quotes, blanks are trimmed and the AT+ prefix is added when missing
+static std::vector<std::string> splitBatch(const std::string& commands) {
+    std::vector<std::string> result;
+    std::string current;
+    char quote = 0;
+
+    auto flush = [&]() {
+        size_t begin = current.find_first_not_of(' ');
+        size_t end   = current.find_last_not_of(' ');
+        if (begin != std::string::npos) {
+            std::string command = current.substr(begin, end - begin + 1);
+            if (command.size() < 3 || std::toupper(static_cast<unsigned char>(command[0])) != 'A' || std::toupper(static_cast<unsigned char>(command[1])) != 'T' ||
+                command[2] != '+') {
+                command.insert(0, "AT+");
+            }
+            result.push_back(std::move(command));
+        }
+        current.clear();
+    };
+
+    for (size_t i = 0; i < commands.size(); ++i) {
+        char c = commands[i];
+        if (quote) {
+            current += c;
+            if (c == '\\' && i + 1 < commands.size()) {
+                current += commands[++i];
+            } else if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == ';') {
+            flush();
+        } else {
+            if (c == '"' || c == '\'') {
+                quote = c;
+            }
+            current += c;
+        }
+    }
+    flush();
+
+    return result;
+}
+
+static TransportBatch* getBatchTransport(Transport& transport) {
+    auto it = static_resource->batch_transports.find(&transport);
+    if (it != static_resource->batch_transports.end()) {
+        return it->second.get();
+    }
+    auto created = std::make_unique<TransportBatch>(transport);
+    return static_resource->batch_transports.emplace(&transport, std::move(created)).first->second.get();
+}
+
+// called on the AT server thread, the commands are dispatched there and the tasks they submit run as one
+void batchCommands(const std::vector<std::string>& argv,
+                   Transport& transport,
+                   Encoder& encoder,
+                   const std::function<ma_err_t(std::string, Transport&)>& execute) {
+    // [argv] 0: cmd, 1: commands separated by ';'
+    ma_err_t ret = MA_OK;
+    std::vector<std::string> commands;
+    TransportBatch* batch = nullptr;
+    std::vector<task_t> tasks;
+    std::vector<size_t> ends;
+
+    if (argv.size() < 2) {
+        ret = MA_EINVAL;
+        goto err;
+    }
+
+    // no batch in a batch
+    if (&transport.underlying() != &transport) {
+        ret = MA_EBUSY;
+        goto err;
+    }
+
+    commands = splitBatch(argv[1]);
+    if (commands.empty() || commands.size() > MA_AT_BATCH_MAX_COMMANDS) {
+        ret = MA_EINVAL;
+        goto err;
+    }
+
+    batch = getBatchTransport(transport);
+    ret   = batch->acquire(commands.size());
+    if (ret != MA_OK) {
+        goto err;
+    }
+
+    // parse errors are recorded right away, the tasks of the commands are kept in order
+    batch->record(true);
+    static_resource->executor->capture(&tasks);
+    for (size_t i = 0; i < commands.size(); ++i) {
+        batch->select(i);
+        execute(commands[i], *batch);
+        ends.push_back(tasks.size());
+    }
+    static_resource->executor->capture(nullptr);
+    batch->record(false);
+
+    static_resource->executor->submit(
+        [cmd = argv[0], tasks = std::move(tasks), ends = std::move(ends), batch, &transport, &encoder](const std::atomic<bool>&) mutable {
+            ma_err_t ret    = MA_OK;
+            Storage* target = static_resource->device->getStorage();
+            std::unique_ptr<StorageBatch> storage;
+            if (target) {
+                storage = std::make_unique<StorageBatch>(*target);
+                static_resource->device->setStorageOverlay(storage.get());
+            }
+
+            batch->record(true);
+            size_t begin = 0;
+            for (size_t i = 0; i < ends.size(); ++i) {
+                batch->select(i);
+                for (size_t k = begin; k < ends[i]; ++k) {
+                    std::atomic<bool> reload(false);
+                    tasks[k](reload);
+                    if (reload.load()) {
+                        // asked to run again, queued after the batch like a direct command would be
+                        static_resource->executor->submit(std::move(tasks[k]));
+                    }
+                }
+                begin = ends[i];
+            }
+
+            if (storage) {
+                static_resource->device->setStorageOverlay(nullptr);
+                ret = storage->commit();
+            }
+            std::vector<std::string> replies = batch->release();
+
+            encoder.begin(MA_MSG_TYPE_RESP, ret, cmd);
+            encoder.write("count", static_cast<uint32_t>(ends.size()));
+            encoder.writeMessages("results", replies);
+            encoder.end();
+            encoder.send(transport);
+        });
+    return;
+
+err:
+    // the encoder belongs to the executor, the reply is sent from there
+    static_resource->executor->submit([cmd = argv[0], ret, &transport, &encoder](const std::atomic<bool>&) {
+        encoder.begin(MA_MSG_TYPE_RESP, ret, cmd);
+        encoder.end();
+        transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+    });
+}
+
+}  // namespace ma::server::callback
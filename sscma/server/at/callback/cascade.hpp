@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+#define MA_STORAGE_KEY_CASCADE_MODEL_ID "ma#cascade_model_id"
+
+namespace ma::server::callback {
+
+using namespace ma::model;
+
+// The second stage needs its own tensor arena, a shared static arena can't hold both models
+static Engine* getCascadeEngine() {
+#if defined(MA_USE_STATIC_TENSOR_ARENA) || !(defined(MA_USE_ENGINE_TFLITE) || defined(MA_USE_ENGINE_CVI) || defined(MA_USE_ENGINE_HAILO))
+    return nullptr;
+#else
+    static EngineDefault engine_cascade;
+    static ma_err_t ret = [] {
+#ifdef MA_CASCADE_ENGINE_ARENA_SIZE
+        return engine_cascade.init(MA_CASCADE_ENGINE_ARENA_SIZE);
+#else
+        return engine_cascade.init();
+#endif
+    }();
+    return ret == MA_OK ? &engine_cascade : nullptr;
+#endif
+}
+
+// The engine only holds the cascade model, it is loaded again only when the model changed
+static ma_err_t loadCascadeModel(Engine* engine, size_t model_id) {
+    static const void* loaded = nullptr;
+
+    const auto& models = static_resource->device->getModels();
+    auto it            = std::find_if(models.begin(), models.end(), [&](const ma_model_t& m) { return m.id == model_id; });
+    if (it == models.end() || it->addr == nullptr) {
+        return MA_ENOENT;
+    }
+    if (it->addr == loaded) {
+        return MA_OK;
+    }
+
+    loaded = nullptr;
+#if MA_USE_FILESYSTEM
+    ma_err_t ret = engine->load(static_cast<const char*>(it->addr));
+#else
+    ma_err_t ret = engine->load(it->addr, it->size);
+#endif
+    if (ret == MA_OK) {
+        loaded = it->addr;
+    }
+    return ret;
+}
+
+// Detector -> per box crop -> Classifier, the classifier runs on its own engine so both
+// models stay resident. Results are kept in the order of the boxes published, the detector
+// results or the tracks.
+class Cascade final {
+public:
+    [[nodiscard]] static std::unique_ptr<Cascade> create(size_t model_id, ma_err_t& ret) {
+        Engine* engine = getCascadeEngine();
+        if (engine == nullptr) {
+            ret = MA_ENOTSUP;
+            return nullptr;
+        }
+        ret = loadCascadeModel(engine, model_id);
+        if (ret != MA_OK) {
+            return nullptr;
+        }
+        if (!Classifier::isValid(engine)) {
+            ret = MA_EINVAL;
+            return nullptr;
+        }
+        return std::unique_ptr<Cascade>{new Cascade{engine}};
+    }
+
+    ~Cascade() {
+        delete _classifier;
+    }
+
+    ma_err_t run(Detector* detector, const ma_img_t& frame) {
+        return runBoxes(detector->getResults(), frame);
+    }
+
+    // center based boxes of the tracks and their ids, the class of a track is kept by its id so
+    // the frames the tracks are only predicted on publish the class of their last detection
+    ma_err_t run(const std::vector<ma_bbox_t>& boxes, const std::vector<int32_t>& ids, const ma_img_t& frame) {
+        _classifier->setConfig(MA_MODEL_CFG_OPT_THRESHOLD, static_resource->shared_threshold_score);
+
+        _runs += 1;
+        for (size_t i = 0; i < boxes.size() && i < ids.size(); ++i) {
+            _tracks[ids[i]] = {classify(boxes[i], frame), _runs};
+        }
+        // tracks neither classified nor published since the last run are gone
+        for (auto it = _tracks.begin(); it != _tracks.end();) {
+            if (it->second.seen + 1 < _runs) {
+                it = _tracks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        return MA_OK;
+    }
+
+    // the classes of the tracks published, in their order
+    ma_err_t serialize(Encoder& encoder, const std::vector<int32_t>& ids) {
+        _results.clear();
+        for (auto id : ids) {
+            auto it = _tracks.find(id);
+            if (it == _tracks.end()) {
+                _results.push_back({0.f, -1});
+                continue;
+            }
+            it->second.seen = _runs;
+            _results.push_back(it->second.cls);
+        }
+        return serialize(encoder);
+    }
+
+    ma_err_t serialize(Encoder& encoder) {
+        std::vector<ma_class_t> results(_results);
+        for (auto& result : results) {
+            result.score = static_cast<int>(std::round(result.score * 100));
+        }
+        return encoder.write("cascade", results);
+    }
+
+    const std::vector<ma_class_t>& getResults() const {
+        return _results;
+    }
+
+private:
+    struct Track {
+        ma_class_t cls;
+        uint32_t seen;
+    };
+
+    explicit Cascade(Engine* engine) : _classifier(new Classifier(engine)), _runs(0) {}
+
+    template <typename Boxes>
+    ma_err_t runBoxes(const Boxes& boxes, const ma_img_t& frame) {
+        _results.clear();
+
+        _classifier->setConfig(MA_MODEL_CFG_OPT_THRESHOLD, static_resource->shared_threshold_score);
+
+        for (const auto& box : boxes) {
+            _results.push_back(classify(box, frame));
+        }
+
+        return MA_OK;
+    }
+
+    ma_class_t classify(const ma_bbox_t& box, const ma_img_t& frame) {
+        ma_class_t cls{0.f, -1};
+
+        // boxes are normalized center based
+        int x = static_cast<int>(std::round((box.x - box.w / 2.f) * frame.width));
+        int y = static_cast<int>(std::round((box.y - box.h / 2.f) * frame.height));
+        int w = static_cast<int>(std::round(box.w * frame.width));
+        int h = static_cast<int>(std::round(box.h * frame.height));
+        x     = std::clamp(x, 0, frame.width - 1);
+        y     = std::clamp(y, 0, frame.height - 1);
+        w     = std::clamp(w, 1, frame.width - x);
+        h     = std::clamp(h, 1, frame.height - y);
+
+        size_t size = static_cast<size_t>(w) * h * 3;
+        if (_buffer.size() < size) {
+            _buffer.resize(size);
+        }
+        ma_img_t crop{};
+        crop.data = _buffer.data();
+
+        if (ma::cv::crop(&frame, &crop, x, y, w, h) == MA_OK && _classifier->run(&crop) == MA_OK) {
+            const auto& results = _classifier->getResults();
+            if (!results.empty()) {
+                cls = results.front();
+            }
+        }
+
+        return cls;
+    }
+
+    Classifier* _classifier;
+    std::vector<ma_class_t> _results;
+    std::unordered_map<int32_t, Track> _tracks;
+    uint32_t _runs;
+    std::vector<uint8_t> _buffer;
+};
+
+void configureCascade(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder, bool called_by_event = false) {
+    // [argv] 0: cmd, 1: classifier model id, 0 disables the cascade
+    ma_err_t ret    = MA_OK;
+    size_t model_id = 0;
+
+    if (argv.size() < 2) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    model_id = std::atoi(argv[1].c_str());
+    if (model_id != 0) {
+        // validate now so a bad id is reported here instead of on every invoke
+        auto cascade = Cascade::create(model_id, ret);
+        if (ret != MA_OK) [[unlikely]]
+            goto exit;
+    }
+
+    static_resource->cascade_model_id = model_id;
+    if (!called_by_event) {
+        MA_STORAGE_SET_POD(ret, static_resource->device->getStorage(), MA_STORAGE_KEY_CASCADE_MODEL_ID, static_resource->cascade_model_id);
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    encoder.write("cascade", static_cast<uint32_t>(static_resource->cascade_model_id));
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getCascade(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    encoder.write("cascade", static_cast<uint32_t>(static_resource->cascade_model_id));
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void initDefaultCascade(Transport* transport, Encoder& encoder) {
+    if (!transport) {
+        MA_LOGD(MA_TAG, "Transport not available");
+        return;
+    }
+
+    size_t model_id = 0;
+
+    MA_STORAGE_GET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_CASCADE_MODEL_ID, model_id, 0);
+    if (model_id == 0) {
+        return;
+    }
+
+    std::vector<std::string> args{"INIT@CASCADE", std::to_string(static_cast<int>(model_id))};
+    configureCascade(args, *transport, encoder, true);
+}
+
+}  // namespace ma::server::callback
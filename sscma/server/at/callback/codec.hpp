@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <strings.h>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+namespace ma::server::callback {
+
+using namespace ma;
+
+static const char* codecName(ma_codec_type_t type) {
+    switch (type) {
+        case MA_CODEC_CBOR:
+            return "CBOR";
+        default:
+            return "JSON";
+    }
+}
+
+static void writeCodec(Encoder& encoder, ma_codec_type_t type) {
+    encoder.write("type", static_cast<int32_t>(type));
+    encoder.write("name", std::string(codecName(type)));
+}
+
+void configureCodec(const std::vector<std::string>& argv,
+                    Transport& transport,
+                    Encoder& encoder,
+                    const std::function<ma_err_t(ma_codec_type_t)>& setCodec) {
+    // [argv] 0: cmd, 1: codec id (0: JSON, 1: CBOR) or name
+    ma_err_t ret         = MA_OK;
+    ma_codec_type_t type = encoder.getType();
+
+    if (argv.size() < 2) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    if (strcasecmp(argv[1].c_str(), "JSON") == 0) {
+        type = MA_CODEC_JSON;
+    } else if (strcasecmp(argv[1].c_str(), "CBOR") == 0) {
+        type = MA_CODEC_CBOR;
+    } else {
+        char* end = nullptr;
+        long id   = std::strtol(argv[1].c_str(), &end, 10);
+        if (end == argv[1].c_str() || *end != '\0' || id < 0 || id >= __MA_CODEC_END) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+        type = static_cast<ma_codec_type_t>(id);
+    }
+
+    ret = setCodec(type);
+    if (ret != MA_OK) {
+        type = encoder.getType();
+    }
+
+exit:
+    // replied with the codec the request arrived in, the new one applies from the next message
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeCodec(encoder, type);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getCodec(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeCodec(encoder, encoder.getType());
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+}  // namespace ma::server::callback
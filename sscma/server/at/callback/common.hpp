@@ -27,6 +27,15 @@ void get_device_status(const std::string& cmd, Transport& transport, Encoder& en
     encoder.begin(MA_MSG_TYPE_RESP, MA_OK, cmd);
     encoder.write("boot_count", static_cast<int32_t>(static_resource->device->bootCount()));
     encoder.write("is_ready", static_cast<int32_t>(static_resource->is_ready ? 1 : 0));
+    // events discarded by the outbound queues of all transports, see AT+EVENTQ
+    uint32_t dropped = 0, coalesced = 0;
+    const Guard guard(static_resource->event_queues_lock);
+    for (const auto& [transport, queue] : static_resource->event_queues) {
+        dropped += queue->dropped();
+        coalesced += queue->coalesced();
+    }
+    encoder.write("dropped", dropped);
+    encoder.write("coalesced", coalesced);
     encoder.end();
     transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
 }
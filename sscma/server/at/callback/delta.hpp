@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+namespace ma::server::callback {
+
+using namespace ma;
+
+static void writeDelta(Encoder& encoder) {
+    const auto& config = static_resource->delta_config;
+    encoder.write("enabled", static_cast<int32_t>(static_resource->delta_enabled));
+    encoder.write("iou", static_cast<int32_t>(std::round(config.iou * 100)));
+    encoder.write("score", static_cast<int32_t>(std::round(config.score * 100)));
+    encoder.write("count", config.count);
+    encoder.write("keepalive", config.keepalive_ms);
+}
+
+void configureDelta(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: enable (0/1), 2: IoU in percent, 3: score delta in percent, 4: count tolerance, 5: keepalive in ms
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 6) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    {
+        int enabled   = std::atoi(argv[1].c_str());
+        int iou       = std::atoi(argv[2].c_str());
+        int score     = std::atoi(argv[3].c_str());
+        int count     = std::atoi(argv[4].c_str());
+        int keepalive = std::atoi(argv[5].c_str());
+        if ((enabled != 0 && enabled != 1) || iou < 0 || iou > 100 || score < 0 || score > 100 || count < 0 || keepalive < 0) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+
+        auto& config                   = static_resource->delta_config;
+        static_resource->delta_enabled = enabled != 0;
+        config.iou                     = iou / 100.0;
+        config.score                   = score / 100.0;
+        config.count                   = static_cast<uint32_t>(count);
+        config.keepalive_ms            = static_cast<uint32_t>(keepalive);
+
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_DELTA_ENABLED, static_resource->delta_enabled);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_DELTA_IOU, config.iou);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_DELTA_SCORE, config.score);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_DELTA_COUNT, config.count);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_DELTA_KEEPALIVE, config.keepalive_ms);
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeDelta(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getDelta(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeDelta(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+}  // namespace ma::server::callback
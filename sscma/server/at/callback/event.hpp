@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/ma_core.h"
+#include "image.hpp"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+namespace ma::server::callback {
+
+using namespace ma;
+
+// keyed by the underlying transport, so the commands of a batch find the queue of their transport
+static inline EventQueue* findEventQueue(Transport& transport) {
+    auto it = static_resource->event_queues.find(&transport.underlying());
+    return it != static_resource->event_queues.end() ? it->second.get() : nullptr;
+}
+
+// the coalesce policy sends results only while the transport is behind, the image needn't be captured
+static inline bool eventImageSkipped(Transport& transport) {
+    EventQueue* queue = findEventQueue(transport);
+    return queue && queue->policy() == MA_EVENT_POLICY_COALESCE && queue->congested();
+}
+
+// the drop newest policy would discard the event, it needn't be built, the drop is accounted
+static inline bool eventDropped(Transport& transport) {
+    EventQueue* queue = findEventQueue(transport);
+    if (queue && queue->policy() == MA_EVENT_POLICY_DROP_NEWEST && queue->congested()) {
+        queue->drop();
+        return true;
+    }
+    return false;
+}
+
+// sends an event and the binary image frame following it (if any) as one message, through the queue of the transport when it has one
+static ma_err_t sendEvent(Transport& transport, const Encoder& encoder, const void* image = nullptr, size_t size = 0, uint32_t seq = 0) {
+    ma_iovec_t iov[MA_CODEC_MAX_IOV + 2];
+    uint8_t header[MA_IMAGE_FRAME_HEADER_SIZE];
+    size_t n = encoder.spans(iov, MA_CODEC_MAX_IOV);
+    if (image) {
+        writeImageFrameHeader(header, seq, size);
+        iov[n++] = {header, sizeof(header)};
+        iov[n++] = {image, size};
+    }
+
+    EventQueue* queue = findEventQueue(transport);
+    if (queue) {
+        return queue->push(iov, n);
+    }
+
+    // a single call, no reply of another thread gets between the event and its frame
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += iov[i].len;
+    }
+    return transport.sendv(iov, n) == total ? MA_OK : MA_EIO;
+}
+
+static void replyEventQueue(const std::string& cmd, ma_err_t ret, Transport& transport, Encoder& encoder) {
+    EventQueue* queue = findEventQueue(transport);
+
+    encoder.begin(MA_MSG_TYPE_RESP, ret, cmd);
+    // -1 when events are sent directly
+    encoder.write("policy", queue ? static_cast<int32_t>(queue->policy()) : -1);
+    encoder.write("depth", queue ? static_cast<uint32_t>(queue->depth()) : 0u);
+    encoder.write("pending", queue ? static_cast<uint32_t>(queue->pending()) : 0u);
+    encoder.write("sent", queue ? queue->sent() : 0u);
+    encoder.write("dropped", queue ? queue->dropped() : 0u);
+    encoder.write("coalesced", queue ? queue->coalesced() : 0u);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void configureEventQueue(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: policy, 2: depth
+    ma_err_t ret      = MA_OK;
+    int policy        = 0;
+    int depth         = 0;
+    EventQueue* queue = nullptr;
+
+    if (argv.size() < 3) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    policy = std::atoi(argv[1].c_str());
+    depth  = std::atoi(argv[2].c_str());
+    if (policy < 0 || policy >= __MA_EVENT_POLICY_END || depth <= 0 || depth > MA_EVENT_QUEUE_MAX_DEPTH) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    queue = findEventQueue(transport);
+    if (queue == nullptr) {
+        // kept once created, its thread may be sending at any time, never through a batch
+        Transport& target = transport.underlying();
+        auto created      = std::make_unique<EventQueue>(target, static_cast<ma_event_policy_t>(policy), static_cast<size_t>(depth));
+        const Guard guard(static_resource->event_queues_lock);
+        static_resource->event_queues.emplace(&target, std::move(created));
+    } else {
+        ret = queue->configure(static_cast<ma_event_policy_t>(policy), static_cast<size_t>(depth));
+    }
+
+exit:
+    replyEventQueue(argv[0], ret, transport, encoder);
+}
+
+void getEventQueue(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    replyEventQueue(argv[0], MA_OK, transport, encoder);
+}
+
+}  // namespace ma::server::callback
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+namespace ma::server::callback {
+
+using namespace ma;
+
+static void writeFilter(Encoder& encoder) {
+    const auto& config = static_resource->filter_config;
+    encoder.write("enabled", static_cast<int32_t>(static_resource->filter_enabled));
+    encoder.write("alpha", static_cast<int32_t>(std::round(config.alpha * 100)));
+    encoder.write("rise", config.rise);
+    encoder.write("fall", config.fall);
+    encoder.write("iou", static_cast<int32_t>(std::round(config.iou * 100)));
+}
+
+void configureFilter(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: enable (0/1), 2: weight of the new result in percent, 3: frames seen before published,
+    // 4: frames missed before dropped, 5: IoU in percent
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 6) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    {
+        int enabled = std::atoi(argv[1].c_str());
+        int alpha   = std::atoi(argv[2].c_str());
+        int rise    = std::atoi(argv[3].c_str());
+        int fall    = std::atoi(argv[4].c_str());
+        int iou     = std::atoi(argv[5].c_str());
+        if ((enabled != 0 && enabled != 1) || alpha < 1 || alpha > 100 || rise < 1 || rise > 100 || fall < 1 || fall > 100 || iou < 0 || iou > 100) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+
+        auto& config                    = static_resource->filter_config;
+        static_resource->filter_enabled = enabled != 0;
+        config.alpha                    = alpha / 100.0;
+        config.rise                     = static_cast<uint32_t>(rise);
+        config.fall                     = static_cast<uint32_t>(fall);
+        config.iou                      = iou / 100.0;
+
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_FILTER_ENABLED, static_resource->filter_enabled);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_FILTER_ALPHA, config.alpha);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_FILTER_RISE, config.rise);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_FILTER_FALL, config.fall);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_FILTER_IOU, config.iou);
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeFilter(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getFilter(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeFilter(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+}  // namespace ma::server::callback
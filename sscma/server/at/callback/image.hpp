@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+namespace ma::server::callback {
+
+using namespace ma;
+
+// binary image frame: magic, sequence number (u32 LE), payload length (u32 LE), then the JPEG as is
+constexpr uint8_t MA_IMAGE_FRAME_MAGIC[4]   = {0x1B, 'I', 'M', 'G'};
+constexpr size_t MA_IMAGE_FRAME_HEADER_SIZE = 12;
+
+typedef enum {
+    MA_IMAGE_MODE_INLINE = 0,  // base64 text in the event (or a byte string with a binary codec)
+    MA_IMAGE_MODE_FRAME  = 1,  // referenced by the event, sent as a binary frame right after it
+} ma_image_mode_t;
+
+static inline bool imageFrameEnabled(Transport& transport) {
+    return static_resource->image_frame_transports.count(&transport.underlying()) != 0;
+}
+
+// references the image of the frame that follows the event, returns its sequence number
+static inline uint32_t writeImageRef(Encoder& encoder, size_t size) {
+    uint32_t seq = ++static_resource->image_frame_seq;
+    encoder.write("image_seq", seq);
+    encoder.write("image_size", static_cast<uint32_t>(size));
+    return seq;
+}
+
+static inline void writeImageFrameHeader(uint8_t* header, uint32_t seq, size_t size) {
+    std::memcpy(header, MA_IMAGE_FRAME_MAGIC, sizeof(MA_IMAGE_FRAME_MAGIC));
+    for (size_t i = 0; i < 4; ++i) {
+        header[4 + i] = static_cast<uint8_t>(seq >> (i * 8));
+        header[8 + i] = static_cast<uint8_t>(static_cast<uint32_t>(size) >> (i * 8));
+    }
+}
+
+void configureImageMode(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: mode (0: inline, 1: binary frame)
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 2) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    switch (std::atoi(argv[1].c_str())) {
+        case MA_IMAGE_MODE_INLINE:
+            static_resource->image_frame_transports.erase(&transport.underlying());
+            break;
+        case MA_IMAGE_MODE_FRAME:
+            static_resource->image_frame_transports.insert(&transport.underlying());
+            break;
+        default:
+            ret = MA_EINVAL;
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    encoder.write("mode", static_cast<int32_t>(imageFrameEnabled(transport) ? MA_IMAGE_MODE_FRAME : MA_IMAGE_MODE_INLINE));
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getImageMode(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    encoder.write("mode", static_cast<int32_t>(imageFrameEnabled(transport) ? MA_IMAGE_MODE_FRAME : MA_IMAGE_MODE_INLINE));
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+}  // namespace ma::server::callback
@@ -9,11 +9,16 @@
 #include <vector>
 
 #include "core/ma_core.h"
-#include "core/utils/ma_base64.h"
+#include "cascade.hpp"
+#include "event.hpp"
+#include "image.hpp"
+#include "motion.hpp"
+#include "perf.hpp"
 #include "porting/ma_porting.h"
 #include "refactor_required.hpp"
 #include "resource.hpp"
 #include "server/at/codec/ma_codec.h"
+#include "track.hpp"
 
 extern "C" {
 
@@ -71,10 +76,15 @@ protected:
 
         _preprocess_hook_injected = false;
 
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-        _buffer      = reinterpret_cast<void*>(MA_SENSOR_ENCODE_STATIC_BUFFER_ADDR);
-        _buffer_size = 0;
-#endif
+        _image_frame   = nullptr;
+        _image_skipped = false;
+
+        _inferred = true;
+
+        _send_time = 0;
+
+        _delta_enabled = static_resource->delta_enabled;
+        _delta.setConfig(static_resource->delta_config);
 
         static_resource->is_sample = true;
     }
@@ -144,6 +154,25 @@ Err:
 #if MA_INVOKE_ENABLE_RUN_HOOK
         _algorithm->setRunDone([](void*) { ma_invoke_post_hook(nullptr); });
 #endif
+        if (isEverythingOk() && static_resource->motion_enabled) {
+            _motion = MotionGate::create();
+        }
+        if (isEverythingOk() && static_resource->track_enabled && _algorithm->getOutputType() == MA_OUTPUT_TYPE_BBOX) {
+            _tracking = Tracking::create();
+        }
+        if (isEverythingOk() && static_resource->filter_enabled &&
+            (_algorithm->getOutputType() == MA_OUTPUT_TYPE_BBOX || _algorithm->getOutputType() == MA_OUTPUT_TYPE_CLASS)) {
+            _filter.reset(new ma::utils::ResultFilter());
+            _filter->setConfig(static_resource->filter_config);
+        }
+        // filtered boxes are only matched to their classes through the track ids
+        if (isEverythingOk() && static_resource->cascade_model_id != 0 && _algorithm->getOutputType() == MA_OUTPUT_TYPE_BBOX) {
+            if (_filter && !_tracking) {
+                MA_LOGW(MA_TAG, "Cascade needs tracking with the filter, disabled");
+            } else {
+                _cascade = Cascade::create(static_resource->cascade_model_id, _ret);
+            }
+        }
         return isEverythingOk();
     }
 
@@ -163,27 +192,75 @@ Err:
 
 
     void eventReply(int width, int height) {
+        _send_time = 0;
+        // unchanged results are not published
+        if (isEverythingOk() && _delta_enabled && !updateResultDelta(_algorithm, _delta, ma_get_time_ms(), _filter.get())) {
+            returnImageFrame();
+            return;
+        }
+        if (isEverythingOk() && eventDropped(*_transport)) {
+            // the client didn't get these results, the next ones are published
+            _delta.reset();
+            returnImageFrame();
+            return;
+        }
 
         _encoder->begin(MA_MSG_TYPE_EVT, _ret, _cmd);
         _encoder->write("count", _times);
 
-        if (!_results_only) {
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-            reinterpret_cast<char*>(_buffer)[_buffer_size] = '\0';
-            _encoder->write("image", reinterpret_cast<const char*>(_buffer), _buffer_size);
-#else
-            _encoder->write("image", _buffer);
-#endif
+        uint32_t image_seq = 0;
+        bool frame_mode    = _image_frame && imageFrameEnabled(*_transport);
+        if (frame_mode) {
+            image_seq = writeImageRef(*_encoder, _image_frame->size);
+        } else if (_image_frame) {
+            _encoder->writeBinary("image", _image_frame->data, _image_frame->size);
+        } else if (!_results_only && !_image_skipped) {
+            _encoder->writeBinary("image", nullptr, 0);
         }
 
-        serializeAlgorithmOutput(_algorithm, _encoder, width, height);
-
-        auto perf = _algorithm->getPerf();
+        if (_tracking)
+            _tracking->serialize(*_encoder, width, height, _filter.get());
+        else
+            serializeAlgorithmOutput(_algorithm, _encoder, width, height, _filter.get());
+        if (_cascade && _tracking)
+            _cascade->serialize(*_encoder, _filter ? _filter->getIds() : _tracking->getIds());
+        else if (_cascade)
+            _cascade->serialize(*_encoder);
+        if (_motion)
+            _motion->serialize(*_encoder);
+
+        auto perf = _inferred ? _algorithm->getPerf() : ma_perf_t{};
         _encoder->write(perf);
+        if (static_resource->perf_stats_event)
+            _encoder->write(collectPerfStats());
         if (_event_hook)
             _event_hook(*_encoder);
         _encoder->end();
-        _transport->send(reinterpret_cast<const char*>(_encoder->data()), _encoder->size());
+        int64_t start_time = ma_get_time_us();
+        if (frame_mode) {
+            sendEvent(*_transport, *_encoder, _image_frame->data, _image_frame->size, image_seq);
+        } else {
+            sendEvent(*_transport, *_encoder);
+        }
+        _send_time = ma_get_time_us() - start_time;
+
+        returnImageFrame();
+    }
+
+    void updateFilter() {
+        if (_tracking)
+            _filter->update(_tracking->getBoxes(), _tracking->getIds());
+        else if (_algorithm->getOutputType() == MA_OUTPUT_TYPE_CLASS)
+            _filter->update(static_cast<Classifier*>(_algorithm)->getResults());
+        else
+            _filter->update(static_cast<Detector*>(_algorithm)->getResults());
+    }
+
+    void returnImageFrame() {
+        if (_image_frame) {
+            static_cast<Camera*>(_sensor)->returnFrame(*_image_frame);
+            _image_frame = nullptr;
+        }
     }
 
     void eventLoopCamera() {
@@ -197,55 +274,33 @@ Err:
         auto camera     = static_cast<Camera*>(_sensor);
         auto frame      = ma_img_t{};
         auto raw_frame  = ma_img_t{};
-        int buffer_size = 0;
+
+        int64_t start_time                = ma_get_time_us();
+        int64_t stage_time                = 0;
+        int64_t perf[MA_PERF_STAGE_COUNT] = {0};
+        bool predicted                    = false;
+
+        _inferred = true;
 
         _ret = camera->retrieveFrame(raw_frame, MA_PIXEL_FORMAT_AUTO);
         if (!isEverythingOk()) [[unlikely]]
             goto Err;
-        if (!_results_only) {
+        // results only while the event queue of the transport is coalescing
+        _image_skipped = eventImageSkipped(*_transport);
+        if (!_results_only && !_image_skipped) {
             _ret = camera->retrieveFrame(frame, MA_PIXEL_FORMAT_JPEG);
             if (!isEverythingOk()) [[unlikely]]
                 goto Err;
-
-            buffer_size = 4 * ((frame.size + 2) / 3);
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-            if (buffer_size > MA_SENSOR_ENCODE_STATIC_BUFFER_SIZE) {
-                MA_LOGE(MA_TAG, "buffer_size > MA_SENSOR_ENCODE_STATIC_BUFFER_SIZE");
-                goto Err;
-            }
-
-#else
-            if (buffer_size > _buffer.size()) {
-                _buffer.resize(buffer_size + 1);
-            }
-#endif
-
-            {
-                auto ret = ma::utils::base64_encode(reinterpret_cast<unsigned char*>(frame.data),
-                                                    frame.size,
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-                                                    reinterpret_cast<char*>(_buffer),
-#else
-                                                    reinterpret_cast<char*>(_buffer.data()),
-#endif
-                                                    &buffer_size);
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-                _buffer_size                             = buffer_size;
-                static_cast<char*>(_buffer)[buffer_size] = '\0';
-#else
-                _buffer[buffer_size] = '\0';
-#endif
-                if (ret != MA_OK) {
-                    MA_LOGE(MA_TAG, "base64_encode failed: %d", ret);
-                }
-            }
-
-            camera->returnFrame(frame);
+            // the image is read straight from the camera buffer while the event is built, returned there
+            _image_frame = &frame;
         }
+        perf[MA_PERF_STAGE_CAPTURE] = ma_get_time_us() - start_time;
         if (!_preprocess_hook_injected) {
             _preprocess_hook_injected = true;
-            _algorithm->setPreprocessDone([camera, &raw_frame](void*) {
-                camera->returnFrame(raw_frame);
+            _algorithm->setPreprocessDone([this, camera, &raw_frame](void*) {
+                // the cascade crops from the frame after detection, it is returned there
+                if (!_cascade)
+                    camera->returnFrame(raw_frame);
 #if MA_INVOKE_ENABLE_RUN_HOOK
                 ma_invoke_pre_hook(nullptr);
 #endif
@@ -264,23 +319,58 @@ Err:
         // update configs TODO: refactor
         _algorithm->setConfig(MA_MODEL_CFG_OPT_THRESHOLD, static_resource->shared_threshold_score);
         _algorithm->setConfig(MA_MODEL_CFG_OPT_NMS, static_resource->shared_threshold_nms);
-
-        _ret = setAlgorithmInput(_algorithm, raw_frame);
+        _algorithm->setConfig(MA_MODEL_CFG_OPT_TILE, static_cast<int>(static_resource->tile_enabled));
+        _algorithm->setConfig(MA_MODEL_CFG_OPT_TILE_OVERLAP, static_cast<double>(static_resource->tile_overlap));
+        _algorithm->setConfig(MA_MODEL_CFG_OPT_ROI, static_resource->roi_config.rois, static_cast<int>(static_resource->roi_config.count));
+
+        // a frame without motion keeps the results of the last one the model ran on
+        _inferred = !_motion || _motion->changed(raw_frame);
+        // between the frames the model runs on, the boxes are the predicted tracks
+        predicted = _inferred && _tracking && !_tracking->detect();
+        if (!_inferred || predicted) {
+            _inferred = false;
+            camera->returnFrame(raw_frame);
+            if (predicted)
+                _ret = _tracking->predict(raw_frame.width, raw_frame.height);
+        } else {
+            _ret = setAlgorithmInput(_algorithm, raw_frame);
+            if (_tracking && isEverythingOk())
+                _ret = _tracking->run(static_cast<Detector*>(_algorithm), raw_frame.width, raw_frame.height);
+            // the cascade classifies the boxes published, the tracks when tracking
+            if (_cascade) {
+                if (isEverythingOk())
+                    _ret = _tracking ? _cascade->run(_tracking->getBoxes(), _tracking->getIds(), raw_frame) : _cascade->run(static_cast<Detector*>(_algorithm), raw_frame);
+                camera->returnFrame(raw_frame);
+            }
+        }
         if (!isEverythingOk()) [[unlikely]]
             goto Err;
 
-        {
-            trigger_rules_mutex.lock();
-            auto trigger_copy = trigger_rules;
-            trigger_rules_mutex.unlock();
-            for (auto& rule : trigger_copy) {
-                if (rule) {
-                    (*rule.get())(_algorithm);
-                }
+        // the filter sees the results of the frames the model ran on and the predicted ones
+        if (_filter && (_inferred || predicted))
+            updateFilter();
+
+        // the rules see model results, or the filtered ones, they already ran on these
+        if (_inferred || (_filter && predicted)) {
+            auto table = std::atomic_load(&trigger_table);
+            if (table) {
+                updateTriggerTable(_algorithm, *table, _filter.get());
             }
         }
 
+        stage_time = ma_get_time_us();
         eventReply(raw_frame.width, raw_frame.height);
+        perf[MA_PERF_STAGE_SEND] = _send_time;
+        perf[MA_PERF_STAGE_SERIALIZE] += ma_get_time_us() - stage_time - _send_time;
+
+        if (_inferred) {
+            auto model_perf                 = _algorithm->getPerfUs();
+            perf[MA_PERF_STAGE_PREPROCESS]  = model_perf.preprocess;
+            perf[MA_PERF_STAGE_INFERENCE]   = model_perf.inference;
+            perf[MA_PERF_STAGE_POSTPROCESS] = model_perf.postprocess;
+        }
+        perf[MA_PERF_STAGE_TOTAL] = ma_get_time_us() - start_time;
+        recordPerfStats(perf);
 
         static_resource->executor->submit([_this = std::move(getptr())](const std::atomic<bool>&) { _this->eventLoopCamera(); });
         return;
@@ -304,6 +394,14 @@ private:
     Encoder* _encoder;
     ma_model_t _model;
     Model* _algorithm;
+    std::unique_ptr<Cascade> _cascade;
+    std::unique_ptr<Tracking> _tracking;
+    std::unique_ptr<MotionGate> _motion;
+    std::unique_ptr<ma::utils::ResultFilter> _filter;
+    // the model ran on the current frame
+    bool _inferred;
+    // us the last event took to hand to the transport
+    int64_t _send_time;
 
     size_t _task_id;
     int32_t _times;
@@ -312,18 +410,12 @@ private:
     bool _preprocess_hook_injected;
     std::function<void(Encoder&)> _event_hook;
 
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-#ifndef MA_SENSOR_ENCODE_STATIC_BUFFER_ADDR
-#error "MA_SENSOR_ENCODE_STATIC_BUFFER_ADDR is not defined"
-#endif
-#ifndef MA_SENSOR_ENCODE_STATIC_BUFFER_SIZE
-#error "MA_SENSOR_ENCODE_STATIC_BUFFER_SIZE is not defined"
-#endif
-    void* _buffer;
-    size_t _buffer_size;
-#else
-    std::string _buffer;
-#endif
+    // JPEG frame of the event being built, returned once the event is sent
+    ma_img_t* _image_frame;
+    bool _image_skipped;
+
+    bool _delta_enabled;
+    ma::utils::ResultDelta _delta;
 };
 
 }  // namespace ma::server::callback
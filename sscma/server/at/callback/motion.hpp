@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+#define MA_MOTION_WIDTH  64
+#define MA_MOTION_HEIGHT 48
+#define MA_MOTION_CELL   8
+
+namespace ma::server::callback {
+
+// Frame -> 64x48 grayscale -> difference to the last frame the model ran on, in front of
+// the model. The difference is taken per 8x8 cell so a small moving object is not averaged
+// away by a static rest of the scene, a frame changed when the mean absolute difference of a
+// cell reaches the threshold. The results kept on a frame without change are the ones of the
+// reference, so slow motion and objects leaving add up against it instead of fading into a
+// decaying background. The model runs anyway after an interval, which also follows lighting drift.
+class MotionGate final {
+public:
+    [[nodiscard]] static std::unique_ptr<MotionGate> create() {
+        return std::unique_ptr<MotionGate>{new MotionGate{}};
+    }
+
+    // true when the model has to run on the frame
+    bool changed(const ma_img_t& frame) {
+        ma_img_t gray{};
+        gray.width  = MA_MOTION_WIDTH;
+        gray.height = MA_MOTION_HEIGHT;
+        gray.size   = sizeof(_frame);
+        gray.format = MA_PIXEL_FORMAT_GRAYSCALE;
+        gray.rotate = MA_PIXEL_ROTATE_0;
+        gray.data   = _frame;
+
+        // formats the gate can't scale always run the model
+        if (ma::cv::convert(&frame, &gray) != MA_OK) [[unlikely]] {
+            _skipped = 0;
+            return true;
+        }
+
+        if (!_ready) {
+            std::memcpy(_reference, _frame, sizeof(_frame));
+            _ready   = true;
+            _skipped = 0;
+            return true;
+        }
+
+        bool motion    = false;
+        uint32_t limit = _threshold * MA_MOTION_CELL * MA_MOTION_CELL;
+        for (int y = 0; y < MA_MOTION_HEIGHT && !motion; y += MA_MOTION_CELL) {
+            for (int x = 0; x < MA_MOTION_WIDTH && !motion; x += MA_MOTION_CELL) {
+                uint32_t sum = 0;
+                for (int row = y; row < y + MA_MOTION_CELL; ++row) {
+                    size_t offset = row * MA_MOTION_WIDTH + x;
+                    sum += ma::cv::sad(_frame + offset, _reference + offset, MA_MOTION_CELL);
+                }
+                motion = sum >= limit;
+            }
+        }
+
+        if (motion || _skipped + 1 >= _interval) {
+            std::memcpy(_reference, _frame, sizeof(_frame));
+            _skipped = 0;
+            return true;
+        }
+        _skipped += 1;
+        return false;
+    }
+
+    ma_err_t serialize(Encoder& encoder) {
+        return encoder.write("motion", static_cast<int32_t>(_skipped == 0));
+    }
+
+private:
+    MotionGate() : _ready(false), _threshold(static_resource->motion_threshold), _interval(static_resource->motion_interval), _skipped(0) {}
+
+    uint8_t _frame[MA_MOTION_WIDTH * MA_MOTION_HEIGHT];
+    uint8_t _reference[MA_MOTION_WIDTH * MA_MOTION_HEIGHT];
+    bool _ready;
+    uint32_t _threshold;
+    int32_t _interval;
+    int32_t _skipped;
+};
+
+static void writeMotion(Encoder& encoder) {
+    encoder.write("enabled", static_cast<int32_t>(static_resource->motion_enabled));
+    encoder.write("threshold", static_resource->motion_threshold);
+    encoder.write("interval", static_resource->motion_interval);
+}
+
+void configureMotion(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: enable (0/1), 2: mean absolute difference of a cell in gray levels, 3: the model runs at least every N frames
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 4) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    {
+        int enabled   = std::atoi(argv[1].c_str());
+        int threshold = std::atoi(argv[2].c_str());
+        int interval  = std::atoi(argv[3].c_str());
+        if ((enabled != 0 && enabled != 1) || threshold < 1 || threshold > 255 || interval < 1) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+
+        static_resource->motion_enabled   = enabled != 0;
+        static_resource->motion_threshold = threshold;
+        static_resource->motion_interval  = interval;
+
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_MOTION_ENABLED, static_resource->motion_enabled);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_MOTION_THRESHOLD, static_resource->motion_threshold);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_MOTION_INTERVAL, static_resource->motion_interval);
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeMotion(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getMotion(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeMotion(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+}  // namespace ma::server::callback
@@ -209,23 +209,13 @@ exit:
 void getMqttCA(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
     ma_err_t ret = MA_OK;
 
-    std::string b64ca;
-    {
-        std::string ca_string;
-        MA_STORAGE_GET_STR(static_resource->device->getStorage(), MA_STORAGE_KEY_MQTT_SSL_CA, ca_string, "");
-        int b64ca_len = ca_string.size() * 4 / 3 + 4;
-        b64ca.resize(b64ca_len + 1);
-        ma::utils::base64_encode(reinterpret_cast<const unsigned char*>(ca_string.c_str()),
-                                 ca_string.size(),
-                                 reinterpret_cast<char*>(b64ca.data()),
-                                 &b64ca_len);
-        b64ca[b64ca_len] = '\0';
-    }
+    std::string ca_string;
+    MA_STORAGE_GET_STR(static_resource->device->getStorage(), MA_STORAGE_KEY_MQTT_SSL_CA, ca_string, "");
 
     encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
-    encoder.write("ca", b64ca);
+    encoder.writeBinary("ca", ca_string.data(), ca_string.size());
     encoder.end();
-    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+    encoder.send(transport);
 }
 
 }  // namespace ma::server::callback
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+namespace ma::server::callback {
+
+static ma_perf_stats_t collectPerfStats() {
+    ma_perf_stats_t stats;
+    for (size_t i = 0; i < MA_PERF_STAGE_COUNT; ++i) {
+        stats.stages[i] = static_resource->perf_stats[i].get();
+    }
+    return stats;
+}
+
+static void recordPerfStats(const int64_t (&us)[MA_PERF_STAGE_COUNT]) {
+    for (size_t i = 0; i < MA_PERF_STAGE_COUNT; ++i) {
+        static_resource->perf_stats[i].record(us[i]);
+    }
+}
+
+void configurePerfStats(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: attach stats to each invoke event {0,1}, the statistics are reset
+    ma_err_t ret = MA_OK;
+    if (argv.size() < 2) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    static_resource->perf_stats_event = std::atoi(argv[1].c_str()) != 0;
+    for (auto& stats : static_resource->perf_stats) {
+        stats.reset();
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    encoder.write("event", static_cast<int32_t>(static_resource->perf_stats_event));
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getPerfStats(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    ma_err_t ret = MA_OK;
+
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    encoder.write("event", static_cast<int32_t>(static_resource->perf_stats_event));
+    encoder.write(collectPerfStats());
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+}  // namespace ma::server::callback
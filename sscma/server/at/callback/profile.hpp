@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "refactor_required.hpp"
+#include "resource.hpp"
+#include "server/at/codec/ma_codec.h"
+
+namespace ma::server::callback {
+
+using namespace ma;
+
+// the task that enabled profiling on the shared engine, 0 for none, only that one disables it again
+static std::atomic<size_t> profiling_task_id{0};
+
+// runs the current model on N camera frames with per-operator profiling enabled,
+// then replies a single event holding the stage and operator timings in us, summed and divided once at the end
+class Profile final : public std::enable_shared_from_this<Profile> {
+public:
+    std::shared_ptr<Profile> getptr() {
+        return shared_from_this();
+    }
+
+    [[nodiscard]] static std::shared_ptr<Profile> create(const std::vector<std::string>& args, Transport& transport, Encoder& encoder, size_t task_id) {
+        return std::shared_ptr<Profile>{new Profile{args, transport, encoder, task_id}};
+    }
+
+    ~Profile() {
+        if (_algorithm != nullptr) {
+            ModelFactory::remove(_algorithm);
+            _algorithm = nullptr;
+        }
+
+        size_t task_id = _task_id;
+        if (profiling_task_id.compare_exchange_strong(task_id, 0)) {
+            static_resource->engine->setProfiling(false);
+        }
+    }
+
+    inline void run() {
+        prepare();
+    }
+
+protected:
+    Profile(const std::vector<std::string>& args, Transport& transport, Encoder& encoder, size_t task_id) {
+        MA_ASSERT(args.size() >= 2);
+        _cmd     = args[0];
+        _n_times = std::atoi(args[1].c_str());
+
+        _ret = _n_times > 0 ? MA_OK : MA_EINVAL;
+
+        _sensor    = nullptr;
+        _transport = &transport;
+        _encoder   = &encoder;
+        _model     = ma_model_t{};
+        _algorithm = nullptr;
+        _frame     = ma_img_t{};
+
+        _times = 0;
+
+        _task_id = task_id;
+    }
+
+private:
+    void prepare() {
+        if (!isEverythingOk()) [[unlikely]]
+            goto Err;
+
+        if (!prepareSensor()) [[unlikely]]
+            goto Err;
+
+        if (!prepareModel()) [[unlikely]]
+            goto Err;
+
+        if (!prepareAlgorithm()) [[unlikely]]
+            goto Err;
+
+        switch (_sensor->getType()) {
+            case Sensor::Type::kCamera:
+                directReply();
+                return static_resource->executor->submit([_this = std::move(getptr())](const std::atomic<bool>&) { _this->eventLoopCamera(); });
+            default:
+                _ret = MA_ENOTSUP;
+        }
+
+Err:
+        directReply();
+    }
+
+    bool prepareSensor() {
+        const auto& sensors = static_resource->device->getSensors();
+        auto it             = std::find_if(sensors.begin(), sensors.end(), [&](const Sensor* s) { return s->getID() == static_resource->current_sensor_id; });
+        if (it == sensors.end()) {
+            _ret = MA_ENOENT;
+            return false;
+        }
+        _sensor      = *it;
+        auto* camera = static_cast<Camera*>(_sensor);
+        _ret         = camera->startStream(Camera::StreamMode::kRefreshOnReturn);
+        return isEverythingOk();
+    }
+
+    bool prepareModel() {
+        const auto& models = static_resource->device->getModels();
+        auto it            = std::find_if(models.begin(), models.end(), [&](const ma_model_t& m) { return m.id == static_resource->current_model_id; });
+        if (it == models.end() || it->addr == nullptr) {
+            _ret = MA_ENOENT;
+        } else {
+            _model = *it;
+        }
+        return isEverythingOk();
+    }
+
+    bool prepareAlgorithm() {
+#if MA_USE_FILESYSTEM
+        _ret = static_resource->engine->load(static_cast<const char*>(_model.addr));
+#else
+        _ret = static_resource->engine->load(_model.addr, _model.size);
+#endif
+        if (!isEverythingOk()) {
+            return false;
+        }
+        _ret = static_resource->engine->setProfiling(true);
+        if (!isEverythingOk()) {
+            return false;
+        }
+        profiling_task_id.store(_task_id);
+        _algorithm = ModelFactory::create(static_resource->engine, static_resource->current_model_id);
+        if (_algorithm == nullptr) {
+            _ret = MA_ENOTSUP;
+        }
+        return isEverythingOk();
+    }
+
+    void directReply() {
+        _encoder->begin(MA_MSG_TYPE_RESP, _ret, _cmd);
+        if (_sensor != nullptr) {
+            _encoder->write(_sensor, _sensor->currentPresetIdx());
+        }
+        std::vector<ma_model_t> model{_model};
+        _encoder->write(model);
+        _encoder->end();
+        _transport->send(reinterpret_cast<const char*>(_encoder->data()), _encoder->size());
+    }
+
+    void eventReply() {
+        _encoder->begin(MA_MSG_TYPE_EVT, _ret, _cmd);
+        _encoder->write("count", _times);
+        if (isEverythingOk()) {
+            _encoder->write(_perf);
+        }
+        _encoder->end();
+        _transport->send(reinterpret_cast<const char*>(_encoder->data()), _encoder->size());
+    }
+
+    void accumulate() {
+        ma_perf_ext_t perf;
+        _ret = _algorithm->getPerf(perf);
+        if (!isEverythingOk()) [[unlikely]]
+            return;
+
+        if (_times == 1) {
+            _perf = std::move(perf);
+            return;
+        }
+
+        _perf.preprocess += perf.preprocess;
+        _perf.inference += perf.inference;
+        _perf.postprocess += perf.postprocess;
+        // the interpreter walks the same graph every run, so events line up by index
+        size_t n = std::min(_perf.ops.size(), perf.ops.size());
+        for (size_t i = 0; i < n; ++i) {
+            _perf.ops[i].time += perf.ops[i].time;
+        }
+    }
+
+    void average() {
+        _perf.preprocess /= _times;
+        _perf.inference /= _times;
+        _perf.postprocess /= _times;
+        for (auto& op : _perf.ops) {
+            op.time /= _times;
+        }
+    }
+
+    void eventLoopCamera() {
+        if (static_resource->current_task_id.load() != _task_id) [[unlikely]]
+            return;
+
+        auto camera = static_cast<Camera*>(_sensor);
+
+        _ret = camera->retrieveFrame(_frame, MA_PIXEL_FORMAT_AUTO);
+        if (!isEverythingOk()) [[unlikely]]
+            goto Err;
+
+        if (_times == 0) {
+            _algorithm->setPreprocessDone([this, camera](void*) { camera->returnFrame(_frame); });
+        }
+
+        _algorithm->setConfig(MA_MODEL_CFG_OPT_THRESHOLD, static_resource->shared_threshold_score);
+        _algorithm->setConfig(MA_MODEL_CFG_OPT_NMS, static_resource->shared_threshold_nms);
+
+        _ret = setAlgorithmInput(_algorithm, _frame);
+        if (!isEverythingOk()) [[unlikely]]
+            goto Err;
+
+        ++_times;
+        accumulate();
+        if (!isEverythingOk()) [[unlikely]]
+            goto Err;
+
+        if (_times < _n_times) {
+            static_resource->executor->submit([_this = std::move(getptr())](const std::atomic<bool>&) { _this->eventLoopCamera(); });
+            return;
+        }
+
+        average();
+
+Err:
+        eventReply();
+    }
+
+    inline bool isEverythingOk() const {
+        return _ret == MA_OK;
+    }
+
+private:
+    std::string _cmd;
+    int32_t _n_times;
+
+    ma_err_t _ret;
+
+    Sensor* _sensor;
+    Transport* _transport;
+    Encoder* _encoder;
+    ma_model_t _model;
+    Model* _algorithm;
+    ma_img_t _frame;
+
+    size_t _task_id;
+    int32_t _times;
+
+    ma_perf_ext_t _perf;
+};
+
+}  // namespace ma::server::callback
@@ -68,7 +68,8 @@ ma_err_t setAlgorithmInput(Model* algorithm, ma_img_t& img) {
     }
 }
 
-ma_err_t serializeAlgorithmOutput(Model* algorithm, Encoder* encoder, int width, int height) {
+// with a filter its published results are written instead of the ones of the algorithm
+ma_err_t serializeAlgorithmOutput(Model* algorithm, Encoder* encoder, int width, int height, const ma::utils::ResultFilter* filter = nullptr) {
 
     if (algorithm == nullptr || encoder == nullptr) {
         return MA_EINVAL;
@@ -76,6 +77,25 @@ ma_err_t serializeAlgorithmOutput(Model* algorithm, Encoder* encoder, int width,
 
     auto ret = MA_OK;
 
+    if (filter != nullptr && algorithm->getOutputType() == MA_OUTPUT_TYPE_CLASS) {
+        auto results = filter->getClasses();
+        for (auto& result : results) {
+            result.score = static_cast<int>(std::round(result.score * 100));
+        }
+        return encoder->write(results);
+    }
+    if (filter != nullptr && algorithm->getOutputType() == MA_OUTPUT_TYPE_BBOX) {
+        auto results = filter->getBoxes();
+        for (auto& result : results) {
+            result.x     = static_cast<int>(std::round(result.x * width));
+            result.y     = static_cast<int>(std::round(result.y * height));
+            result.w     = static_cast<int>(std::round(result.w * width));
+            result.h     = static_cast<int>(std::round(result.h * height));
+            result.score = static_cast<int>(std::round(result.score * 100));
+        }
+        return encoder->write(results);
+    }
+
     switch (algorithm->getType()) {
         case MA_MODEL_TYPE_PFLD: {
             auto results = static_cast<PointDetector*>(algorithm)->getResults();
@@ -154,160 +174,95 @@ ma_err_t serializeAlgorithmOutput(Model* algorithm, Encoder* encoder, int width,
     return ret;
 }
 
-struct TriggerRule {
-    static std::shared_ptr<TriggerRule> create(const std::string& rule_str) {
-        auto rule = std::make_shared<TriggerRule>();
-
-        std::vector<std::string> tokens;
-        for (size_t i = 0, j = 0; i < rule_str.size(); i = j + 1) {
-            j = rule_str.find(',', i);
-            if (j == std::string::npos) {
-                j = rule_str.size();
-            }
-            tokens.push_back(rule_str.substr(i, j - i));
-        }
-        if (tokens.size() < 6) {
-            return nullptr;
-        }
-
-        rule->class_id = std::atoi(tokens[0].c_str());
-        if (rule->class_id < 0) {
-            return nullptr;
-        }
+// true when the output of the algorithm is to be published, see ma::utils::ResultDelta
+bool updateResultDelta(Model* algorithm, ma::utils::ResultDelta& delta, int64_t now_ms, const ma::utils::ResultFilter* filter = nullptr) {
+    if (algorithm == nullptr) {
+        return true;
+    }
 
-        switch (std::atoi(tokens[1].c_str())) {
-            case 0:
-                rule->comp = std::greater<float>();
-                break;
-            case 1:
-                rule->comp = std::less<float>();
-                break;
-            case 2:
-                rule->comp = std::greater_equal<float>();
-                break;
-            case 3:
-                rule->comp = std::less_equal<float>();
-                break;
-            case 4:
-                rule->comp = std::equal_to<float>();
-                break;
-            case 5:
-                rule->comp = std::not_equal_to<float>();
-                break;
-            default:
-                return nullptr;
-        }
+    if (filter != nullptr && algorithm->getOutputType() == MA_OUTPUT_TYPE_CLASS) {
+        return delta.update(filter->getClasses(), now_ms);
+    }
+    if (filter != nullptr && algorithm->getOutputType() == MA_OUTPUT_TYPE_BBOX) {
+        return delta.update(filter->getBoxes(), now_ms);
+    }
 
-        rule->threshold = std::atoi(tokens[2].c_str()) / 100.0;
-        if (rule->threshold < 0 || rule->threshold > 1) {
-            return nullptr;
-        }
+    switch (algorithm->getType()) {
+        case MA_MODEL_TYPE_PFLD:
+            return delta.update(static_cast<PointDetector*>(algorithm)->getResults(), now_ms);
 
-        rule->gpio_pin = std::atoi(tokens[3].c_str());
-        if (!__ma_is_trigger_gpio(rule->gpio_pin)) {
-            return nullptr;
-        }
+        case MA_MODEL_TYPE_IMCLS:
+            return delta.update(static_cast<Classifier*>(algorithm)->getResults(), now_ms);
 
-        rule->default_level = std::atoi(tokens[4].c_str());
-        if (rule->default_level != 0 && rule->default_level != 1) {
-            return nullptr;
-        }
-        rule->trigger_level = std::atoi(tokens[5].c_str());
-        if (rule->trigger_level != 0 && rule->trigger_level != 1) {
-            return nullptr;
-        }
+        case MA_MODEL_TYPE_FOMO:
+        case MA_MODEL_TYPE_YOLOV5:
+        case MA_MODEL_TYPE_YOLOV8:
+        case MA_MODEL_TYPE_YOLO11:
+        case MA_MODEL_TYPE_NVIDIA_DET:
+        case MA_MODEL_TYPE_YOLO_WORLD:
+        case MA_MODEL_TYPE_RTMDET:
+            return delta.update(static_cast<Detector*>(algorithm)->getResults(), now_ms);
 
-        __ma_init_gpio_level(rule->gpio_pin, rule->default_level);
+        case MA_MODEL_TYPE_YOLOV8_POSE:
+        case MA_MODEL_TYPE_YOLO11_POSE:
+            return delta.update(static_cast<PoseDetector*>(algorithm)->getResults(), now_ms);
 
-        return rule;
+        default:
+            return true;
     }
+}
 
-    ~TriggerRule() = default;
-
-    void operator()(Model* algorithm) {
-        if (algorithm == nullptr) {
-            return;
-        }
+// drives the pins of the trigger rules with the results of the algorithm, or the ones of the filter
+void updateTriggerTable(Model* algorithm, ma::utils::TriggerTable& table, const ma::utils::ResultFilter* filter = nullptr) {
+    if (algorithm == nullptr) {
+        return;
+    }
 
-        bool fit = false;
+    const std::vector<ma::utils::TriggerTable::Output>* outputs = nullptr;
 
+    if (filter != nullptr && algorithm->getOutputType() == MA_OUTPUT_TYPE_CLASS) {
+        outputs = &table.update(filter->getClasses());
+    } else if (filter != nullptr && algorithm->getOutputType() == MA_OUTPUT_TYPE_BBOX) {
+        outputs = &table.update(filter->getBoxes());
+    } else {
         switch (algorithm->getType()) {
-            case MA_MODEL_TYPE_PFLD: {
-                const auto& results = static_cast<PointDetector*>(algorithm)->getResults();
-                for (const auto& result : results) {
-                    if (result.target == class_id && comp(result.score, threshold)) {
-                        fit = true;
-                        break;
-                    }
-                }
+            case MA_MODEL_TYPE_PFLD:
+                outputs = &table.update(static_cast<PointDetector*>(algorithm)->getResults());
                 break;
-            }
 
-            case MA_MODEL_TYPE_IMCLS: {
-                auto results = static_cast<Classifier*>(algorithm)->getResults();
-                for (auto& result : results) {
-                    if (result.target == class_id && comp(result.score, threshold)) {
-                        fit = true;
-                        break;
-                    }
-                }
+            case MA_MODEL_TYPE_IMCLS:
+                outputs = &table.update(static_cast<Classifier*>(algorithm)->getResults());
                 break;
-            }
 
             case MA_MODEL_TYPE_FOMO:
             case MA_MODEL_TYPE_YOLOV5:
             case MA_MODEL_TYPE_YOLOV8:
             case MA_MODEL_TYPE_YOLO11:
             case MA_MODEL_TYPE_NVIDIA_DET:
-            case MA_MODEL_TYPE_YOLO_WORLD: 
-            case MA_MODEL_TYPE_RTMDET: {
-                auto results = static_cast<Detector*>(algorithm)->getResults();
-                for (auto& result : results) {
-                    if (result.target == class_id && comp(result.score, threshold)) {
-                        fit = true;
-                        break;
-                    }
-                }
-
+            case MA_MODEL_TYPE_YOLO_WORLD:
+            case MA_MODEL_TYPE_RTMDET:
+                outputs = &table.update(static_cast<Detector*>(algorithm)->getResults());
                 break;
-            }
 
             case MA_MODEL_TYPE_YOLOV8_POSE:
-            case MA_MODEL_TYPE_YOLO11_POSE: {
-                auto results = static_cast<PoseDetector*>(algorithm)->getResults();
-                for (auto& result : results) {
-                    if (result.box.target == class_id && comp(result.box.score, threshold)) {
-                        fit = true;
-                        break;
-                    }
-                }
-
+            case MA_MODEL_TYPE_YOLO11_POSE:
+                outputs = &table.update(static_cast<PoseDetector*>(algorithm)->getResults());
                 break;
-            }
 
             default:
+                // no results, the rules fall back to their default levels
+                outputs = &table.update(std::forward_list<ma_class_t>{});
                 break;
         }
-
-        if (fit) {
-            __ma_set_gpio_level(gpio_pin, trigger_level);
-        } else {
-            __ma_set_gpio_level(gpio_pin, default_level);
-        }
     }
 
-    TriggerRule() = default;
-
-private:
-    int class_id;
-    std::function<bool(float, float)> comp;
-    float threshold;
-    int gpio_pin;
-    int default_level;
-    int trigger_level;
-};
+    for (const auto& output : *outputs) {
+        __ma_set_gpio_level(output.pin, output.level);
+    }
+}
 
-std::forward_list<std::shared_ptr<TriggerRule>> trigger_rules;
-ma::Mutex trigger_rules_mutex;
+// compiled trigger rules, replaced as a whole by AT+TRIGGER with std::atomic_store, INVOKE takes
+// the current table with std::atomic_load once a frame and keeps the old one alive while it runs
+std::shared_ptr<ma::utils::TriggerTable> trigger_table;
 
 }  // namespace ma
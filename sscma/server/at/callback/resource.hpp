@@ -6,7 +6,64 @@
 
 #include <ma_config_board.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "server/at/ma_event_queue.h"
+#include "server/at/ma_transport_batch.h"
+
+#ifndef MA_INVOKE_ROI_MAX
+#define MA_INVOKE_ROI_MAX 4
+#endif
+
+#ifndef MA_COUNTER_ZONE_MAX
+#define MA_COUNTER_ZONE_MAX 16
+#endif
+
+#ifndef MA_COUNTER_POINT_MAX
+#define MA_COUNTER_POINT_MAX 8
+#endif
+
+#define MA_COUNTER_NAME_SIZE 16
+
+// storage keys of the configs loaded here, the callbacks setting them use the same macros
+#define MA_STORAGE_KEY_TILE_ENABLED "ma#tile_enabled"
+#define MA_STORAGE_KEY_TILE_OVERLAP "ma#tile_overlap"
+
+#define MA_STORAGE_KEY_DELTA_ENABLED   "ma#delta_enabled"
+#define MA_STORAGE_KEY_DELTA_IOU       "ma#delta_iou"
+#define MA_STORAGE_KEY_DELTA_SCORE     "ma#delta_score"
+#define MA_STORAGE_KEY_DELTA_COUNT     "ma#delta_count"
+#define MA_STORAGE_KEY_DELTA_KEEPALIVE "ma#delta_keepalive"
+
+#define MA_STORAGE_KEY_FILTER_ENABLED "ma#filter_enabled"
+#define MA_STORAGE_KEY_FILTER_ALPHA   "ma#filter_alpha"
+#define MA_STORAGE_KEY_FILTER_RISE    "ma#filter_rise"
+#define MA_STORAGE_KEY_FILTER_FALL    "ma#filter_fall"
+#define MA_STORAGE_KEY_FILTER_IOU     "ma#filter_iou"
+
+#define MA_STORAGE_KEY_TRACK_ENABLED   "ma#track_enabled"
+#define MA_STORAGE_KEY_TRACK_BUFFER    "ma#track_buffer"
+#define MA_STORAGE_KEY_TRACK_THRESH    "ma#track_thresh"
+#define MA_STORAGE_KEY_TRACK_MATCH     "ma#track_match"
+#define MA_STORAGE_KEY_TRACK_INTERVAL  "ma#track_interval"
+#define MA_STORAGE_KEY_TRACK_UNCERTAIN "ma#track_uncertainty"
+#define MA_STORAGE_KEY_COUNTER_ENABLED "ma#counter_enabled"
+#define MA_STORAGE_KEY_COUNTER_X0      "ma#counter_x0"
+#define MA_STORAGE_KEY_COUNTER_Y0      "ma#counter_y0"
+#define MA_STORAGE_KEY_COUNTER_X1      "ma#counter_x1"
+#define MA_STORAGE_KEY_COUNTER_Y1      "ma#counter_y1"
+#define MA_STORAGE_KEY_COUNTER_ZONES   "ma#counter_zones"
+
+#define MA_STORAGE_KEY_MOTION_ENABLED   "ma#motion_enabled"
+#define MA_STORAGE_KEY_MOTION_THRESHOLD "ma#motion_threshold"
+#define MA_STORAGE_KEY_MOTION_INTERVAL  "ma#motion_interval"
+
+#define MA_STORAGE_KEY_ROI "ma#roi"
 
 using namespace ma;
 
@@ -39,7 +96,52 @@ struct StaticResource final {
 
         MA_STORAGE_GET_POD(device->getStorage(), "ma#score_threshold", shared_threshold_score, shared_threshold_score);
         MA_STORAGE_GET_POD(device->getStorage(), "ma#nms_threshold", shared_threshold_nms, shared_threshold_nms);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_TILE_ENABLED, tile_enabled, tile_enabled);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_TILE_OVERLAP, tile_overlap, tile_overlap);
         MA_STORAGE_GET_POD(device->getStorage(), "ma#default_transport_type", default_transport_type, default_transport_type);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_DELTA_ENABLED, delta_enabled, delta_enabled);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_DELTA_IOU, delta_config.iou, delta_config.iou);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_DELTA_SCORE, delta_config.score, delta_config.score);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_DELTA_COUNT, delta_config.count, delta_config.count);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_DELTA_KEEPALIVE, delta_config.keepalive_ms, delta_config.keepalive_ms);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_FILTER_ENABLED, filter_enabled, filter_enabled);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_FILTER_ALPHA, filter_config.alpha, filter_config.alpha);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_FILTER_RISE, filter_config.rise, filter_config.rise);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_FILTER_FALL, filter_config.fall, filter_config.fall);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_FILTER_IOU, filter_config.iou, filter_config.iou);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_TRACK_ENABLED, track_enabled, track_enabled);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_TRACK_BUFFER, track_buffer, track_buffer);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_TRACK_THRESH, track_thresh, track_thresh);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_TRACK_MATCH, track_match_thresh, track_match_thresh);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_TRACK_INTERVAL, track_interval, track_interval);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_TRACK_UNCERTAIN, track_uncertainty, track_uncertainty);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_MOTION_ENABLED, motion_enabled, motion_enabled);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_MOTION_THRESHOLD, motion_threshold, motion_threshold);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_MOTION_INTERVAL, motion_interval, motion_interval);
+        // the regions are kept as raw bytes, the storage macros only take scalars outside templates
+        if (device->getStorage() != nullptr) {
+            std::string buffer;
+            if (device->getStorage()->get(MA_STORAGE_KEY_ROI, buffer) == MA_OK && buffer.size() == sizeof(roi_config)) {
+                std::memcpy(&roi_config, buffer.data(), sizeof(roi_config));
+                roi_config.count = std::clamp<int32_t>(roi_config.count, 0, MA_INVOKE_ROI_MAX);
+            }
+        }
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_COUNTER_ENABLED, counter_enabled, counter_enabled);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_COUNTER_X0, counter_line.x0, counter_line.x0);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_COUNTER_Y0, counter_line.y0, counter_line.y0);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_COUNTER_X1, counter_line.x1, counter_line.x1);
+        MA_STORAGE_GET_POD(device->getStorage(), MA_STORAGE_KEY_COUNTER_Y1, counter_line.y1, counter_line.y1);
+        if (device->getStorage() != nullptr) {
+            std::string buffer;
+            if (device->getStorage()->get(MA_STORAGE_KEY_COUNTER_ZONES, buffer) == MA_OK && buffer.size() == sizeof(counter_zones)) {
+                std::memcpy(&counter_zones, buffer.data(), sizeof(counter_zones));
+                counter_zones.count = std::clamp<int32_t>(counter_zones.count, 0, MA_COUNTER_ZONE_MAX);
+                for (int32_t i = 0; i < counter_zones.count; i++) {
+                    counter_zones.zones[i].name[MA_COUNTER_NAME_SIZE - 1] = '\0';
+                    counter_zones.zones[i].points                         = std::clamp<int32_t>(counter_zones.zones[i].points, 2, MA_COUNTER_POINT_MAX);
+                }
+            }
+        }
     }
 
    public:
@@ -56,14 +158,84 @@ struct StaticResource final {
     size_t                   current_model_id = 0;
     size_t                   current_sensor_id = 0;
     size_t                   current_algorithm_id = 0;
+    size_t                   cascade_model_id = 0;
 
     float shared_threshold_score = 0.25;
     float shared_threshold_nms   = 0.45;
     int   default_transport_type = MA_TRANSPORT_CONSOLE;
 
+    // tiled detector inference for frames larger than the model input
+    bool  tile_enabled = false;
+    float tile_overlap = 0.2;
+
+    // INVOKE events only on a meaningful change of the results, plus a keepalive
+    bool                           delta_enabled = false;
+    ma::utils::ResultDelta::Config delta_config;
+
+    // temporal filter of the results of INVOKE, read when INVOKE starts
+    bool                            filter_enabled = false;
+    ma::utils::ResultFilter::Config filter_config;
+
+    // BYTETracker stage of INVOKE for detectors, the boxes get track ids, read when INVOKE starts
+    bool    track_enabled      = false;
+    int32_t track_buffer       = 30;
+    float   track_thresh       = 0.5;
+    float   track_match_thresh = 0.8;
+
+    // with tracking the model runs at least every track_interval frames, the tracks are predicted
+    // in between, earlier once a track is more uncertain than track_uncertainty (0 for never)
+    int32_t track_interval    = 1;
+    float   track_uncertainty = 0;
+
+    // regions of the frame INVOKE feeds to the model instead of the whole frame, none for the whole frame
+    struct {
+        int32_t  count                    = 0;
+        ma_roi_t rois[MA_INVOKE_ROI_MAX] = {};
+    } roi_config;
+
+    // INVOKE skips the model on frames without motion, read when INVOKE starts
+    bool    motion_enabled   = false;
+    int32_t motion_threshold = 10;
+    int32_t motion_interval  = 30;
+
+    // line crossing counts of the tracked boxes, the line is (x0, y0, x1, y1) in pixels
+    bool counter_enabled = false;
+    struct {
+        int16_t x0 = 0;
+        int16_t y0 = 0;
+        int16_t x1 = 0;
+        int16_t y1 = 0;
+    } counter_line;
+
+    // named lines (2 points) and polygons counted next to the line, set with AT+ZONE, points in pixels
+    struct {
+        int32_t count = 0;
+        struct {
+            char    name[MA_COUNTER_NAME_SIZE];
+            int32_t points;
+            int16_t xy[MA_COUNTER_POINT_MAX * 2];
+        } zones[MA_COUNTER_ZONE_MAX] = {};
+    } counter_zones;
+
     std::atomic<bool> is_ready  = false;
     std::atomic<bool> is_sample = false;
     std::atomic<bool> is_invoke = false;
+
+    // rolling latency statistics indexed by ma_perf_stage_t, only touched from executor tasks
+    ma::utils::PerfStats perf_stats[MA_PERF_STAGE_COUNT];
+    bool                 perf_stats_event = false;
+
+    // transports that get images as binary frames after the events, set with AT+IMAGE, not stored
+    std::unordered_set<const Transport*> image_frame_transports;
+    uint32_t                             image_frame_seq = 0;
+
+    // outbound event queues of the transports set with AT+EVENTQ, events are sent directly otherwise,
+    // changed by executor tasks with the lock held, other threads read them with it
+    std::unordered_map<const Transport*, std::unique_ptr<EventQueue>> event_queues;
+    Mutex                                                             event_queues_lock;
+
+    // transports the commands of AT+BATCH run on, one per transport, kept once created
+    std::unordered_map<const Transport*, std::unique_ptr<TransportBatch>> batch_transports;
 };
 
 #define static_resource StaticResource::getInstance()
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+namespace ma::server::callback {
+
+static void writeRoi(Encoder& encoder) {
+    // 4 values per region: x, y, w, h in percent of the frame
+    std::vector<int32_t> rois;
+    rois.reserve(static_resource->roi_config.count * 4);
+    for (int32_t i = 0; i < static_resource->roi_config.count; ++i) {
+        const auto& roi = static_resource->roi_config.rois[i];
+        rois.push_back(static_cast<int32_t>(roi.x * 100.f + 0.5f));
+        rois.push_back(static_cast<int32_t>(roi.y * 100.f + 0.5f));
+        rois.push_back(static_cast<int32_t>(roi.w * 100.f + 0.5f));
+        rois.push_back(static_cast<int32_t>(roi.h * 100.f + 0.5f));
+    }
+    encoder.write("rois", rois);
+}
+
+void configureRoi(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: regions as "x,y,w,h;x,y,w,h" in percent of the frame, empty for the whole frame
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 2) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    {
+        auto config        = static_resource->roi_config;
+        config.count       = 0;
+        const char* cursor = argv[1].c_str();
+        while (*cursor != '\0') {
+            if (config.count >= MA_INVOKE_ROI_MAX) {
+                ret = MA_EINVAL;
+                goto exit;
+            }
+            long values[4];
+            for (int i = 0; i < 4; ++i) {
+                char* end = nullptr;
+                values[i] = std::strtol(cursor, &end, 10);
+                char sep  = i < 3 ? ',' : ';';
+                if (end == cursor || (*end != sep && !(i == 3 && *end == '\0'))) {
+                    ret = MA_EINVAL;
+                    goto exit;
+                }
+                cursor = *end == '\0' ? end : end + 1;
+            }
+            long x = values[0], y = values[1], w = values[2], h = values[3];
+            if (x < 0 || y < 0 || w < 1 || h < 1 || x + w > 100 || y + h > 100) {
+                ret = MA_EINVAL;
+                goto exit;
+            }
+            config.rois[config.count++] = ma_roi_t{x / 100.f, y / 100.f, w / 100.f, h / 100.f};
+        }
+
+        static_resource->roi_config = config;
+
+        if (static_resource->device->getStorage() != nullptr) {
+            static_resource->device->getStorage()->set(MA_STORAGE_KEY_ROI, &static_resource->roi_config, sizeof(static_resource->roi_config));
+        }
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeRoi(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getRoi(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeRoi(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+}  // namespace ma::server::callback
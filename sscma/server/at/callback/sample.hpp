@@ -5,7 +5,8 @@
 #include <vector>
 
 #include "core/ma_core.h"
-#include "core/utils/ma_base64.h"
+#include "event.hpp"
+#include "image.hpp"
 #include "porting/ma_porting.h"
 #include "resource.hpp"
 #include "server/at/codec/ma_codec.h"
@@ -48,10 +49,7 @@ protected:
 
         _task_id = task_id;
 
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-        _buffer      = reinterpret_cast<void*>(MA_SENSOR_ENCODE_STATIC_BUFFER_ADDR);
-        _buffer_size = 0;
-#endif
+        _image_frame = nullptr;
 
         static_resource->is_sample = true;
     }
@@ -94,18 +92,39 @@ Err:
     }
 
     void eventReply() {
+        if (isEverythingOk() && eventDropped(*_transport)) {
+            returnImageFrame();
+            return;
+        }
+
         _encoder->begin(MA_MSG_TYPE_EVT, _ret, _cmd);
         _encoder->write("count", _times);
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-        reinterpret_cast<char*>(_buffer)[_buffer_size] = '\0';
-        _encoder->write("image", reinterpret_cast<char*>(_buffer), _buffer_size);
-#else
-        _encoder->write("image", _buffer);
-#endif
+        uint32_t image_seq = 0;
+        bool frame_mode    = _image_frame && imageFrameEnabled(*_transport);
+        if (frame_mode) {
+            image_seq = writeImageRef(*_encoder, _image_frame->size);
+        } else if (_image_frame) {
+            _encoder->writeBinary("image", _image_frame->data, _image_frame->size);
+        } else {
+            _encoder->writeBinary("image", nullptr, 0);
+        }
         if (_event_hook)
             _event_hook(*_encoder);
         _encoder->end();
-        _transport->send(reinterpret_cast<const char*>(_encoder->data()), _encoder->size());
+        if (frame_mode) {
+            sendEvent(*_transport, *_encoder, _image_frame->data, _image_frame->size, image_seq);
+        } else {
+            sendEvent(*_transport, *_encoder);
+        }
+
+        returnImageFrame();
+    }
+
+    void returnImageFrame() {
+        if (_image_frame) {
+            static_cast<Camera*>(_sensor)->returnFrame(*_image_frame);
+            _image_frame = nullptr;
+        }
     }
 
     void eventLoopCamera() {
@@ -116,45 +135,13 @@ Err:
 
         auto camera     = static_cast<Camera*>(_sensor);
         auto frame      = ma_img_t{};
-        int buffer_size = 0;
 
         _ret = camera->retrieveFrame(frame, MA_PIXEL_FORMAT_JPEG);
         if (!isEverythingOk()) [[unlikely]]
             goto Err;
 
-        buffer_size = 4 * ((frame.size + 2) / 3);
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-        if (buffer_size > MA_SENSOR_ENCODE_STATIC_BUFFER_SIZE) {
-            MA_LOGE(MA_TAG, "buffer_size > MA_SENSOR_ENCODE_STATIC_BUFFER_SIZE");
-            goto Err;
-        }
-        _buffer_size = buffer_size;
-#else
-        if (buffer_size > _buffer.size()) {
-            _buffer.resize(buffer_size + 1);
-        }
-#endif
-
-        {
-            auto ret = ma::utils::base64_encode(reinterpret_cast<unsigned char*>(frame.data),
-                                                frame.size,
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-                                                reinterpret_cast<char*>(_buffer),
-#else
-                                                reinterpret_cast<char*>(_buffer.data()),
-#endif
-                                                &buffer_size);
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-            static_cast<char*>(_buffer)[buffer_size] = '\0';
-#else
-            _buffer[buffer_size] = '\0';
-#endif
-            if (ret != MA_OK) {
-                MA_LOGE(MA_TAG, "base64_encode failed: %d", ret);
-            }
-        }
-
-        camera->returnFrame(frame);
+        // the image is read straight from the camera buffer while the event is built, returned there
+        _image_frame = &frame;
 
         if (!_event_hook) {
             _event_hook = [&frame](Encoder& encoder) {
@@ -193,18 +180,8 @@ private:
 
     std::function<void(Encoder&)> _event_hook;
 
-#if MA_SENSOR_ENCODE_USE_STATIC_BUFFER
-#ifndef MA_SENSOR_ENCODE_STATIC_BUFFER_ADDR
-#error "MA_SENSOR_ENCODE_STATIC_BUFFER_ADDR is not defined"
-#endif
-#ifndef MA_SENSOR_ENCODE_STATIC_BUFFER_SIZE
-#error "MA_SENSOR_ENCODE_STATIC_BUFFER_SIZE is not defined"
-#endif
-    void* _buffer;
-    size_t _buffer_size;
-#else
-    std::string _buffer;
-#endif
+    // JPEG frame of the event being built, returned once the event is sent
+    ma_img_t* _image_frame;
 };
 
 }  // namespace ma::server::callback
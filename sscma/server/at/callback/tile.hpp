@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+
+#include "core/ma_core.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+namespace ma::server::callback {
+
+using namespace ma;
+
+static void writeTile(Encoder& encoder) {
+    encoder.write("enabled", static_cast<int32_t>(static_resource->tile_enabled));
+    encoder.write("overlap", static_cast<int32_t>(std::round(static_resource->tile_overlap * 100)));
+}
+
+void configureTile(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: enable (0/1), 2: overlap in percent of the tile size (optional)
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 2) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    {
+        int enabled = std::atoi(argv[1].c_str());
+        int overlap = argv.size() > 2 ? std::atoi(argv[2].c_str()) : static_cast<int>(std::round(static_resource->tile_overlap * 100));
+        if ((enabled != 0 && enabled != 1) || overlap < 0 || overlap > 50) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+
+        static_resource->tile_enabled = enabled != 0;
+        static_resource->tile_overlap = overlap / 100.0;
+
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TILE_ENABLED, static_resource->tile_enabled);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TILE_OVERLAP, static_resource->tile_overlap);
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeTile(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getTile(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    MA_STORAGE_GET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TILE_ENABLED, static_resource->tile_enabled, static_resource->tile_enabled);
+    MA_STORAGE_GET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TILE_OVERLAP, static_resource->tile_overlap, static_resource->tile_overlap);
+
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeTile(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+}  // namespace ma::server::callback
@@ -0,0 +1,410 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/ma_core.h"
+#include "extension/bytetrack/byte_tracker.h"
+#include "extension/counter/counter.h"
+#include "porting/ma_porting.h"
+#include "resource.hpp"
+
+namespace ma::server::callback {
+
+using namespace ma::model;
+
+// Detector -> BYTETracker -> Counter, created per INVOKE so every task starts with fresh ids.
+// The tracker works on top-left based boxes, detector boxes are center based and converted
+// on the way in and out. Published boxes are the activated tracks, each followed by its id.
+//
+// With an interval above 1 the model only runs on some frames, on the others the tracks are
+// advanced by their Kalman filters alone. The model runs again once the interval is over,
+// when there are no tracks to predict, or when the predicted center of a track is more
+// uncertain than the configured share of its height.
+class Tracking final {
+public:
+    [[nodiscard]] static std::unique_ptr<Tracking> create() {
+        return std::unique_ptr<Tracking>{new Tracking{}};
+    }
+
+    ma_err_t run(Detector* detector, int width, int height) {
+        _boxes.clear();
+        for (const auto& box : detector->getResults()) {
+            ma_bbox_t tl = box;
+            tl.x -= box.w / 2.f;
+            tl.y -= box.h / 2.f;
+            _boxes.push_back(tl);
+        }
+
+        _tracker.inplace_update(_boxes, _ids);
+        _predicted = 0;
+
+        return publish(width, height);
+    }
+
+    // true when the model has to run for the next frame, the tracks are predicted otherwise
+    bool detect() const {
+        if (_interval <= 1 || _predicted + 1 >= _interval || _ids.empty()) {
+            return true;
+        }
+        return _uncertainty > 0.f && _tracker.uncertainty() >= _uncertainty;
+    }
+
+    ma_err_t predict(int width, int height) {
+        _tracker.inplace_predict(_boxes, _ids);
+        _predicted += 1;
+
+        return publish(width, height);
+    }
+
+    bool predicted() const {
+        return _predicted != 0;
+    }
+
+    // center based boxes of the activated tracks and their ids
+    const std::vector<ma_bbox_t>& getBoxes() const {
+        return _boxes;
+    }
+
+    const std::vector<int32_t>& getIds() const {
+        return _ids;
+    }
+
+    // with a filter its published boxes are written instead of the tracks
+    ma_err_t serialize(Encoder& encoder, int width, int height, const ma::utils::ResultFilter* filter = nullptr) {
+        if (filter) {
+            _scaled.assign(filter->getBoxes().begin(), filter->getBoxes().end());
+        } else {
+            _scaled.assign(_boxes.begin(), _boxes.end());
+        }
+        for (auto& result : _scaled) {
+            result.x     = static_cast<int>(std::round(result.x * width));
+            result.y     = static_cast<int>(std::round(result.y * height));
+            result.w     = static_cast<int>(std::round(result.w * width));
+            result.h     = static_cast<int>(std::round(result.h * height));
+            result.score = static_cast<int>(std::round(result.score * 100));
+        }
+        ma_err_t ret = encoder.write(_scaled, filter ? filter->getIds() : _ids);
+        if (ret == MA_OK && _interval > 1) {
+            ret = encoder.write("predicted", static_cast<int32_t>(predicted()));
+        }
+        if (ret == MA_OK && _counter) {
+            ret = encoder.write("counter", _counter->get());
+        }
+        if (ret == MA_OK && _counter && !_counter->getZones().empty()) {
+            ret = encoder.write("zones", _counter->getZones());
+        }
+        return ret;
+    }
+
+private:
+    ma_err_t publish(int width, int height) {
+        for (auto& box : _boxes) {
+            box.x += box.w / 2.f;
+            box.y += box.h / 2.f;
+        }
+
+        if (_counter) {
+            _xs.clear();
+            _ys.clear();
+            for (const auto& box : _boxes) {
+                _xs.push_back(static_cast<int16_t>(std::round(box.x * width)));
+                _ys.push_back(static_cast<int16_t>(std::round(box.y * height)));
+            }
+            _counter->update(_ids, _xs, _ys);
+        }
+
+        return MA_OK;
+    }
+
+    Tracking()
+        // a frame rate of 30 makes the tracker keep a lost track for exactly BUFFER frames, whatever the actual rate,
+        // a new track needs a score above THRESH + 0.1, capped so a THRESH above 90 can still start one
+        : _tracker(30,
+                   static_resource->track_buffer,
+                   static_resource->track_thresh,
+                   std::min(static_resource->track_thresh + 0.1f, 1.f),
+                   static_resource->track_match_thresh),
+          _interval(static_resource->track_interval),
+          _uncertainty(static_resource->track_uncertainty),
+          _predicted(0) {
+        if (static_resource->counter_enabled) {
+            const auto& line = static_resource->counter_line;
+            _counter.reset(new Counter(static_resource->track_buffer));
+            _counter->setSplitter({line.x0, line.y0, line.x1, line.y1});
+            const auto& config = static_resource->counter_zones;
+            for (int32_t i = 0; i < config.count; i++) {
+                const auto& zone = config.zones[i];
+                if (zone.points == 2) {
+                    _counter->addLine(zone.name, zone.xy[0], zone.xy[1], zone.xy[2], zone.xy[3]);
+                } else {
+                    _counter->addZone(zone.name, std::vector<int16_t>(zone.xy, zone.xy + zone.points * 2));
+                }
+            }
+        }
+    }
+
+    BYTETracker _tracker;
+    std::unique_ptr<Counter> _counter;
+    std::vector<ma_bbox_t> _boxes;
+    std::vector<ma_bbox_t> _scaled;
+    std::vector<int32_t> _ids;
+    std::vector<int16_t> _xs;
+    std::vector<int16_t> _ys;
+
+    int32_t _interval;
+    float _uncertainty;
+    int32_t _predicted;
+};
+
+static void writeTrack(Encoder& encoder) {
+    encoder.write("enabled", static_cast<int32_t>(static_resource->track_enabled));
+    encoder.write("buffer", static_resource->track_buffer);
+    encoder.write("thresh", static_cast<int32_t>(std::round(static_resource->track_thresh * 100)));
+    encoder.write("match", static_cast<int32_t>(std::round(static_resource->track_match_thresh * 100)));
+}
+
+void configureTrack(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: enable (0/1), 2: frames a lost track is kept, 3: track score threshold in percent, 4: match threshold in percent
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 5) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    {
+        int enabled = std::atoi(argv[1].c_str());
+        int buffer  = std::atoi(argv[2].c_str());
+        int thresh  = std::atoi(argv[3].c_str());
+        int match   = std::atoi(argv[4].c_str());
+        if ((enabled != 0 && enabled != 1) || buffer < 1 || thresh < 1 || thresh > 99 || match < 1 || match > 100) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+
+        static_resource->track_enabled      = enabled != 0;
+        static_resource->track_buffer       = buffer;
+        static_resource->track_thresh       = thresh / 100.0;
+        static_resource->track_match_thresh = match / 100.0;
+
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TRACK_ENABLED, static_resource->track_enabled);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TRACK_BUFFER, static_resource->track_buffer);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TRACK_THRESH, static_resource->track_thresh);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TRACK_MATCH, static_resource->track_match_thresh);
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeTrack(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getTrack(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeTrack(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+static void writeTrackSkip(Encoder& encoder) {
+    encoder.write("interval", static_resource->track_interval);
+    encoder.write("uncertainty", static_cast<int32_t>(std::round(static_resource->track_uncertainty * 100)));
+}
+
+void configureTrackSkip(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: the model runs at least every N frames, 2: predicted center deviation in percent of the box height that runs it earlier, 0 for never
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 3) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    {
+        int interval    = std::atoi(argv[1].c_str());
+        int uncertainty = std::atoi(argv[2].c_str());
+        if (interval < 1 || interval > 100 || uncertainty < 0 || uncertainty > 100) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+
+        static_resource->track_interval    = interval;
+        static_resource->track_uncertainty = uncertainty / 100.0;
+
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TRACK_INTERVAL, static_resource->track_interval);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_TRACK_UNCERTAIN, static_resource->track_uncertainty);
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeTrackSkip(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getTrackSkip(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeTrackSkip(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+static void writeCounter(Encoder& encoder) {
+    const auto& line = static_resource->counter_line;
+    encoder.write("enabled", static_cast<int32_t>(static_resource->counter_enabled));
+    encoder.write("line", std::vector<int32_t>{line.x0, line.y0, line.x1, line.y1});
+}
+
+void configureCounter(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: enable (0/1), 2-5: line x0, y0, x1, y1 in pixels
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 6) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    {
+        int enabled = std::atoi(argv[1].c_str());
+        int points[4];
+        for (int i = 0; i < 4; i++) {
+            points[i] = std::atoi(argv[i + 2].c_str());
+            if (points[i] < 0 || points[i] > INT16_MAX) {
+                ret = MA_EINVAL;
+                goto exit;
+            }
+        }
+        // a line of a single point only counts the zones
+        if (enabled != 0 && enabled != 1) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+
+        auto& line                       = static_resource->counter_line;
+        static_resource->counter_enabled = enabled != 0;
+        line.x0                          = static_cast<int16_t>(points[0]);
+        line.y0                          = static_cast<int16_t>(points[1]);
+        line.x1                          = static_cast<int16_t>(points[2]);
+        line.y1                          = static_cast<int16_t>(points[3]);
+
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_COUNTER_ENABLED, static_resource->counter_enabled);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_COUNTER_X0, line.x0);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_COUNTER_Y0, line.y0);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_COUNTER_X1, line.x1);
+        MA_STORAGE_NOSTA_SET_POD(static_resource->device->getStorage(), MA_STORAGE_KEY_COUNTER_Y1, line.y1);
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeCounter(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getCounter(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeCounter(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+static void writeZone(Encoder& encoder) {
+    const auto& config = static_resource->counter_zones;
+    for (int32_t i = 0; i < config.count; i++) {
+        const auto& zone = config.zones[i];
+        encoder.write(zone.name, std::vector<int32_t>(zone.xy, zone.xy + zone.points * 2));
+    }
+}
+
+void configureZone(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    // [argv] 0: cmd, 1: name, empty with empty points for all, 2: points as "x0,y0,x1,y1,..." in pixels, 2 for a line, 3 or more
+    // for a polygon, empty to remove the zone
+    ma_err_t ret = MA_OK;
+
+    if (argv.size() < 3) {
+        ret = MA_EINVAL;
+        goto exit;
+    }
+
+    {
+        const std::string& name = argv[1];
+        auto config             = static_resource->counter_zones;
+        if (name.size() >= MA_COUNTER_NAME_SIZE || (name.empty() && !argv[2].empty())) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+        for (char c : name) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-') {
+                ret = MA_EINVAL;
+                goto exit;
+            }
+        }
+
+        std::vector<int16_t> points;
+        const char* cursor = argv[2].c_str();
+        while (*cursor != '\0') {
+            char* end  = nullptr;
+            long value = std::strtol(cursor, &end, 10);
+            if (end == cursor || (*end != ',' && *end != '\0') || value < 0 || value > INT16_MAX) {
+                ret = MA_EINVAL;
+                goto exit;
+            }
+            points.push_back(static_cast<int16_t>(value));
+            cursor = *end == '\0' ? end : end + 1;
+        }
+        if (points.size() % 2 != 0 || points.size() > MA_COUNTER_POINT_MAX * 2 || points.size() == 2 ||
+            (points.size() == 4 && points[0] == points[2] && points[1] == points[3])) {
+            ret = MA_EINVAL;
+            goto exit;
+        }
+
+        // drop the zone of the name, or all, then append it again with the new points
+        int32_t kept = 0;
+        for (int32_t i = 0; i < config.count; i++) {
+            if (!name.empty() && name != config.zones[i].name) {
+                config.zones[kept++] = config.zones[i];
+            }
+        }
+        config.count = kept;
+        if (!points.empty()) {
+            if (config.count >= MA_COUNTER_ZONE_MAX) {
+                ret = MA_ENOMEM;
+                goto exit;
+            }
+            auto& zone = config.zones[config.count++];
+            std::memset(&zone, 0, sizeof(zone));
+            std::memcpy(zone.name, name.data(), name.size());
+            zone.points = static_cast<int32_t>(points.size() / 2);
+            std::copy(points.begin(), points.end(), zone.xy);
+        }
+
+        static_resource->counter_zones = config;
+
+        if (static_resource->device->getStorage() != nullptr) {
+            static_resource->device->getStorage()->set(MA_STORAGE_KEY_COUNTER_ZONES, &static_resource->counter_zones, sizeof(static_resource->counter_zones));
+        }
+    }
+
+exit:
+    encoder.begin(MA_MSG_TYPE_RESP, ret, argv[0]);
+    writeZone(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+void getZone(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder) {
+    encoder.begin(MA_MSG_TYPE_RESP, MA_OK, argv[0]);
+    writeZone(encoder);
+    encoder.end();
+    transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
+}
+
+}  // namespace ma::server::callback
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "core/ma_core.h"
@@ -14,38 +15,38 @@ namespace ma::server::callback {
 
 static bool parseAndSetTriggerRules(const std::string& trigger) {
 
-    std::forward_list<std::shared_ptr<TriggerRule>> rules;
-
-    for (size_t i = 0, j = 0; i < trigger.size(); i = j + 1) {
-        j = trigger.find('|', i);
-        if (j == std::string::npos) {
-            j = trigger.size();
-        }
-        auto token = trigger.substr(i, j - i);
-        auto ptr   = TriggerRule::create(token);
-        if (ptr) {
-            rules.push_front(std::move(ptr));
-        } else {
+    auto table = std::make_shared<ma::utils::TriggerTable>();
+    if (!table->compile(trigger)) {
+        return false;
+    }
+    for (const auto& rule : table->getRules()) {
+        if (!__ma_is_trigger_gpio(rule.pin)) {
             return false;
         }
     }
+    for (const auto& rule : table->getRules()) {
+        __ma_init_gpio_level(rule.pin, rule.default_level);
+    }
 
-    trigger_rules_mutex.lock();
-    trigger_rules = std::move(rules);
-    trigger_rules_mutex.unlock();
+    std::atomic_store(&trigger_table, std::move(table));
 
     return true;
 }
 
 void configureTrigger(const std::vector<std::string>& argv, Transport& transport, Encoder& encoder, bool called_by_event = false) {
     // [argv] 0: cmd, 1: trigger string
-    // [trigger string] 0: class id, 1: condition, 2: threshold, 3: gpio pin, 4: default level, 5: trigger level | ...
+    // [trigger string] 0: class id, 1: condition, 2: threshold, 3: gpio pin, 4: default level, 5: trigger level,
+    //                  optional 6: kind, 7: debounce, optional 8-11: zone x, y, w, h | ...
+    // [class id] -1 for all classes
     // [condition] 0: >, 1: <, 2: >=, 3: <=, 4: ==, 5: !=
-    // [threshold] [0-100]: integer
+    // [threshold] [0-100]: integer, a count for kind 1
     // [gpio pin] {1,2,3,21,41,42}: integer
     // [default level] {0,1}: integer
     // [trigger level] {0,1}: integer
-    // example: "0,1,50,1,0,1|1,1,50,2,0,1"
+    // [kind] 0: score of a result, 1: number of results, 2: area of a result in percent of the frame
+    // [debounce] frames the condition holds or fails in a row before the level changes
+    // [zone] [0-100]: integer, only results centered in it are seen
+    // example: "0,1,50,1,0,1|1,1,50,2,0,1|0,2,3,3,0,1,1,5,0,50,100,50"
 
     ma_err_t ret = MA_OK;
     if (argv.size() < 2) {
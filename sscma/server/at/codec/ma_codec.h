@@ -2,6 +2,8 @@
 #define _MA_CODEC_H_
 
 #include "ma_codec_base.h"
+#include "ma_codec_cbor.h"
 #include "ma_codec_json.h"
+#include "ma_codec_json_stream.h"
 
 #endif  // _MA_PROTOCOL_H_
\ No newline at end of file
@@ -8,9 +8,13 @@
 
 #include "core/ma_common.h"
 #include "porting/ma_sensor.h"
+#include "porting/ma_transport.h"
 
 namespace ma {
 
+// parts a message is split into at most, see Encoder::spans()
+constexpr size_t MA_CODEC_MAX_IOV = 12;
+
 class Encoder {
 public:
     Encoder()          = default;
@@ -24,6 +28,13 @@ public:
      */
     virtual operator bool() const = 0;
 
+    /*!
+     * @brief Wire format produced by the encoder.
+     *
+     * @return codec type
+     */
+    virtual ma_codec_type_t getType() const = 0;
+
     /*!
      * @brief Encoder type for begin.
      *
@@ -100,6 +111,32 @@ public:
      */
     virtual const size_t size() const = 0;
 
+    /*!
+     * @brief Encoder type for get the message as parts, without joining them.
+     *
+     * @param[out] iov parts of the message, in order
+     * @param[in] iovcnt capacity of iov, MA_CODEC_MAX_IOV is always enough
+     * @retval number of parts
+     */
+    virtual size_t spans(ma_iovec_t* iov, size_t iovcnt) const {
+        if (iovcnt == 0) {
+            return 0;
+        }
+        iov[0] = {data(), size()};
+        return 1;
+    }
+
+    /*!
+     * @brief Send the message through a transport with a single scatter-gather call.
+     *
+     * @param[in] transport
+     * @retval number of bytes sent
+     */
+    size_t send(Transport& transport) const {
+        ma_iovec_t iov[MA_CODEC_MAX_IOV];
+        return transport.sendv(iov, spans(iov, MA_CODEC_MAX_IOV));
+    }
+
     /*!
      * @brief Encoder type for remove.
      *
@@ -224,6 +261,22 @@ public:
      */
     virtual ma_err_t write(ma_perf_t value) = 0;
 
+    /*!
+     * @brief Encoder type for write ma_perf_ext_t, stage timings with per-operator timings.
+     *
+     * @param[in] value ma_perf_ext_t typed value to write.
+     * @retval MA_OK on success
+     */
+    virtual ma_err_t write(const ma_perf_ext_t& value) = 0;
+
+    /*!
+     * @brief Encoder type for write ma_perf_stats_t, rolling latency statistics per stage.
+     *
+     * @param[in] value ma_perf_stats_t typed value to write.
+     * @retval MA_OK on success
+     */
+    virtual ma_err_t write(const ma_perf_stats_t& value) = 0;
+
     /*!
      * @brief Encoder type for write std::forward_list<ma_class_t> value.
      *
@@ -232,6 +285,15 @@ public:
      */
     virtual ma_err_t write(const std::forward_list<ma_class_t>& value) = 0;
 
+    /*!
+     * @brief Encoder type for write std::vector<ma_class_t> value under a given key.
+     *
+     * @param[in] key
+     * @param[in] value std::vector<ma_class_t> typed value to write.
+     * @retval MA_OK on success
+     */
+    virtual ma_err_t write(const std::string& key, const std::vector<ma_class_t>& value) = 0;
+
     /*!
      * @brief Encoder type for write std::vector<ma_point_t> value.
      *
@@ -248,6 +310,33 @@ public:
      */
     virtual ma_err_t write(const std::forward_list<ma_bbox_t>& value) = 0;
 
+    /*!
+     * @brief Encoder type for write tracked std::vector<ma_bbox_t> value, each box is followed by its track id.
+     *
+     * @param[in] value std::vector<ma_bbox_t> typed value to write.
+     * @param[in] ids track id of each box, -1 for a box without one.
+     * @retval MA_OK on success
+     */
+    virtual ma_err_t write(const std::vector<ma_bbox_t>& value, const std::vector<int32_t>& ids) = 0;
+
+    /*!
+     * @brief Encoder type for write std::vector<int32_t> value under a given key.
+     *
+     * @param[in] key
+     * @param[in] value std::vector<int32_t> typed value to write.
+     * @retval MA_OK on success
+     */
+    virtual ma_err_t write(const std::string& key, const std::vector<int32_t>& value) = 0;
+
+    /*!
+     * @brief Encoder type for write std::vector<ma_zone_t> value under a given key, each zone as a map of its counts.
+     *
+     * @param[in] key
+     * @param[in] value std::vector<ma_zone_t> typed value to write.
+     * @retval MA_OK on success
+     */
+    virtual ma_err_t write(const std::string& key, const std::vector<ma_zone_t>& value) = 0;
+
     /*!
      * @brief Encoder type for write std::forward_list<ma_keypoint3f_t> value.
      *
@@ -270,6 +359,27 @@ public:
 
     virtual ma_err_t write(const std::string& key, const char* buffer, size_t size) = 0;
 
+    /*!
+     * @brief Encoder type for write binary data, text codecs encode it in base64 in place,
+     * binary codecs may reference it as a span instead of copying it.
+     *
+     * @param[in] key
+     * @param[in] data binary data to write, must stay valid until the message is sent
+     * @param[in] size size of the data in bytes
+     * @retval MA_OK on success
+     */
+    virtual ma_err_t writeBinary(const std::string& key, const void* data, size_t size) = 0;
+
+    /*!
+     * @brief Encoder type for write messages made by an encoder of the same codec as an array,
+     * their framing is dropped and anything that isn't a message is written as null.
+     *
+     * @param[in] key
+     * @param[in] messages complete messages, e.g. the replies of the commands of a batch
+     * @retval MA_OK on success
+     */
+    virtual ma_err_t writeMessages(const std::string& key, const std::vector<std::string>& messages) = 0;
+
 
     virtual ma_err_t write(const in4_info_t& value) = 0;
     virtual ma_err_t write(const in6_info_t& value) = 0;
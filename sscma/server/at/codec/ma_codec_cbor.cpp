@@ -0,0 +1,1414 @@
+#include "ma_codec_cbor.h"
+
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#include <strings.h>
+
+namespace ma {
+
+static const char* TAG = "ma::codec::CBOR";
+
+namespace {
+
+enum : uint8_t {
+    CBOR_UINT   = 0,
+    CBOR_NEGINT = 1,
+    CBOR_BYTES  = 2,
+    CBOR_TEXT   = 3,
+    CBOR_ARRAY  = 4,
+    CBOR_MAP    = 5,
+    CBOR_TAG    = 6,
+    CBOR_SIMPLE = 7,
+};
+
+constexpr uint8_t CBOR_FALSE            = 0xF4;
+constexpr uint8_t CBOR_TRUE             = 0xF5;
+constexpr uint8_t CBOR_NULL             = 0xF6;
+constexpr uint8_t CBOR_FLOAT32          = 0xFA;
+constexpr uint8_t CBOR_FLOAT64          = 0xFB;
+constexpr uint8_t CBOR_INDEFINITE_MAP   = 0xBF;
+constexpr uint8_t CBOR_BREAK            = 0xFF;
+constexpr uint8_t CBOR_INFO_INDEFINITE  = 31;
+constexpr size_t CBOR_MAX_NESTING_DEPTH = 16;
+
+struct Head {
+    uint8_t major;
+    uint8_t info;
+    uint64_t value;
+};
+
+class Cursor {
+public:
+    Cursor(const uint8_t* data, size_t size, size_t pos = 0) : data_(data), size_(size), pos_(pos) {}
+
+    size_t pos() const {
+        return pos_;
+    }
+
+    bool peekBreak() const {
+        return pos_ < size_ && data_[pos_] == CBOR_BREAK;
+    }
+
+    bool head(Head& head) {
+        if (pos_ >= size_) {
+            return false;
+        }
+        uint8_t byte = data_[pos_++];
+        head.major   = byte >> 5;
+        head.info    = byte & 0x1f;
+        head.value   = head.info;
+        if (head.info < 24 || head.info == CBOR_INFO_INDEFINITE) {
+            return true;
+        }
+        if (head.info > 27) {
+            return false;
+        }
+        size_t n = size_t{1} << (head.info - 24);
+        if (size_ - pos_ < n) {
+            return false;
+        }
+        head.value = 0;
+        for (size_t i = 0; i < n; ++i) {
+            head.value = (head.value << 8) | data_[pos_++];
+        }
+        return true;
+    }
+
+    const uint8_t* take(uint64_t size) {
+        if (size_ - pos_ < size) {
+            return nullptr;
+        }
+        const uint8_t* ptr = data_ + pos_;
+        pos_ += size;
+        return ptr;
+    }
+
+    bool skip(size_t depth = 0) {
+        Head h;
+        if (depth > CBOR_MAX_NESTING_DEPTH || !head(h)) {
+            return false;
+        }
+        bool indefinite = h.info == CBOR_INFO_INDEFINITE;
+        switch (h.major) {
+            case CBOR_UINT:
+            case CBOR_NEGINT:
+                return !indefinite;
+            case CBOR_BYTES:
+            case CBOR_TEXT:
+                if (!indefinite) {
+                    return take(h.value) != nullptr;
+                }
+                while (!peekBreak()) {
+                    if (!skip(depth + 1)) {
+                        return false;
+                    }
+                }
+                return take(1) != nullptr;
+            case CBOR_ARRAY:
+            case CBOR_MAP: {
+                if (indefinite) {
+                    while (!peekBreak()) {
+                        if (!skip(depth + 1)) {
+                            return false;
+                        }
+                    }
+                    return take(1) != nullptr;
+                }
+                uint64_t n = h.major == CBOR_MAP ? h.value * 2 : h.value;
+                for (uint64_t i = 0; i < n; ++i) {
+                    if (!skip(depth + 1)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            case CBOR_TAG:
+                return !indefinite && skip(depth + 1);
+            default:
+                // simple values and floats, their payload has been consumed by head()
+                return !indefinite;
+        }
+    }
+
+    bool number(double& value) {
+        Head h;
+        if (!head(h)) {
+            return false;
+        }
+        switch (h.major) {
+            case CBOR_UINT:
+                value = static_cast<double>(h.value);
+                return true;
+            case CBOR_NEGINT:
+                value = -1.0 - static_cast<double>(h.value);
+                return true;
+            case CBOR_SIMPLE:
+                if (h.info == 25) {
+                    value = halfToDouble(static_cast<uint16_t>(h.value));
+                    return true;
+                }
+                if (h.info == 26) {
+                    uint32_t bits = static_cast<uint32_t>(h.value);
+                    float f;
+                    std::memcpy(&f, &bits, sizeof(f));
+                    value = f;
+                    return true;
+                }
+                if (h.info == 27) {
+                    std::memcpy(&value, &h.value, sizeof(value));
+                    return true;
+                }
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    bool text(std::string& value) {
+        Head h;
+        if (!head(h) || (h.major != CBOR_TEXT && h.major != CBOR_BYTES) || h.info == CBOR_INFO_INDEFINITE) {
+            return false;
+        }
+        const uint8_t* ptr = take(h.value);
+        if (ptr == nullptr) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(ptr), h.value);
+        return true;
+    }
+
+private:
+    static double halfToDouble(uint16_t half) {
+        int exp      = (half >> 10) & 0x1f;
+        int mant     = half & 0x3ff;
+        double value = exp == 0 ? std::ldexp(mant, -24) : exp != 31 ? std::ldexp(mant + 1024, exp - 25) : mant == 0 ? INFINITY : NAN;
+        return half & 0x8000 ? -value : value;
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+}  // namespace
+
+EncoderCBOR::EncoderCBOR() : m_begun(false), m_map(false), m_depth(0), m_member_count(0), m_extern_count(0), m_extern_size(0) {}
+
+EncoderCBOR::~EncoderCBOR() = default;
+
+EncoderCBOR::operator bool() const {
+    return m_begun;
+}
+
+ma_codec_type_t EncoderCBOR::getType() const {
+    return MA_CODEC_CBOR;
+}
+
+void EncoderCBOR::putHead(uint8_t major, uint64_t value) {
+    uint8_t head[9];
+    size_t n = 0;
+    major <<= 5;
+    if (value < 24) {
+        head[n++] = major | static_cast<uint8_t>(value);
+    } else if (value <= 0xff) {
+        head[n++] = major | 24;
+        head[n++] = static_cast<uint8_t>(value);
+    } else if (value <= 0xffff) {
+        head[n++] = major | 25;
+        head[n++] = static_cast<uint8_t>(value >> 8);
+        head[n++] = static_cast<uint8_t>(value);
+    } else if (value <= 0xffffffff) {
+        head[n++] = major | 26;
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            head[n++] = static_cast<uint8_t>(value >> shift);
+        }
+    } else {
+        head[n++] = major | 27;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            head[n++] = static_cast<uint8_t>(value >> shift);
+        }
+    }
+    m_buffer.append(reinterpret_cast<const char*>(head), n);
+}
+
+void EncoderCBOR::putBytes(const void* data, size_t size) {
+    putHead(CBOR_BYTES, size);
+    m_buffer.append(static_cast<const char*>(data), size);
+}
+
+void EncoderCBOR::putText(const char* str, size_t size) {
+    putHead(CBOR_TEXT, size);
+    m_buffer.append(str, size);
+}
+
+void EncoderCBOR::putText(const char* str) {
+    if (str == nullptr) {
+        m_buffer.push_back(static_cast<char>(CBOR_NULL));
+        return;
+    }
+    putText(str, std::strlen(str));
+}
+
+void EncoderCBOR::putInt(int64_t value) {
+    if (value >= 0) {
+        putHead(CBOR_UINT, static_cast<uint64_t>(value));
+    } else {
+        putHead(CBOR_NEGINT, static_cast<uint64_t>(-(value + 1)));
+    }
+}
+
+// integral values take the shortest integer form, others the smallest float that keeps them
+void EncoderCBOR::putNumber(double value) {
+    if (std::isfinite(value) && value == std::trunc(value) && value >= -9.2e18 && value <= 9.2e18) {
+        putInt(static_cast<int64_t>(value));
+        return;
+    }
+    if (std::isnan(value) || static_cast<double>(static_cast<float>(value)) == value) {
+        float f = static_cast<float>(value);
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        m_buffer.push_back(static_cast<char>(CBOR_FLOAT32));
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            m_buffer.push_back(static_cast<char>(bits >> shift));
+        }
+        return;
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    m_buffer.push_back(static_cast<char>(CBOR_FLOAT64));
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        m_buffer.push_back(static_cast<char>(bits >> shift));
+    }
+}
+
+template <typename T>
+void EncoderCBOR::number(T value) {
+    if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        putInt(value);
+    } else if constexpr (std::is_integral_v<T>) {
+        putHead(CBOR_UINT, value);
+    } else {
+        putNumber(static_cast<double>(value));
+    }
+}
+
+void EncoderCBOR::map(size_t size) {
+    putHead(CBOR_MAP, size);
+    ++m_depth;
+}
+
+void EncoderCBOR::array(size_t size) {
+    putHead(CBOR_ARRAY, size);
+    ++m_depth;
+}
+
+void EncoderCBOR::close() {
+    // definite length containers have no terminator, only the nesting is tracked
+    if (m_depth > 0) {
+        --m_depth;
+    }
+}
+
+void EncoderCBOR::member(const char* key) {
+    if (m_map && m_depth == 0) {
+        if (m_member_count < kMaxMembers) {
+            m_members[m_member_count++] = static_cast<uint32_t>(m_buffer.size());
+        } else {
+            MA_LOGW(TAG, "too many members, %s can't be checked or removed", key);
+        }
+    }
+    putText(key);
+}
+
+template <typename T>
+void EncoderCBOR::item(const char* name, T value) {
+    member(name);
+    number(value);
+}
+
+void EncoderCBOR::item(const char* name, const char* value) {
+    member(name);
+    putText(value);
+}
+
+void EncoderCBOR::item(const char* name, bool value) {
+    member(name);
+    m_buffer.push_back(static_cast<char>(value ? CBOR_TRUE : CBOR_FALSE));
+}
+
+ma_err_t EncoderCBOR::status() const {
+    if (!m_begun || !m_map || m_depth != 0) [[unlikely]] {
+        return MA_EPERM;
+    }
+    return MA_OK;
+}
+
+int EncoderCBOR::find(const char* key) const {
+    size_t length = std::strlen(key);
+    const auto* data = reinterpret_cast<const uint8_t*>(m_buffer.data());
+    for (size_t i = 0; i < m_member_count; ++i) {
+        Cursor cursor(data, m_buffer.size(), m_members[i]);
+        Head h;
+        if (!cursor.head(h) || h.major != CBOR_TEXT || h.value != length) {
+            continue;
+        }
+        const uint8_t* str = cursor.take(length);
+        // compared like the JSON encoders, case insensitive
+        if (str != nullptr && strncasecmp(reinterpret_cast<const char*>(str), key, length) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+ma_err_t EncoderCBOR::ensure(const char* key) const {
+    ma_err_t ret = status();
+    if (ret != MA_OK) [[unlikely]] {
+        return ret;
+    }
+    return find(key) < 0 ? MA_OK : MA_EEXIST;
+}
+
+void EncoderCBOR::header(ma_msg_type_t type, ma_err_t code, const std::string& name) {
+    m_buffer.push_back('\r');  // prefix, the item itself is self-delimiting
+    putHead(CBOR_TAG, MA_CODEC_CBOR_MAGIC);
+    map(4);
+    item("type", static_cast<int>(type));
+    member("name");
+    putText(name.c_str(), name.size());
+    item("code", static_cast<int>(code));
+    member("data");
+    close();
+}
+
+ma_err_t EncoderCBOR::begin() {
+    reset();
+    m_buffer.push_back('\r');
+    putHead(CBOR_TAG, MA_CODEC_CBOR_MAGIC);
+    m_buffer.push_back(static_cast<char>(CBOR_INDEFINITE_MAP));
+    m_map   = true;
+    m_begun = true;
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::begin(ma_msg_type_t type, ma_err_t code, const std::string& name) {
+    reset();
+    header(type, code, name);
+    m_buffer.push_back(static_cast<char>(CBOR_INDEFINITE_MAP));
+    m_map   = true;
+    m_begun = true;
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::begin(ma_msg_type_t type, ma_err_t code, const std::string& name, const std::string& data) {
+    reset();
+    header(type, code, name);
+    putText(data.c_str(), data.size());
+    m_begun = true;
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::begin(ma_msg_type_t type, ma_err_t code, const std::string& name, uint64_t data) {
+    reset();
+    header(type, code, name);
+    number(data);
+    m_begun = true;
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::end() {
+    ma_err_t ret = MA_OK;
+    if (!m_begun) [[unlikely]] {
+        ret = MA_EPERM;
+        goto exit;
+    }
+    if (m_map) {
+        m_buffer.push_back(static_cast<char>(CBOR_BREAK));
+        m_map = false;
+    }
+    m_buffer.push_back('\n');  // suffix
+    m_string.clear();
+
+exit:
+    return ret;
+}
+
+ma_err_t EncoderCBOR::reset() {
+    // keeps the capacity for the next message
+    m_buffer.clear();
+    m_begun        = false;
+    m_map          = false;
+    m_depth        = 0;
+    m_member_count = 0;
+    m_extern_count = 0;
+    m_extern_size  = 0;
+    m_string.clear();
+    return MA_OK;
+}
+
+size_t EncoderCBOR::spans(ma_iovec_t* iov, size_t iovcnt) const {
+    if (iovcnt < m_extern_count * 2 + 1) [[unlikely]] {
+        return 0;
+    }
+    size_t n   = 0;
+    size_t pos = 0;
+    for (size_t i = 0; i < m_extern_count; ++i) {
+        const Extern& ext = m_externs[i];
+        if (ext.offset > pos) {
+            iov[n++] = {m_buffer.data() + pos, ext.offset - pos};
+        }
+        iov[n++] = {ext.data, ext.size};
+        pos      = ext.offset;
+    }
+    if (m_buffer.size() > pos) {
+        iov[n++] = {m_buffer.data() + pos, m_buffer.size() - pos};
+    }
+    return n;
+}
+
+const std::string& EncoderCBOR::toString() const {
+    if (m_extern_count == 0) {
+        return m_buffer;
+    }
+    if (m_string.empty()) {
+        ma_iovec_t iov[kMaxExterns * 2 + 1];
+        size_t n = spans(iov, std::size(iov));
+        m_string.reserve(size());
+        for (size_t i = 0; i < n; ++i) {
+            m_string.append(static_cast<const char*>(iov[i].base), iov[i].len);
+        }
+    }
+    return m_string;
+}
+
+const void* EncoderCBOR::data() const {
+    return toString().data();
+}
+
+const size_t EncoderCBOR::size() const {
+    return m_buffer.size() + m_extern_size;
+}
+
+ma_err_t EncoderCBOR::remove(const std::string& key) {
+    if (status() != MA_OK) {
+        return MA_ENOENT;
+    }
+    int index = find(key.c_str());
+    if (index < 0) {
+        return MA_ENOENT;
+    }
+
+    size_t begin = m_members[index];
+    size_t end   = static_cast<size_t>(index) + 1 < m_member_count ? m_members[index + 1] : m_buffer.size();
+    m_buffer.erase(begin, end - begin);
+
+    for (size_t i = index + 1; i < m_member_count; ++i) {
+        m_members[i - 1] = m_members[i] - static_cast<uint32_t>(end - begin);
+    }
+    --m_member_count;
+
+    // the data of a referenced member sits right after its head, so inside (begin, end]
+    size_t kept = 0;
+    for (size_t i = 0; i < m_extern_count; ++i) {
+        Extern ext = m_externs[i];
+        if (ext.offset > begin && ext.offset <= end) {
+            m_extern_size -= ext.size;
+            continue;
+        }
+        if (ext.offset > end) {
+            ext.offset -= static_cast<uint32_t>(end - begin);
+        }
+        m_externs[kept++] = ext;
+    }
+    m_extern_count = kept;
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, int8_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, int16_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, int32_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, int64_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, uint8_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, uint16_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, uint32_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, uint64_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, float value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, double value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, const std::string& value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    putText(value.c_str(), value.size());
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, ma_model_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    member(key.c_str());
+    map(5);
+    item("id", value.id);
+    item("type", static_cast<int>(value.type));
+    item("size", value.size);
+#if MA_USE_FILESYSTEM
+    item("name", static_cast<const char*>(value.name));
+    item("address", static_cast<const char*>(value.addr));
+#else
+    item("name", reinterpret_cast<uintptr_t>(value.name));
+    item("address", reinterpret_cast<uintptr_t>(value.addr));
+#endif
+    close();
+
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(ma_perf_t value) {
+    ma_err_t ret = ensure("perf");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("perf");
+    array(3);
+    number(value.preprocess);
+    number(value.inference);
+    number(value.postprocess);
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const ma_perf_ext_t& value) {
+    ma_err_t ret = write(static_cast<const ma_perf_t&>(value));
+    if (ret != MA_OK) {
+        return ret;
+    }
+    ret = ensure("ops");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("ops");
+    array(value.ops.size());
+    for (const auto& op : value.ops) {
+        array(3);
+        putText(op.tag != nullptr ? op.tag : "");
+        number(op.index);
+        number(op.time);
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const ma_perf_stats_t& value) {
+    static const char* stages[MA_PERF_STAGE_COUNT] = {"capture", "preprocess", "inference", "postprocess", "serialize", "send", "total"};
+
+    ma_err_t ret = ensure("stats");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("stats");
+    map(MA_PERF_STAGE_COUNT);
+    for (size_t i = 0; i < MA_PERF_STAGE_COUNT; ++i) {
+        const auto& stat = value.stages[i];
+        putText(stages[i]);
+        array(7);
+        number(stat.count);
+        number(stat.min);
+        number(stat.max);
+        number(stat.mean);
+        number(stat.p50);
+        number(stat.p95);
+        number(stat.p99);
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::forward_list<ma_class_t>& value) {
+    ma_err_t ret = ensure("classes");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("classes");
+    array(std::distance(value.begin(), value.end()));
+    for (const auto& cls : value) {
+        array(2);
+        number(cls.score);
+        number(cls.target);
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, const std::vector<ma_class_t>& value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    array(value.size());
+    for (const auto& cls : value) {
+        array(2);
+        number(cls.score);
+        number(cls.target);
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::forward_list<ma_keypoint3f_t>& value) {
+    ma_err_t ret = ensure("keypoints");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("keypoints");
+    array(std::distance(value.begin(), value.end()));
+    for (const auto& kpt : value) {
+        array(2);
+        // box
+        array(6);
+        number(kpt.box.x);
+        number(kpt.box.y);
+        number(kpt.box.w);
+        number(kpt.box.h);
+        number(kpt.box.score);
+        number(kpt.box.target);
+        close();
+        // pts
+        array(kpt.pts.size() * 3);
+        for (const auto& pt : kpt.pts) {
+            number(pt.x);
+            number(pt.y);
+            number(pt.z);
+        }
+        close();
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const in4_info_t& value) {
+    ma_err_t ret = ensure("in4_info");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("in4_info");
+    map(3);
+    std::string str = value.ip.to_str();
+    item("ip", str.c_str());
+    str = value.netmask.to_str();
+    item("netmask", str.c_str());
+    str = value.gateway.to_str();
+    item("gateway", str.c_str());
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const in6_info_t& value) {
+    ma_err_t ret = ensure("in6_info");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("in6_info");
+    map(1);
+    std::string str = value.ip.to_str();
+    item("ip", str.c_str());
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const ma_wifi_config_t& value, int* stat) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    const char* name = value.ssid[0] != '\0' ? value.ssid : value.bssid;
+
+    if (stat) {
+        member("config");
+        map(3);
+    }
+    item("name", name);
+    item("security", value.security);
+    item("password", value.password);
+    if (stat) {
+        close();
+        item("status", *stat);
+    }
+
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(int algo_id, int cat, int input_from, int tscore, int tiou) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    member("algorithm");
+    map(4);
+    item("type", algo_id);
+    item("category", cat);
+    item("input_from", input_from);
+    member("config");
+    map(2);
+    item("tscore", tscore);
+    item("tiou", tiou);
+    close();
+    close();
+
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::forward_list<ma_point_t>& value) {
+    ma_err_t ret = ensure("points");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("points");
+    array(std::distance(value.begin(), value.end()));
+    for (const auto& pt : value) {
+        array(4);
+        number(pt.x);
+        number(pt.y);
+        number(pt.score);
+        number(pt.target);
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::forward_list<ma_bbox_t>& value) {
+    ma_err_t ret = ensure("boxes");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("boxes");
+    array(std::distance(value.begin(), value.end()));
+    for (const auto& box : value) {
+        array(6);
+        number(box.x);
+        number(box.y);
+        number(box.w);
+        number(box.h);
+        number(box.score);
+        number(box.target);
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::vector<ma_bbox_t>& value, const std::vector<int32_t>& ids) {
+    ma_err_t ret = ensure("boxes");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("boxes");
+    array(value.size());
+    for (size_t i = 0; i < value.size(); i++) {
+        const auto& box = value[i];
+        array(7);
+        number(box.x);
+        number(box.y);
+        number(box.w);
+        number(box.h);
+        number(box.score);
+        number(box.target);
+        number(i < ids.size() ? ids[i] : static_cast<int32_t>(-1));
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, const std::vector<int32_t>& value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    array(value.size());
+    for (const auto& v : value) {
+        number(v);
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, const std::vector<ma_zone_t>& value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    array(value.size());
+    for (const auto& zone : value) {
+        map(6);
+        item("name", zone.name);
+        item("type", static_cast<int>(zone.type));
+        item("in", zone.in);
+        item("out", zone.out);
+        item("occupancy", zone.occupancy);
+        item("dwell", zone.dwell);
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::vector<ma_model_t>& value) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("models");
+    array(value.size());
+    for (const auto& model : value) {
+        map(5);
+        item("id", model.id);
+        item("type", static_cast<int>(model.type));
+        item("size", model.size);
+#if MA_USE_FILESYSTEM
+        item("name", static_cast<const char*>(model.name));
+        item("address", static_cast<const char*>(model.addr));
+#else
+        item("name", reinterpret_cast<uintptr_t>(model.name));
+        item("address", reinterpret_cast<uintptr_t>(model.addr));
+#endif
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::vector<ma::Sensor*>& value) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("sensors");
+    array(value.size());
+    for (const auto* sensor : value) {
+        map(5);
+        item("id", sensor->getID());
+        const auto& type = ma::Sensor::__repr__(sensor->getType());
+        item("type", type.c_str());
+        item("initialized", static_cast<bool>(*sensor));
+        const auto& presets = sensor->availablePresets();
+        member("presets");
+        array(std::distance(presets.begin(), presets.end()));
+        size_t j = 0;
+        for (const auto& preset : presets) {
+            map(2);
+            item("id", j++);
+            item("description", preset.description);
+            close();
+        }
+        close();
+        item("current_preset_index", sensor->currentPresetIdx());
+        close();
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const std::string& key, const char* buffer, size_t size) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    if (buffer == nullptr) {
+        size = 0;
+    }
+    // raw bytes, no base64 needed
+    putBytes(buffer, size);
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::writeBinary(const std::string& key, const void* data, size_t size) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    if (data == nullptr) {
+        size = 0;
+    }
+    if (size < kExternMinSize || m_extern_count >= kMaxExterns) {
+        putBytes(data, size);
+        return MA_OK;
+    }
+    // the head is written now, the data itself stays where it is until sent
+    putHead(CBOR_BYTES, size);
+    m_externs[m_extern_count++] = {static_cast<uint32_t>(m_buffer.size()), data, size};
+    m_extern_size += size;
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::writeMessages(const std::string& key, const std::vector<std::string>& messages) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    array(messages.size());
+    for (const auto& message : messages) {
+        // \r, the self-describe tag, the message map, then \n, only the map is kept
+        const auto* data = reinterpret_cast<const uint8_t*>(message.data());
+        if (message.size() < 5 || data[0] != '\r' || data[1] != 0xD9 || data[2] != (MA_CODEC_CBOR_MAGIC >> 8) ||
+            data[3] != (MA_CODEC_CBOR_MAGIC & 0xff) || data[message.size() - 1] != '\n') {
+            m_buffer.push_back(static_cast<char>(CBOR_NULL));
+            continue;
+        }
+        m_buffer.append(message, 4, message.size() - 5);
+    }
+    close();
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const Sensor* value, size_t preset) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("sensors");
+    if (value == nullptr) {
+        array(0);
+        close();
+        return MA_FAILED;
+    }
+
+    const auto& presets = value->availablePresets();
+    bool has_preset     = preset < static_cast<size_t>(std::distance(presets.begin(), presets.end()));
+
+    array(1);
+    map(has_preset ? 4 : 3);
+    item("id", value->getID());
+    const auto& type = ma::Sensor::__repr__(value->getType());
+    item("type", type.c_str());
+    item("initialized", static_cast<bool>(*value));
+    if (has_preset) {
+        auto it = presets.begin();
+        std::advance(it, preset);
+        member("current_preset");
+        map(2);
+        item("id", preset);
+        item("description", it->description);
+        close();
+    }
+    close();
+    close();
+
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const ma_mqtt_config_t& value, int* stat) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    if (stat) {
+        member("config");
+        map(6);
+    }
+    item("address", value.host);
+    item("port", value.port);
+    item("username", value.username);
+    item("password", value.password);
+    item("client_id", value.client_id);
+    item("use_ssl", static_cast<int>(value.use_ssl));
+    if (stat) {
+        close();
+        item("status", *stat);
+    }
+
+    return MA_OK;
+}
+
+ma_err_t EncoderCBOR::write(const ma_mqtt_topic_config_t& value) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    member("config");
+    map(4);
+    item("pub_topic", value.pub_topic);
+    item("pub_qos", static_cast<int>(value.pub_qos));
+    item("sub_topic", value.sub_topic);
+    item("sub_qos", static_cast<int>(value.sub_qos));
+    close();
+
+    return MA_OK;
+}
+
+
+DecoderCBOR::DecoderCBOR() : m_data(0), m_type(MA_MSG_TYPE_RESP), m_code(MA_OK), m_mutex(false) {}
+
+DecoderCBOR::~DecoderCBOR() = default;
+
+DecoderCBOR::operator bool() const {
+    return m_data != 0;
+}
+
+ma_err_t DecoderCBOR::begin(const std::string& data) {
+    return begin(data.data(), data.size());
+}
+
+ma_err_t DecoderCBOR::begin(const void* data, size_t size) {
+    m_mutex.lock();
+
+    m_string.assign(static_cast<const char*>(data), size);
+    m_data = 0;
+
+    bool has_type = false, has_code = false, has_name = false;
+    // the framing of the encoder is optional
+    size_t offset = !m_string.empty() && m_string.front() == '\r' ? 1 : 0;
+    Cursor cursor(reinterpret_cast<const uint8_t*>(m_string.data()), m_string.size(), offset);
+    Head h;
+
+    if (!cursor.head(h)) {
+        goto err;
+    }
+    if (h.major == CBOR_TAG) {
+        if (h.value != MA_CODEC_CBOR_MAGIC || !cursor.head(h)) {
+            goto err;
+        }
+    }
+    if (h.major != CBOR_MAP) {
+        goto err;
+    }
+
+    for (uint64_t i = 0; h.info == CBOR_INFO_INDEFINITE ? !cursor.peekBreak() : i < h.value; ++i) {
+        std::string key;
+        if (!cursor.text(key)) {
+            goto err;
+        }
+        double number = 0;
+        if (key == "type") {
+            has_type = cursor.number(number);
+            m_type   = static_cast<ma_msg_type_t>(number);
+        } else if (key == "code") {
+            has_code = cursor.number(number);
+            m_code   = static_cast<ma_err_t>(number);
+        } else if (key == "name") {
+            has_name = cursor.text(m_name);
+        } else if (key == "data") {
+            m_data = cursor.pos();
+            if (!cursor.skip()) {
+                goto err;
+            }
+        } else if (!cursor.skip()) {
+            goto err;
+        }
+    }
+
+    if (m_data == 0 || !has_type || !has_code || !has_name) {
+        goto err;
+    }
+
+    return MA_OK;
+
+err:
+    m_data = 0;
+    m_mutex.unlock();
+    return MA_FAILED;
+}
+
+ma_err_t DecoderCBOR::end() {
+    m_data = 0;
+    m_string.clear();
+    m_mutex.unlock();
+    return MA_OK;
+}
+
+ma_msg_type_t DecoderCBOR::type() const {
+    return m_type;
+}
+
+ma_err_t DecoderCBOR::code() const {
+    return m_code;
+}
+
+std::string DecoderCBOR::name() const {
+    return m_name;
+}
+
+// offset of the value of a data member, 0 when not found
+size_t DecoderCBOR::find(const char* key) const {
+    if (m_data == 0) {
+        return 0;
+    }
+    Cursor cursor(reinterpret_cast<const uint8_t*>(m_string.data()), m_string.size(), m_data);
+    Head h;
+    if (!cursor.head(h) || h.major != CBOR_MAP) {
+        return 0;
+    }
+    size_t length = std::strlen(key);
+    for (uint64_t i = 0; h.info == CBOR_INFO_INDEFINITE ? !cursor.peekBreak() : i < h.value; ++i) {
+        Head k;
+        if (!cursor.head(k) || k.major != CBOR_TEXT || k.info == CBOR_INFO_INDEFINITE) {
+            return 0;
+        }
+        const uint8_t* str = cursor.take(k.value);
+        if (str == nullptr) {
+            return 0;
+        }
+        if (k.value == length && std::memcmp(str, key, length) == 0) {
+            return cursor.pos();
+        }
+        if (!cursor.skip()) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+template <typename T>
+ma_err_t DecoderCBOR::readNumber(const std::string& key, T& value) const {
+    size_t pos = find(key.c_str());
+    if (pos == 0) {
+        return MA_FAILED;
+    }
+    Cursor cursor(reinterpret_cast<const uint8_t*>(m_string.data()), m_string.size(), pos);
+    double number = 0;
+    if (!cursor.number(number)) {
+        return MA_FAILED;
+    }
+    value = static_cast<T>(number);
+    return MA_OK;
+}
+
+ma_err_t DecoderCBOR::readArray(const char* key, size_t width, const std::function<void(const double*)>& fn) const {
+    size_t pos = find(key);
+    if (pos == 0) {
+        return MA_FAILED;
+    }
+    Cursor cursor(reinterpret_cast<const uint8_t*>(m_string.data()), m_string.size(), pos);
+    Head h;
+    if (!cursor.head(h) || h.major != CBOR_ARRAY || h.info == CBOR_INFO_INDEFINITE) {
+        return MA_FAILED;
+    }
+    double values[8];
+    for (uint64_t i = 0; i < h.value; ++i) {
+        size_t start = cursor.pos();
+        Head e;
+        if (!cursor.head(e)) {
+            return MA_FAILED;
+        }
+        bool ok = e.major == CBOR_ARRAY && e.value == width && width <= 8;
+        for (size_t j = 0; ok && j < width; ++j) {
+            ok = cursor.number(values[j]);
+        }
+        if (ok) {
+            fn(values);
+            continue;
+        }
+        // skip malformed entries, like the JSON decoder
+        cursor = Cursor(reinterpret_cast<const uint8_t*>(m_string.data()), m_string.size(), start);
+        if (!cursor.skip()) {
+            return MA_FAILED;
+        }
+    }
+    return MA_OK;
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, int8_t& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, int16_t& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, int32_t& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, int64_t& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, uint8_t& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, uint16_t& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, uint32_t& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, uint64_t& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, float& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, double& value) const {
+    return readNumber(key, value);
+}
+
+ma_err_t DecoderCBOR::read(const std::string& key, std::string& value) const {
+    size_t pos = find(key.c_str());
+    if (pos == 0) {
+        return MA_FAILED;
+    }
+    Cursor cursor(reinterpret_cast<const uint8_t*>(m_string.data()), m_string.size(), pos);
+    return cursor.text(value) ? MA_OK : MA_FAILED;
+}
+
+ma_err_t DecoderCBOR::read(ma_perf_t& value) {
+    size_t pos = find("perf");
+    if (pos == 0) {
+        return MA_FAILED;
+    }
+    Cursor cursor(reinterpret_cast<const uint8_t*>(m_string.data()), m_string.size(), pos);
+    Head h;
+    double values[3];
+    if (!cursor.head(h) || h.major != CBOR_ARRAY || h.value != 3 || !cursor.number(values[0]) || !cursor.number(values[1]) || !cursor.number(values[2])) {
+        return MA_FAILED;
+    }
+    value.preprocess  = static_cast<int64_t>(values[0]);
+    value.inference   = static_cast<int64_t>(values[1]);
+    value.postprocess = static_cast<int64_t>(values[2]);
+    return MA_OK;
+}
+
+ma_err_t DecoderCBOR::read(std::forward_list<ma_class_t>& value) {
+    value.clear();
+    return readArray("classes", 2, [&](const double* v) {
+        ma_class_t t;
+        t.score  = v[0];
+        t.target = static_cast<int>(v[1]);
+        value.emplace_front(std::move(t));
+    });
+}
+
+ma_err_t DecoderCBOR::read(std::forward_list<ma_point_t>& value) {
+    value.clear();
+    return readArray("points", 4, [&](const double* v) {
+        ma_point_t t;
+        t.x      = v[0];
+        t.y      = v[1];
+        t.score  = v[2];
+        t.target = static_cast<int>(v[3]);
+        value.emplace_front(std::move(t));
+    });
+}
+
+ma_err_t DecoderCBOR::read(std::forward_list<ma_bbox_t>& value) {
+    value.clear();
+    return readArray("boxes", 6, [&](const double* v) {
+        ma_bbox_t t;
+        t.x      = v[0];
+        t.y      = v[1];
+        t.w      = v[2];
+        t.h      = v[3];
+        t.score  = v[4];
+        t.target = static_cast<int>(v[5]);
+        value.emplace_front(std::move(t));
+    });
+}
+
+}  // namespace ma
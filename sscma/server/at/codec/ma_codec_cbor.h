@@ -0,0 +1,201 @@
+#ifndef _MA_CODEC_CBOR_H_
+#define _MA_CODEC_CBOR_H_
+
+#include <functional>
+
+#include "core/ma_common.h"
+#include "porting/ma_osal.h"
+
+#include "ma_codec_base.h"
+
+namespace ma {
+
+// self-described CBOR tag number (RFC 8949 3.4.6), every message starts with it as a marker
+constexpr uint16_t MA_CODEC_CBOR_MAGIC = 0xD9F7;
+
+/*!
+ * @brief CBOR (RFC 8949) encoder, each message is the self-describe tag followed by a map
+ * holding the same type, name, code and data members as the JSON messages, framed by \r
+ * and \n like them.
+ *
+ * Numbers are stored in their shortest integer form when integral, results stay nested
+ * integer arrays, and buffers written with write(key, buffer, size) are stored as raw byte
+ * strings instead of text. Large binary data from writeBinary() is not copied, it is sent
+ * as its own span (see spans()) and only joined when data() or toString() is called.
+ *
+ * Holds no lock, an instance belongs to a single thread (see ATSession).
+ */
+class EncoderCBOR final : public Encoder {
+
+public:
+    EncoderCBOR();
+    ~EncoderCBOR();
+
+    operator bool() const override;
+
+    ma_codec_type_t getType() const override;
+
+    ma_err_t begin() override;
+    ma_err_t begin(ma_msg_type_t type, ma_err_t code, const std::string& name) override;
+    ma_err_t begin(ma_msg_type_t type, ma_err_t code, const std::string& name, const std::string& data) override;
+    ma_err_t begin(ma_msg_type_t type, ma_err_t code, const std::string& name, uint64_t data) override;
+    ma_err_t end() override;
+    ma_err_t reset() override;
+
+    ma_err_t remove(const std::string& key) override;
+
+    ma_err_t write(const std::string& key, const char* buffer, size_t size) override;
+    ma_err_t writeBinary(const std::string& key, const void* data, size_t size) override;
+    ma_err_t writeMessages(const std::string& key, const std::vector<std::string>& messages) override;
+
+
+    ma_err_t write(const std::string& key, int8_t value) override;
+    ma_err_t write(const std::string& key, int16_t value) override;
+    ma_err_t write(const std::string& key, int32_t value) override;
+    ma_err_t write(const std::string& key, int64_t value) override;
+    ma_err_t write(const std::string& key, uint8_t value) override;
+    ma_err_t write(const std::string& key, uint16_t value) override;
+    ma_err_t write(const std::string& key, uint32_t value) override;
+    ma_err_t write(const std::string& key, uint64_t value) override;
+    ma_err_t write(const std::string& key, float value) override;
+    ma_err_t write(const std::string& key, double value) override;
+    ma_err_t write(const std::string& key, const std::string& value) override;
+    ma_err_t write(const std::string& key, ma_model_t value) override;
+    ma_err_t write(ma_perf_t value) override;
+    ma_err_t write(const ma_perf_ext_t& value) override;
+    ma_err_t write(const ma_perf_stats_t& value) override;
+
+    ma_err_t write(const std::forward_list<ma_class_t>& value) override;
+    ma_err_t write(const std::string& key, const std::vector<ma_class_t>& value) override;
+    ma_err_t write(const std::forward_list<ma_point_t>& value) override;
+    ma_err_t write(const std::forward_list<ma_bbox_t>& value) override;
+    ma_err_t write(const std::vector<ma_bbox_t>& value, const std::vector<int32_t>& ids) override;
+    ma_err_t write(const std::string& key, const std::vector<int32_t>& value) override;
+    ma_err_t write(const std::string& key, const std::vector<ma_zone_t>& value) override;
+    ma_err_t write(const std::forward_list<ma_keypoint3f_t>& value) override;
+
+    ma_err_t write(const std::vector<ma_model_t>& value) override;
+
+
+    ma_err_t write(const std::vector<Sensor*>& value) override;
+    ma_err_t write(const Sensor* value, size_t preset) override;
+
+
+    ma_err_t write(const in4_info_t& value) override;
+    ma_err_t write(const in6_info_t& value) override;
+    ma_err_t write(const ma_wifi_config_t& value, int* stat = nullptr) override;
+
+    ma_err_t write(const ma_mqtt_config_t& value, int* stat = nullptr) override;
+
+    ma_err_t write(const ma_mqtt_topic_config_t& value) override;
+
+
+    ma_err_t write(int algo_id, int cat, int input_from, int tscore, int tiou) override;
+
+
+    // the message is binary, the returned string may hold any byte
+    const std::string& toString() const override;
+    const void* data() const override;
+    const size_t size() const override;
+    size_t spans(ma_iovec_t* iov, size_t iovcnt) const override;
+
+private:
+    static constexpr size_t kMaxMembers = 32;
+    // binary data referenced instead of copied, from this size on and while slots are left
+    static constexpr size_t kMaxExterns    = 4;
+    static constexpr size_t kExternMinSize = 256;
+
+    struct Extern {
+        uint32_t offset;  // position in m_buffer the data belongs at
+        const void* data;
+        size_t size;
+    };
+
+    void putHead(uint8_t major, uint64_t value);
+    void putBytes(const void* data, size_t size);
+    void putText(const char* str, size_t size);
+    void putText(const char* str);
+    void putNumber(double value);
+    void putInt(int64_t value);
+
+    void map(size_t size);
+    void array(size_t size);
+    void close();
+    void member(const char* key);
+
+    template <typename T>
+    void number(T value);
+    template <typename T>
+    void item(const char* name, T value);
+    void item(const char* name, const char* value);
+    void item(const char* name, bool value);
+
+    void header(ma_msg_type_t type, ma_err_t code, const std::string& name);
+    ma_err_t ensure(const char* key) const;
+    int find(const char* key) const;
+    ma_err_t status() const;
+
+    std::string m_buffer;
+    bool m_begun;
+    bool m_map;      // data is an open indefinite length map
+    size_t m_depth;  // nesting below the data map
+
+    // start offsets of the members of the data map, for duplicate checks and remove()
+    uint32_t m_members[kMaxMembers];
+    size_t m_member_count;
+
+    Extern m_externs[kMaxExterns];
+    size_t m_extern_count;
+    size_t m_extern_size;
+    mutable std::string m_string;  // joined message, only built when asked for with externs
+};
+
+class DecoderCBOR final : public Decoder {
+
+public:
+    DecoderCBOR();
+    ~DecoderCBOR();
+
+    operator bool() const override;
+
+    ma_err_t begin(const void* data, size_t size) override;
+    ma_err_t begin(const std::string& str) override;
+    ma_err_t end() override;
+
+    ma_msg_type_t type() const override;
+    ma_err_t code() const override;
+    std::string name() const override;
+
+    ma_err_t read(const std::string& key, int8_t& value) const override;
+    ma_err_t read(const std::string& key, int16_t& value) const override;
+    ma_err_t read(const std::string& key, int32_t& value) const override;
+    ma_err_t read(const std::string& key, int64_t& value) const override;
+    ma_err_t read(const std::string& key, uint8_t& value) const override;
+    ma_err_t read(const std::string& key, uint16_t& value) const override;
+    ma_err_t read(const std::string& key, uint32_t& value) const override;
+    ma_err_t read(const std::string& key, uint64_t& value) const override;
+    ma_err_t read(const std::string& key, float& value) const override;
+    ma_err_t read(const std::string& key, double& value) const override;
+    ma_err_t read(const std::string& key, std::string& value) const override;
+    ma_err_t read(ma_perf_t& value) override;
+    ma_err_t read(std::forward_list<ma_class_t>& value) override;
+    ma_err_t read(std::forward_list<ma_point_t>& value) override;
+    ma_err_t read(std::forward_list<ma_bbox_t>& value) override;
+
+private:
+    template <typename T>
+    ma_err_t readNumber(const std::string& key, T& value) const;
+    ma_err_t readArray(const char* key, size_t width, const std::function<void(const double*)>& fn) const;
+    size_t find(const char* key) const;
+
+    std::string m_string;
+    size_t m_data;  // offset of the data map, 0 when missing
+    ma_msg_type_t m_type;
+    ma_err_t m_code;
+    std::string m_name;
+    Mutex m_mutex;
+};
+
+}  // namespace ma
+
+#endif  // _MA_CODEC_CBOR_H_
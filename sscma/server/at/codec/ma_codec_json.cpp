@@ -2,11 +2,15 @@
 
 #include <cJSON.h>
 
+#include <cstring>
+
+#include "core/utils/ma_base64.h"
+
 namespace ma {
 
 static const char* TAG = "ma::codec::JSON";
 
-EncoderJSON::EncoderJSON() : m_mutex(false) {
+EncoderJSON::EncoderJSON() : m_mutex(false), m_print(nullptr), m_print_size(0) {
 
     m_root = nullptr;
     m_data = nullptr;
@@ -26,12 +30,19 @@ EncoderJSON::~EncoderJSON() {
     if (m_root) {
         cJSON_Delete(m_root);
     }
+    if (m_print) {
+        ma_free(m_print);
+    }
 }
 
 EncoderJSON::operator bool() const {
     return m_root != nullptr;
 }
 
+ma_codec_type_t EncoderJSON::getType() const {
+    return MA_CODEC_JSON;
+}
+
 ma_err_t EncoderJSON::begin() {
     m_mutex.lock();
     ma_err_t ret = reset();
@@ -118,43 +129,63 @@ ma_err_t EncoderJSON::begin(ma_msg_type_t type, ma_err_t code, const std::string
 
 ma_err_t EncoderJSON::end() {
     ma_err_t ret = MA_OK;
-    char* str    = nullptr;
     if (m_root == nullptr) [[unlikely]] {
         ret = MA_EPERM;
         goto exit;
     }
-    str = cJSON_PrintUnformatted(m_root);
-    if (!str) [[unlikely]] {
-        ret = MA_ENOMEM;
+    m_string.clear();
+    if (m_print) {
+        ma_free(m_print);
+    }
+    m_print = cJSON_PrintUnformatted(m_root);
+    if (!m_print) [[unlikely]] {
+        m_print_size = 0;
+        ret          = MA_ENOMEM;
         goto exit;
     }
-    m_string.clear();
-    m_string.shrink_to_fit();
-    m_string += "\r";  // prefix
-    m_string += str;
-    m_string += "\n";  // suffix
-    ma_free(str);
+    m_print_size = std::strlen(m_print);
 
 exit:
     m_mutex.unlock();
     return ret;
 }
 
+size_t EncoderJSON::spans(ma_iovec_t* iov, size_t iovcnt) const {
+    if (m_print == nullptr || iovcnt < 3) {
+        return 0;
+    }
+    iov[0] = {"\r", 1};  // prefix
+    iov[1] = {m_print, m_print_size};
+    iov[2] = {"\n", 1};  // suffix
+    return 3;
+}
+
 const std::string& EncoderJSON::toString() const {
+    if (m_string.empty() && m_print) {
+        m_string.reserve(m_print_size + 2);
+        m_string += "\r";  // prefix
+        m_string.append(m_print, m_print_size);
+        m_string += "\n";  // suffix
+    }
     return m_string;
 }
 
 const void* EncoderJSON::data() const {
-    return m_string.c_str();
+    return toString().c_str();
 }
 
 const size_t EncoderJSON::size() const {
-    return m_string.size();
+    return m_print ? m_print_size + 2 : 0;
 }
 
 ma_err_t EncoderJSON::reset() {
     m_string.clear();
     m_string.shrink_to_fit();
+    if (m_print) {
+        ma_free(m_print);
+        m_print      = nullptr;
+        m_print_size = 0;
+    }
     if (m_root) {
         cJSON_Delete(m_root);
         m_root = nullptr;
@@ -291,6 +322,55 @@ ma_err_t EncoderJSON::write(ma_perf_t value) {
     return MA_OK;
 }
 
+ma_err_t EncoderJSON::write(const ma_perf_ext_t& value) {
+    ma_err_t ret = write(static_cast<const ma_perf_t&>(value));
+    if (ret != MA_OK) {
+        return ret;
+    }
+    if (cJSON_GetObjectItem(m_data, "ops") != nullptr) {
+        return MA_EEXIST;
+    }
+    cJSON* array = cJSON_AddArrayToObject(m_data, "ops");
+    if (array == nullptr) {
+        return MA_FAILED;
+    }
+    for (const auto& op : value.ops) {
+        cJSON* item = cJSON_CreateArray();
+        cJSON_AddItemToArray(item, cJSON_CreateString(op.tag != nullptr ? op.tag : ""));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(op.index));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(op.time));
+        cJSON_AddItemToArray(array, item);
+    }
+    return MA_OK;
+}
+
+ma_err_t EncoderJSON::write(const ma_perf_stats_t& value) {
+    static const char* stages[MA_PERF_STAGE_COUNT] = {"capture", "preprocess", "inference", "postprocess", "serialize", "send", "total"};
+
+    if (cJSON_GetObjectItem(m_data, "stats") != nullptr) {
+        return MA_EEXIST;
+    }
+    cJSON* object = cJSON_AddObjectToObject(m_data, "stats");
+    if (object == nullptr) {
+        return MA_FAILED;
+    }
+    for (size_t i = 0; i < MA_PERF_STAGE_COUNT; ++i) {
+        const auto& stat = value.stages[i];
+        cJSON* item      = cJSON_AddArrayToObject(object, stages[i]);
+        if (item == nullptr) {
+            return MA_FAILED;
+        }
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(stat.count));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(stat.min));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(stat.max));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(stat.mean));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(stat.p50));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(stat.p95));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(stat.p99));
+    }
+    return MA_OK;
+}
+
 ma_err_t EncoderJSON::write(const std::forward_list<ma_class_t>& value) {
     if (cJSON_GetObjectItem(m_data, "classes") != nullptr) {
         return MA_EEXIST;
@@ -312,9 +392,31 @@ ma_err_t EncoderJSON::write(const std::forward_list<ma_class_t>& value) {
     return MA_OK;
 }
 
+ma_err_t EncoderJSON::write(const std::string& key, const std::vector<ma_class_t>& value) {
+    if (cJSON_GetObjectItem(m_data, key.c_str()) != nullptr) {
+        return MA_EEXIST;
+    }
+    cJSON* array = cJSON_AddArrayToObject(m_data, key.c_str());
+    if (array == nullptr) {
+        return MA_FAILED;
+    }
+    for (const auto& cls : value) {
+        cJSON* item = cJSON_CreateArray();
+        if (item == nullptr) {
+            return MA_FAILED;
+        }
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(cls.score));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(cls.target));
+        cJSON_AddItemToArray(array, item);
+    }
+    return MA_OK;
+}
+
 ma_err_t EncoderJSON::write(const std::forward_list<ma_keypoint3f_t>& value) {
-    cJSON* array = cJSON_CreateArray();
-    cJSON_ReplaceItemInObjectCaseSensitive(m_root, "keypoints", array);
+    if (cJSON_GetObjectItem(m_data, "keypoints") != nullptr) {
+        return MA_EEXIST;
+    }
+    cJSON* array = cJSON_AddArrayToObject(m_data, "keypoints");
     if (array == nullptr) {
         return MA_FAILED;
     }
@@ -489,6 +591,70 @@ ma_err_t EncoderJSON::write(const std::forward_list<ma_bbox_t>& value) {
     return MA_OK;
 }
 
+ma_err_t EncoderJSON::write(const std::vector<ma_bbox_t>& value, const std::vector<int32_t>& ids) {
+    if (cJSON_GetObjectItem(m_data, "boxes") != nullptr) {
+        return MA_EEXIST;
+    }
+    cJSON* array = cJSON_AddArrayToObject(m_data, "boxes");
+    if (array == nullptr) {
+        return MA_FAILED;
+    }
+    for (size_t i = 0; i < value.size(); i++) {
+        const auto& box = value[i];
+        cJSON* item     = cJSON_CreateArray();
+        if (item == nullptr) {
+            return MA_FAILED;
+        }
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(box.x));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(box.y));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(box.w));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(box.h));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(box.score));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(box.target));
+        cJSON_AddItemToArray(item, cJSON_CreateNumber(i < ids.size() ? ids[i] : -1));
+        cJSON_AddItemToArray(array, item);
+    }
+    return MA_OK;
+}
+
+ma_err_t EncoderJSON::write(const std::string& key, const std::vector<int32_t>& value) {
+    if (cJSON_GetObjectItem(m_data, key.c_str()) != nullptr) {
+        return MA_EEXIST;
+    }
+    cJSON* array = cJSON_AddArrayToObject(m_data, key.c_str());
+    if (array == nullptr) {
+        return MA_FAILED;
+    }
+    for (const auto& v : value) {
+        cJSON_AddItemToArray(array, cJSON_CreateNumber(v));
+    }
+    return MA_OK;
+}
+
+ma_err_t EncoderJSON::write(const std::string& key, const std::vector<ma_zone_t>& value) {
+    if (cJSON_GetObjectItem(m_data, key.c_str()) != nullptr) {
+        return MA_EEXIST;
+    }
+    cJSON* array = cJSON_AddArrayToObject(m_data, key.c_str());
+    if (array == nullptr) {
+        return MA_FAILED;
+    }
+    for (const auto& zone : value) {
+        cJSON* item = cJSON_CreateObject();
+        if (item == nullptr) {
+            return MA_FAILED;
+        }
+        cJSON_AddItemToObject(item, "name", cJSON_CreateString(zone.name));
+        cJSON_AddItemToObject(item, "type", cJSON_CreateNumber(zone.type));
+        cJSON_AddItemToObject(item, "in", cJSON_CreateNumber(zone.in));
+        cJSON_AddItemToObject(item, "out", cJSON_CreateNumber(zone.out));
+        cJSON_AddItemToObject(item, "occupancy", cJSON_CreateNumber(zone.occupancy));
+        cJSON_AddItemToObject(item, "dwell", cJSON_CreateNumber(zone.dwell));
+        cJSON_AddItemToArray(array, item);
+    }
+    return MA_OK;
+}
+
 ma_err_t EncoderJSON::write(const std::vector<ma_model_t>& value) {
     cJSON* array = cJSON_AddArrayToObject(m_data, "models");
     if (array == nullptr) {
@@ -564,6 +730,52 @@ ma_err_t EncoderJSON::write(const std::string& key, const char* buffer, size_t s
     return MA_OK;
 }
 
+ma_err_t EncoderJSON::writeBinary(const std::string& key, const void* data, size_t size) {
+    if (cJSON_GetObjectItem(m_data, key.c_str()) != nullptr) {
+        return MA_EEXIST;
+    }
+
+    // encoded straight into the string owned by the item, freed by cJSON_Delete through the hooks
+    int length   = ma::utils::base64_encoded_size(size);
+    char* string = static_cast<char*>(ma_malloc(length + 1));
+    if (string == nullptr) {
+        return MA_ENOMEM;
+    }
+    ma::utils::base64_encode(static_cast<const unsigned char*>(data), size, string, &length);
+    string[length] = '\0';
+
+    cJSON* item = cJSON_CreateNull();
+    if (item == nullptr) {
+        ma_free(string);
+        return MA_ENOMEM;
+    }
+    item->type        = cJSON_String;
+    item->valuestring = string;
+    cJSON_AddItemToObject(m_data, key.c_str(), item);
+    return MA_OK;
+}
+
+ma_err_t EncoderJSON::writeMessages(const std::string& key, const std::vector<std::string>& messages) {
+    if (cJSON_GetObjectItem(m_data, key.c_str()) != nullptr) {
+        return MA_EEXIST;
+    }
+    cJSON* array = cJSON_AddArrayToObject(m_data, key.c_str());
+    if (array == nullptr) [[unlikely]] {
+        return MA_ENOMEM;
+    }
+    for (const auto& message : messages) {
+        // the \r prefix and \n suffix are whitespace to the parser
+        cJSON* item = cJSON_Parse(message.c_str());
+        if (item == nullptr) {
+            item = cJSON_CreateNull();
+        }
+        if (item == nullptr || !cJSON_AddItemToArray(array, item)) [[unlikely]] {
+            return MA_ENOMEM;
+        }
+    }
+    return MA_OK;
+}
+
 ma_err_t EncoderJSON::write(const Sensor* value, size_t preset) {
     cJSON* array = cJSON_AddArrayToObject(m_data, "sensors");
     if (array == nullptr || value == nullptr) {
@@ -18,6 +18,8 @@ public:
 
     operator bool() const override;
 
+    ma_codec_type_t getType() const override;
+
     ma_err_t begin() override;
     ma_err_t begin(ma_msg_type_t type, ma_err_t code, const std::string& name) override;
     ma_err_t begin(ma_msg_type_t type, ma_err_t code, const std::string& name, const std::string& data) override;
@@ -28,6 +30,8 @@ public:
     ma_err_t remove(const std::string& key) override;
 
     ma_err_t write(const std::string& key, const char* buffer, size_t size) override;
+    ma_err_t writeBinary(const std::string& key, const void* data, size_t size) override;
+    ma_err_t writeMessages(const std::string& key, const std::vector<std::string>& messages) override;
 
 
     ma_err_t write(const std::string& key, int8_t value) override;
@@ -43,10 +47,16 @@ public:
     ma_err_t write(const std::string& key, const std::string& value) override;
     ma_err_t write(const std::string& key, ma_model_t value) override;
     ma_err_t write(ma_perf_t value) override;
+    ma_err_t write(const ma_perf_ext_t& value) override;
+    ma_err_t write(const ma_perf_stats_t& value) override;
 
     ma_err_t write(const std::forward_list<ma_class_t>& value) override;
+    ma_err_t write(const std::string& key, const std::vector<ma_class_t>& value) override;
     ma_err_t write(const std::forward_list<ma_point_t>& value) override;
     ma_err_t write(const std::forward_list<ma_bbox_t>& value) override;
+    ma_err_t write(const std::vector<ma_bbox_t>& value, const std::vector<int32_t>& ids) override;
+    ma_err_t write(const std::string& key, const std::vector<int32_t>& value) override;
+    ma_err_t write(const std::string& key, const std::vector<ma_zone_t>& value) override;
     ma_err_t write(const std::forward_list<ma_keypoint3f_t>& value) override;
 
     ma_err_t write(const std::vector<ma_model_t>& value) override;
@@ -71,12 +81,15 @@ public:
     const std::string& toString() const override;
     const void* data() const override;
     const size_t size() const override;
+    size_t spans(ma_iovec_t* iov, size_t iovcnt) const override;
 
 private:
     cJSON* m_root;
     cJSON* m_data;
     Mutex m_mutex;
-    mutable std::string m_string;
+    char* m_print;  // printed body, sent between the prefix and suffix without joining them
+    size_t m_print_size;
+    mutable std::string m_string;  // joined message, only built when asked for
 };
 
 class DecoderJSON final : public Decoder {
@@ -0,0 +1,1045 @@
+#include "ma_codec_json_stream.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include <strings.h>
+
+#include "core/utils/ma_base64.h"
+
+namespace ma {
+
+static const char* TAG = "ma::codec::JSONStream";
+
+EncoderJSONStream::EncoderJSONStream()
+    : m_buffer(nullptr), m_capacity(0), m_size(0), m_static(false), m_overflow(false), m_begun(false), m_depth(0), m_level(0), m_member_count(0) {}
+
+EncoderJSONStream::EncoderJSONStream(char* buffer, size_t size)
+    : m_buffer(buffer), m_capacity(buffer != nullptr ? size : 0), m_size(0), m_static(true), m_overflow(false), m_begun(false), m_depth(0), m_level(0), m_member_count(0) {}
+
+EncoderJSONStream::~EncoderJSONStream() = default;
+
+EncoderJSONStream::operator bool() const {
+    return m_begun;
+}
+
+ma_codec_type_t EncoderJSONStream::getType() const {
+    return MA_CODEC_JSON;
+}
+
+bool EncoderJSONStream::reserve(size_t size) {
+    if (m_overflow) [[unlikely]] {
+        return false;
+    }
+    if (m_size + size <= m_capacity) [[likely]] {
+        return true;
+    }
+    if (m_static) {
+        MA_LOGW(TAG, "buffer overflow: %u + %u > %u", static_cast<unsigned>(m_size), static_cast<unsigned>(size), static_cast<unsigned>(m_capacity));
+        m_overflow = true;
+        return false;
+    }
+    // grow geometrically, the capacity is kept for the following messages
+    size_t capacity = std::max({m_capacity * 2, m_size + size, static_cast<size_t>(256)});
+    m_storage.resize(capacity);
+    m_buffer   = m_storage.data();
+    m_capacity = capacity;
+    return true;
+}
+
+void EncoderJSONStream::put(char c) {
+    if (reserve(1)) [[likely]] {
+        m_buffer[m_size++] = c;
+    }
+}
+
+void EncoderJSONStream::put(const char* str, size_t size) {
+    if (size != 0 && reserve(size)) [[likely]] {
+        std::memcpy(m_buffer + m_size, str, size);
+        m_size += size;
+    }
+}
+
+// same escaping as cJSON print_string_ptr
+void EncoderJSONStream::putString(const char* str, size_t size) {
+    static const char* digits = "0123456789abcdef";
+
+    put('"');
+    const char* run = str;
+    const char* end = str + size;
+    for (const char* p = str; p < end; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 32 && c != '"' && c != '\\') [[likely]] {
+            continue;
+        }
+        put(run, p - run);
+        run = p + 1;
+
+        char escaped[6] = {'\\', 0, 0, 0, 0, 0};
+        size_t length   = 2;
+        switch (c) {
+            case '"':
+            case '\\':
+                escaped[1] = static_cast<char>(c);
+                break;
+            case '\b':
+                escaped[1] = 'b';
+                break;
+            case '\f':
+                escaped[1] = 'f';
+                break;
+            case '\n':
+                escaped[1] = 'n';
+                break;
+            case '\r':
+                escaped[1] = 'r';
+                break;
+            case '\t':
+                escaped[1] = 't';
+                break;
+            default:
+                escaped[1] = 'u';
+                escaped[2] = '0';
+                escaped[3] = '0';
+                escaped[4] = digits[c >> 4];
+                escaped[5] = digits[c & 0xf];
+                length     = 6;
+                break;
+        }
+        put(escaped, length);
+    }
+    put(run, end - run);
+    put('"');
+}
+
+void EncoderJSONStream::putString(const char* str) {
+    putString(str, std::strlen(str));
+}
+
+void EncoderJSONStream::putUint(uint64_t value) {
+    char buffer[20];
+    char* p = buffer + sizeof(buffer);
+    do {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    put(p, buffer + sizeof(buffer) - p);
+}
+
+void EncoderJSONStream::putInt(int64_t value) {
+    if (value < 0) {
+        put('-');
+        putUint(0 - static_cast<uint64_t>(value));
+        return;
+    }
+    putUint(static_cast<uint64_t>(value));
+}
+
+// matches cJSON print_number with the bundled precision patch: integers that fit an int
+// print as integers, everything else with %1.4g
+void EncoderJSONStream::putNumber(double value) {
+    if (std::isnan(value) || std::isinf(value)) {
+        put("null", 4);
+    } else if (value >= INT_MIN && value <= INT_MAX && value == static_cast<double>(static_cast<int>(value))) {
+        putInt(static_cast<int>(value));
+    } else {
+        char buffer[26];
+        int length = std::snprintf(buffer, sizeof(buffer), "%1.4g", value);
+        if (length > 0) {
+            put(buffer, std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+        }
+    }
+}
+
+template <typename T>
+void EncoderJSONStream::number(T value) {
+    if constexpr (std::is_integral_v<T>) {
+        if constexpr (std::is_signed_v<T>) {
+            if (value >= INT_MIN && value <= INT_MAX) [[likely]] {
+                putInt(value);
+                return;
+            }
+        } else {
+            if (value <= static_cast<unsigned>(INT_MAX)) [[likely]] {
+                putUint(value);
+                return;
+            }
+        }
+        putNumber(static_cast<double>(value));
+    } else {
+        putNumber(static_cast<double>(value));
+    }
+}
+
+void EncoderJSONStream::separate() {
+    if (m_depth == 0) {
+        return;
+    }
+    if (!m_first[m_depth - 1]) {
+        put(',');
+    }
+    m_first[m_depth - 1] = false;
+}
+
+void EncoderJSONStream::open(char c) {
+    MA_ASSERT(m_depth < kMaxDepth);
+    put(c);
+    m_first[m_depth]  = true;
+    m_closer[m_depth] = c == '{' ? '}' : ']';
+    ++m_depth;
+}
+
+void EncoderJSONStream::close() {
+    if (m_depth == 0) {
+        return;
+    }
+    --m_depth;
+    put(m_closer[m_depth]);
+}
+
+void EncoderJSONStream::member(const char* key) {
+    if (m_depth == m_level && m_level != 0) {
+        if (m_member_count < kMaxMembers) {
+            m_members[m_member_count++] = static_cast<uint32_t>(m_size);
+        } else {
+            MA_LOGW(TAG, "too many members, %s can't be checked or removed", key);
+        }
+    }
+    separate();
+    putString(key);
+    put(':');
+}
+
+template <typename T>
+void EncoderJSONStream::element(T value) {
+    separate();
+    number(value);
+}
+
+template <typename T>
+void EncoderJSONStream::item(const char* name, T value) {
+    member(name);
+    number(value);
+}
+
+void EncoderJSONStream::item(const char* name, const char* value) {
+    // cJSON drops members created from a null string
+    if (value == nullptr) {
+        return;
+    }
+    member(name);
+    putString(value);
+}
+
+void EncoderJSONStream::item(const char* name, bool value) {
+    member(name);
+    if (value) {
+        put("true", 4);
+    } else {
+        put("false", 5);
+    }
+}
+
+ma_err_t EncoderJSONStream::status() const {
+    if (!m_begun || m_level == 0 || m_depth != m_level) [[unlikely]] {
+        return MA_EPERM;
+    }
+    return m_overflow ? MA_ENOMEM : MA_OK;
+}
+
+int EncoderJSONStream::find(const char* key) const {
+    size_t length = std::strlen(key);
+    for (size_t i = 0; i < m_member_count; ++i) {
+        const char* p = m_buffer + m_members[i];
+        if (*p == ',') {
+            ++p;
+        }
+        // member keys are compared like cJSON_GetObjectItem, case insensitive
+        if (p + length + 2 <= m_buffer + m_size && p[0] == '"' && p[length + 1] == '"' && strncasecmp(p + 1, key, length) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+ma_err_t EncoderJSONStream::ensure(const char* key) const {
+    ma_err_t ret = status();
+    if (ret != MA_OK) [[unlikely]] {
+        return ret;
+    }
+    return find(key) < 0 ? MA_OK : MA_EEXIST;
+}
+
+ma_err_t EncoderJSONStream::header(ma_msg_type_t type, ma_err_t code, const std::string& name) {
+    put('\r');  // prefix
+    open('{');
+    item("type", static_cast<int>(type));
+    member("name");
+    putString(name.c_str());
+    item("code", static_cast<int>(code));
+    member("data");
+    return m_overflow ? MA_ENOMEM : MA_OK;
+}
+
+ma_err_t EncoderJSONStream::begin() {
+    reset();
+    put('\r');
+    open('{');
+    m_level = m_depth;
+    if (m_overflow) [[unlikely]] {
+        reset();
+        return MA_ENOMEM;
+    }
+    m_begun = true;
+    return MA_OK;
+}
+
+ma_err_t EncoderJSONStream::begin(ma_msg_type_t type, ma_err_t code, const std::string& name) {
+    reset();
+    header(type, code, name);
+    open('{');
+    m_level = m_depth;
+    if (m_overflow) [[unlikely]] {
+        reset();
+        return MA_ENOMEM;
+    }
+    m_begun = true;
+    return MA_OK;
+}
+
+ma_err_t EncoderJSONStream::begin(ma_msg_type_t type, ma_err_t code, const std::string& name, const std::string& data) {
+    reset();
+    header(type, code, name);
+    putString(data.c_str());
+    if (m_overflow) [[unlikely]] {
+        reset();
+        return MA_ENOMEM;
+    }
+    m_begun = true;
+    return MA_OK;
+}
+
+ma_err_t EncoderJSONStream::begin(ma_msg_type_t type, ma_err_t code, const std::string& name, uint64_t data) {
+    reset();
+    header(type, code, name);
+    number(data);
+    if (m_overflow) [[unlikely]] {
+        reset();
+        return MA_ENOMEM;
+    }
+    m_begun = true;
+    return MA_OK;
+}
+
+ma_err_t EncoderJSONStream::end() {
+    ma_err_t ret = MA_OK;
+    if (!m_begun) [[unlikely]] {
+        ret = MA_EPERM;
+        goto exit;
+    }
+    while (m_depth > 0) {
+        close();
+    }
+    put('\n');  // suffix
+    if (m_overflow) [[unlikely]] {
+        m_size = 0;
+        ret    = MA_ENOMEM;
+    }
+
+exit:
+    return ret;
+}
+
+ma_err_t EncoderJSONStream::reset() {
+    m_size         = 0;
+    m_overflow     = false;
+    m_begun        = false;
+    m_depth        = 0;
+    m_level        = 0;
+    m_member_count = 0;
+    return MA_OK;
+}
+
+const std::string& EncoderJSONStream::toString() const {
+    m_string.assign(m_size != 0 ? m_buffer : "", m_size);
+    return m_string;
+}
+
+const void* EncoderJSONStream::data() const {
+    return m_size != 0 ? m_buffer : "";
+}
+
+const size_t EncoderJSONStream::size() const {
+    return m_size;
+}
+
+ma_err_t EncoderJSONStream::remove(const std::string& key) {
+    if (status() != MA_OK) {
+        return MA_ENOENT;
+    }
+    int index = find(key.c_str());
+    if (index < 0) {
+        return MA_ENOENT;
+    }
+
+    size_t begin = m_members[index];
+    size_t end   = static_cast<size_t>(index) + 1 < m_member_count ? m_members[index + 1] : m_size;
+    // removing the first member, the next one loses its separator
+    if (index == 0 && end < m_size && m_buffer[end] == ',') {
+        ++end;
+    }
+    std::memmove(m_buffer + begin, m_buffer + end, m_size - end);
+    m_size -= end - begin;
+
+    for (size_t i = index + 1; i < m_member_count; ++i) {
+        m_members[i - 1] = m_members[i] - static_cast<uint32_t>(end - begin);
+    }
+    --m_member_count;
+    // its separator went with the old first member, the new first one starts where that one did
+    if (index == 0 && m_member_count != 0) {
+        m_members[0] = static_cast<uint32_t>(begin);
+    }
+    if (m_member_count == 0) {
+        m_first[m_level - 1] = true;
+    }
+    return MA_OK;
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, int8_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, int16_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, int32_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, int64_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, uint8_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, uint16_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, uint32_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, uint64_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, float value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, double value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value);
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, const std::string& value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    item(key.c_str(), value.c_str());
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, ma_model_t value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    member(key.c_str());
+    open('{');
+    item("id", value.id);
+    item("type", static_cast<int>(value.type));
+    item("size", value.size);
+#if MA_USE_FILESYSTEM
+    item("name", static_cast<const char*>(value.name));
+    item("address", static_cast<const char*>(value.addr));
+#else
+
+#if MA_ARCH_64
+    item("name", reinterpret_cast<uint64_t>(value.name));
+    item("address", reinterpret_cast<uint64_t>(value.addr));
+#else
+    item("name", reinterpret_cast<uint32_t>(value.name));
+    item("address", reinterpret_cast<uint32_t>(value.addr));
+#endif
+#endif
+    close();
+
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(ma_perf_t value) {
+    ma_err_t ret = ensure("perf");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("perf");
+    open('[');
+    element(value.preprocess);
+    element(value.inference);
+    element(value.postprocess);
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const ma_perf_ext_t& value) {
+    ma_err_t ret = write(static_cast<const ma_perf_t&>(value));
+    if (ret != MA_OK) {
+        return ret;
+    }
+    ret = ensure("ops");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("ops");
+    open('[');
+    for (const auto& op : value.ops) {
+        separate();
+        open('[');
+        separate();
+        putString(op.tag != nullptr ? op.tag : "");
+        element(op.index);
+        element(op.time);
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const ma_perf_stats_t& value) {
+    static const char* stages[MA_PERF_STAGE_COUNT] = {"capture", "preprocess", "inference", "postprocess", "serialize", "send", "total"};
+
+    ma_err_t ret = ensure("stats");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("stats");
+    open('{');
+    for (size_t i = 0; i < MA_PERF_STAGE_COUNT; ++i) {
+        const auto& stat = value.stages[i];
+        member(stages[i]);
+        open('[');
+        element(stat.count);
+        element(stat.min);
+        element(stat.max);
+        element(stat.mean);
+        element(stat.p50);
+        element(stat.p95);
+        element(stat.p99);
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::forward_list<ma_class_t>& value) {
+    ma_err_t ret = ensure("classes");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("classes");
+    open('[');
+    for (const auto& cls : value) {
+        separate();
+        open('[');
+        element(cls.score);
+        element(cls.target);
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, const std::vector<ma_class_t>& value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    open('[');
+    for (const auto& cls : value) {
+        separate();
+        open('[');
+        element(cls.score);
+        element(cls.target);
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::forward_list<ma_keypoint3f_t>& value) {
+    ma_err_t ret = ensure("keypoints");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("keypoints");
+    open('[');
+    for (const auto& kpt : value) {
+        separate();
+        open('[');
+        // box
+        separate();
+        open('[');
+        element(kpt.box.x);
+        element(kpt.box.y);
+        element(kpt.box.w);
+        element(kpt.box.h);
+        element(kpt.box.score);
+        element(kpt.box.target);
+        close();
+        // pts
+        separate();
+        open('[');
+        for (const auto& pt : kpt.pts) {
+            element(pt.x);
+            element(pt.y);
+            element(pt.z);
+        }
+        close();
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const in4_info_t& value) {
+    ma_err_t ret = ensure("in4_info");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("in4_info");
+    open('{');
+    std::string str = value.ip.to_str();
+    item("ip", str.c_str());
+    str = value.netmask.to_str();
+    item("netmask", str.c_str());
+    str = value.gateway.to_str();
+    item("gateway", str.c_str());
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const in6_info_t& value) {
+    ma_err_t ret = ensure("in6_info");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("in6_info");
+    open('{');
+    std::string str = value.ip.to_str();
+    item("ip", str.c_str());
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const ma_wifi_config_t& value, int* stat) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    const char* name = value.ssid[0] != '\0' ? value.ssid : value.bssid;
+
+    if (stat) {
+        member("config");
+        open('{');
+    }
+    item("name", name);
+    item("security", value.security);
+    item("password", value.password);
+    if (stat) {
+        close();
+        item("status", *stat);
+    }
+
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(int algo_id, int cat, int input_from, int tscore, int tiou) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    member("algorithm");
+    open('{');
+    item("type", algo_id);
+    item("category", cat);
+    item("input_from", input_from);
+    member("config");
+    open('{');
+    item("tscore", tscore);
+    item("tiou", tiou);
+    close();
+    close();
+
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::forward_list<ma_point_t>& value) {
+    ma_err_t ret = ensure("points");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("points");
+    open('[');
+    for (const auto& pt : value) {
+        separate();
+        open('[');
+        element(pt.x);
+        element(pt.y);
+        element(pt.score);
+        element(pt.target);
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::forward_list<ma_bbox_t>& value) {
+    ma_err_t ret = ensure("boxes");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("boxes");
+    open('[');
+    for (const auto& box : value) {
+        separate();
+        open('[');
+        element(box.x);
+        element(box.y);
+        element(box.w);
+        element(box.h);
+        element(box.score);
+        element(box.target);
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::vector<ma_bbox_t>& value, const std::vector<int32_t>& ids) {
+    ma_err_t ret = ensure("boxes");
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("boxes");
+    open('[');
+    for (size_t i = 0; i < value.size(); i++) {
+        const auto& box = value[i];
+        separate();
+        open('[');
+        element(box.x);
+        element(box.y);
+        element(box.w);
+        element(box.h);
+        element(box.score);
+        element(box.target);
+        element(i < ids.size() ? ids[i] : static_cast<int32_t>(-1));
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, const std::vector<int32_t>& value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    open('[');
+    for (const auto& v : value) {
+        element(v);
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, const std::vector<ma_zone_t>& value) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    open('[');
+    for (const auto& zone : value) {
+        separate();
+        open('{');
+        item("name", zone.name);
+        item("type", static_cast<int>(zone.type));
+        item("in", zone.in);
+        item("out", zone.out);
+        item("occupancy", zone.occupancy);
+        item("dwell", zone.dwell);
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::vector<ma_model_t>& value) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("models");
+    open('[');
+    for (const auto& model : value) {
+        separate();
+        open('{');
+        item("id", model.id);
+        item("type", static_cast<int>(model.type));
+        item("size", model.size);
+#if MA_USE_FILESYSTEM
+        item("name", static_cast<const char*>(model.name));
+        item("address", static_cast<const char*>(model.addr));
+#else
+#ifdef MA_ARCH_64
+        item("name", reinterpret_cast<uint64_t>(model.name));
+        item("address", reinterpret_cast<uint64_t>(model.addr));
+#else
+        item("name", reinterpret_cast<uint32_t>(model.name));
+        item("address", reinterpret_cast<uint32_t>(model.addr));
+#endif
+#endif
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::vector<ma::Sensor*>& value) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("sensors");
+    open('[');
+    for (const auto* sensor : value) {
+        separate();
+        open('{');
+        item("id", sensor->getID());
+        const auto& type = ma::Sensor::__repr__(sensor->getType());
+        item("type", type.c_str());
+        item("initialized", static_cast<bool>(*sensor));
+        member("presets");
+        open('[');
+        size_t j = 0;
+        for (const auto& preset : sensor->availablePresets()) {
+            separate();
+            open('{');
+            item("id", j++);
+            item("description", preset.description);
+            close();
+        }
+        close();
+        item("current_preset_index", sensor->currentPresetIdx());
+        close();
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const std::string& key, const char* buffer, size_t size) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    if (buffer == nullptr) {
+        put("\"\"", 2);
+    } else {
+        // the buffer is printed as a C string, stop at the terminator like cJSON does
+        const void* terminator = std::memchr(buffer, '\0', size);
+        putString(buffer, terminator != nullptr ? static_cast<const char*>(terminator) - buffer : size);
+    }
+    return status();
+}
+
+ma_err_t EncoderJSONStream::writeBinary(const std::string& key, const void* data, size_t size) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    put('"');
+    // base64 needs no escaping, it is encoded at its final position in the message
+    int length = ma::utils::base64_encoded_size(size);
+    if (reserve(length)) [[likely]] {
+        ma::utils::base64_encode(static_cast<const unsigned char*>(data), size, m_buffer + m_size, &length);
+        m_size += length;
+    }
+    put('"');
+    return status();
+}
+
+ma_err_t EncoderJSONStream::writeMessages(const std::string& key, const std::vector<std::string>& messages) {
+    ma_err_t ret = ensure(key.c_str());
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member(key.c_str());
+    open('[');
+    for (const auto& message : messages) {
+        separate();
+        // copied as is without the \r prefix and \n suffix, they are objects made by this codec
+        size_t begin = message.find('{');
+        size_t end   = message.rfind('}');
+        if (begin == std::string::npos || end == std::string::npos || end < begin) {
+            put("null", 4);
+            continue;
+        }
+        put(message.data() + begin, end - begin + 1);
+    }
+    close();
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const Sensor* value, size_t preset) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+    member("sensors");
+    open('[');
+    if (value == nullptr) {
+        close();
+        return MA_FAILED;
+    }
+
+    separate();
+    open('{');
+    item("id", value->getID());
+    const auto& type = ma::Sensor::__repr__(value->getType());
+    item("type", type.c_str());
+    item("initialized", static_cast<bool>(*value));
+    size_t j = 0;
+    for (const auto& p : value->availablePresets()) {
+        if (j == preset) {
+            member("current_preset");
+            open('{');
+            item("id", j);
+            item("description", p.description);
+            close();
+        }
+        ++j;
+    }
+    close();
+    close();
+
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const ma_mqtt_config_t& value, int* stat) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    if (stat) {
+        member("config");
+        open('{');
+    }
+    item("address", value.host);
+    item("port", value.port);
+    item("username", value.username);
+    item("password", value.password);
+    item("client_id", value.client_id);
+    item("use_ssl", static_cast<int>(value.use_ssl));
+    if (stat) {
+        close();
+        item("status", *stat);
+    }
+
+    return status();
+}
+
+ma_err_t EncoderJSONStream::write(const ma_mqtt_topic_config_t& value) {
+    ma_err_t ret = status();
+    if (ret != MA_OK) {
+        return ret;
+    }
+
+    member("config");
+    open('{');
+    item("pub_topic", value.pub_topic);
+    item("pub_qos", static_cast<int>(value.pub_qos));
+    item("sub_topic", value.sub_topic);
+    item("sub_qos", static_cast<int>(value.sub_qos));
+    close();
+
+    return status();
+}
+
+}  // namespace ma
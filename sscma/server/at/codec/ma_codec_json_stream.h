@@ -0,0 +1,156 @@
+#ifndef _MA_CODEC_JSON_STREAM_H_
+#define _MA_CODEC_JSON_STREAM_H_
+
+#include "core/ma_common.h"
+#include "porting/ma_osal.h"
+
+#include "ma_codec_base.h"
+
+namespace ma {
+
+/*!
+ * @brief JSON encoder that writes the message text directly into a reusable buffer.
+ *
+ * Produces the same bytes as EncoderJSON (including its number formatting) without
+ * building a cJSON tree. The buffer is either owned and grown on demand, keeping its
+ * capacity across messages, or provided by the caller with a fixed size, in which case
+ * a message that does not fit fails with MA_ENOMEM.
+ *
+ * Holds no lock, an instance belongs to a single thread (see ATSession).
+ */
+class EncoderJSONStream final : public Encoder {
+
+public:
+    EncoderJSONStream();
+    /*!
+     * @brief Encoder writing into a caller provided buffer, never allocates.
+     *
+     * @param[in] buffer buffer that outlives the encoder
+     * @param[in] size size of the buffer in bytes
+     */
+    EncoderJSONStream(char* buffer, size_t size);
+    ~EncoderJSONStream();
+
+    operator bool() const override;
+
+    ma_codec_type_t getType() const override;
+
+    ma_err_t begin() override;
+    ma_err_t begin(ma_msg_type_t type, ma_err_t code, const std::string& name) override;
+    ma_err_t begin(ma_msg_type_t type, ma_err_t code, const std::string& name, const std::string& data) override;
+    ma_err_t begin(ma_msg_type_t type, ma_err_t code, const std::string& name, uint64_t data) override;
+    ma_err_t end() override;
+    ma_err_t reset() override;
+
+    ma_err_t remove(const std::string& key) override;
+
+    ma_err_t write(const std::string& key, const char* buffer, size_t size) override;
+    ma_err_t writeBinary(const std::string& key, const void* data, size_t size) override;
+    ma_err_t writeMessages(const std::string& key, const std::vector<std::string>& messages) override;
+
+
+    ma_err_t write(const std::string& key, int8_t value) override;
+    ma_err_t write(const std::string& key, int16_t value) override;
+    ma_err_t write(const std::string& key, int32_t value) override;
+    ma_err_t write(const std::string& key, int64_t value) override;
+    ma_err_t write(const std::string& key, uint8_t value) override;
+    ma_err_t write(const std::string& key, uint16_t value) override;
+    ma_err_t write(const std::string& key, uint32_t value) override;
+    ma_err_t write(const std::string& key, uint64_t value) override;
+    ma_err_t write(const std::string& key, float value) override;
+    ma_err_t write(const std::string& key, double value) override;
+    ma_err_t write(const std::string& key, const std::string& value) override;
+    ma_err_t write(const std::string& key, ma_model_t value) override;
+    ma_err_t write(ma_perf_t value) override;
+    ma_err_t write(const ma_perf_ext_t& value) override;
+    ma_err_t write(const ma_perf_stats_t& value) override;
+
+    ma_err_t write(const std::forward_list<ma_class_t>& value) override;
+    ma_err_t write(const std::string& key, const std::vector<ma_class_t>& value) override;
+    ma_err_t write(const std::forward_list<ma_point_t>& value) override;
+    ma_err_t write(const std::forward_list<ma_bbox_t>& value) override;
+    ma_err_t write(const std::vector<ma_bbox_t>& value, const std::vector<int32_t>& ids) override;
+    ma_err_t write(const std::string& key, const std::vector<int32_t>& value) override;
+    ma_err_t write(const std::string& key, const std::vector<ma_zone_t>& value) override;
+    ma_err_t write(const std::forward_list<ma_keypoint3f_t>& value) override;
+
+    ma_err_t write(const std::vector<ma_model_t>& value) override;
+
+
+    ma_err_t write(const std::vector<Sensor*>& value) override;
+    ma_err_t write(const Sensor* value, size_t preset) override;
+
+
+    ma_err_t write(const in4_info_t& value) override;
+    ma_err_t write(const in6_info_t& value) override;
+    ma_err_t write(const ma_wifi_config_t& value, int* stat = nullptr) override;
+
+    ma_err_t write(const ma_mqtt_config_t& value, int* stat = nullptr) override;
+
+    ma_err_t write(const ma_mqtt_topic_config_t& value) override;
+
+
+    ma_err_t write(int algo_id, int cat, int input_from, int tscore, int tiou) override;
+
+
+    // copies the message, prefer data() and size()
+    const std::string& toString() const override;
+    const void* data() const override;
+    const size_t size() const override;
+
+private:
+    static constexpr size_t kMaxDepth   = 8;
+    static constexpr size_t kMaxMembers = 32;
+
+    bool reserve(size_t size);
+    void put(char c);
+    void put(const char* str, size_t size);
+    void putString(const char* str, size_t size);
+    void putString(const char* str);
+    void putNumber(double value);
+    void putInt(int64_t value);
+    void putUint(uint64_t value);
+
+    void separate();
+    void open(char c);
+    void close();
+    void member(const char* key);
+
+    template <typename T>
+    void number(T value);
+    template <typename T>
+    void element(T value);
+    template <typename T>
+    void item(const char* name, T value);
+    void item(const char* name, const char* value);
+    void item(const char* name, bool value);
+
+    ma_err_t header(ma_msg_type_t type, ma_err_t code, const std::string& name);
+    ma_err_t ensure(const char* key) const;
+    int find(const char* key) const;
+    ma_err_t status() const;
+
+    char* m_buffer;
+    size_t m_capacity;
+    size_t m_size;
+    bool m_static;
+    bool m_overflow;
+    bool m_begun;
+
+    // container nesting, m_level is the depth of the data object (0 when data is a scalar)
+    bool m_first[kMaxDepth];
+    char m_closer[kMaxDepth];
+    size_t m_depth;
+    size_t m_level;
+
+    // start offsets of the members of the data object, for duplicate checks and remove()
+    uint32_t m_members[kMaxMembers];
+    size_t m_member_count;
+
+    std::string m_storage;
+    mutable std::string m_string;
+};
+
+}  // namespace ma
+
+#endif  // _MA_CODEC_JSON_STREAM_H_
@@ -0,0 +1,168 @@
+#include "ma_event_queue.h"
+
+namespace ma {
+
+static const char* TAG = "ma::server::EventQueue";
+
+EventQueue::EventQueue(Transport& transport, ma_event_policy_t policy, size_t depth)
+    : m_transport(transport), m_policy(MA_EVENT_POLICY_DROP_OLDEST), m_depth(MA_EVENT_QUEUE_DEPTH), m_bytes(0), m_lock(false), m_ready(0), m_space(0), m_thread(nullptr), m_sent(0), m_dropped(0), m_coalesced(0) {
+    configure(policy, depth);
+
+    m_thread = new Thread("ma_event_queue", &EventQueue::threadEntry, this, MA_EVENT_QUEUE_TASK_PRIO, MA_EVENT_QUEUE_STACK_SIZE);
+    MA_ASSERT(m_thread);
+    if (!m_thread->start(this)) {
+        MA_LOGE(TAG, "failed to start the sender thread");
+        delete m_thread;
+        m_thread = nullptr;
+    }
+}
+
+EventQueue::~EventQueue() {
+    if (m_thread) {
+        m_thread->stop();
+        delete m_thread;
+    }
+}
+
+ma_err_t EventQueue::configure(ma_event_policy_t policy, size_t depth) {
+    if (policy < 0 || policy >= __MA_EVENT_POLICY_END || depth == 0 || depth > MA_EVENT_QUEUE_MAX_DEPTH) {
+        return MA_EINVAL;
+    }
+
+    const Guard guard(m_lock);
+    m_policy = policy;
+    m_depth  = depth;
+    // a shallower queue keeps the newest entries
+    while (m_pending.size() > m_depth) {
+        m_bytes -= m_pending.front().size();
+        m_pending.pop_front();
+        ++m_dropped;
+    }
+    return MA_OK;
+}
+
+ma_event_policy_t EventQueue::policy() const {
+    return m_policy;
+}
+
+size_t EventQueue::depth() const {
+    return m_depth;
+}
+
+size_t EventQueue::pending() const {
+    const Guard guard(m_lock);
+    return m_pending.size();
+}
+
+bool EventQueue::congested() const {
+    const Guard guard(m_lock);
+    return full(0);
+}
+
+// with the lock held, whether an entry of size bytes has to wait for the pending ones
+bool EventQueue::full(size_t size) const {
+    return !m_pending.empty() && (m_pending.size() >= m_depth || m_bytes + size > MA_EVENT_QUEUE_MAX_BYTES);
+}
+
+ma_err_t EventQueue::push(const ma_iovec_t* iov, size_t iovcnt) {
+    if (m_thread == nullptr) [[unlikely]] {
+        return MA_EPERM;
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < iovcnt; ++i) {
+        size += iov[i].len;
+    }
+
+    // copied outside of the lock, the sender keeps running meanwhile
+    std::string entry;
+    entry.reserve(size);
+    for (size_t i = 0; i < iovcnt; ++i) {
+        entry.append(static_cast<const char*>(iov[i].base), iov[i].len);
+    }
+
+    m_lock.lock();
+    while (full(size)) {
+        switch (m_policy) {
+            case MA_EVENT_POLICY_BLOCK:
+                m_lock.unlock();
+                m_space.wait();
+                m_lock.lock();
+                continue;
+            case MA_EVENT_POLICY_DROP_OLDEST:
+                m_bytes -= m_pending.front().size();
+                m_pending.pop_front();
+                ++m_dropped;
+                continue;
+            case MA_EVENT_POLICY_DROP_NEWEST:
+                m_lock.unlock();
+                ++m_dropped;
+                return MA_EBUSY;
+            case MA_EVENT_POLICY_COALESCE:
+                m_coalesced += static_cast<uint32_t>(m_pending.size());
+                m_pending.clear();
+                m_bytes = 0;
+                continue;
+            default:
+                break;
+        }
+        break;
+    }
+    m_bytes += size;
+    m_pending.push_back(std::move(entry));
+    m_lock.unlock();
+
+    m_ready.signal();
+    return MA_OK;
+}
+
+void EventQueue::drop() {
+    if (m_policy == MA_EVENT_POLICY_COALESCE) {
+        ++m_coalesced;
+    } else {
+        ++m_dropped;
+    }
+}
+
+uint32_t EventQueue::sent() const {
+    return m_sent.load();
+}
+
+uint32_t EventQueue::dropped() const {
+    return m_dropped.load();
+}
+
+uint32_t EventQueue::coalesced() const {
+    return m_coalesced.load();
+}
+
+void EventQueue::threadEntry(void* arg) {
+    static_cast<EventQueue*>(arg)->run();
+}
+
+void EventQueue::run() {
+    std::string entry;
+    while (true) {
+        m_ready.wait();
+        while (true) {
+            m_lock.lock();
+            if (m_pending.empty()) {
+                m_lock.unlock();
+                break;
+            }
+            entry = std::move(m_pending.front());
+            m_pending.pop_front();
+            m_bytes -= entry.size();
+            m_lock.unlock();
+            m_space.signal();
+
+            // one call per entry, like the replies sent directly
+            if (m_transport.send(entry.data(), entry.size()) != entry.size()) {
+                MA_LOGW(TAG, "short send of %zu bytes", entry.size());
+            }
+            ++m_sent;
+        }
+    }
+}
+
+}  // namespace ma
@@ -0,0 +1,110 @@
+#ifndef _MA_EVENT_QUEUE_H_
+#define _MA_EVENT_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "core/ma_common.h"
+#include "porting/ma_osal.h"
+#include "porting/ma_transport.h"
+
+#ifndef MA_EVENT_QUEUE_STACK_SIZE
+    #define MA_EVENT_QUEUE_STACK_SIZE 4 * 1024
+#endif
+
+#ifndef MA_EVENT_QUEUE_TASK_PRIO
+    #define MA_EVENT_QUEUE_TASK_PRIO 2
+#endif
+
+#ifndef MA_EVENT_QUEUE_DEPTH
+    #define MA_EVENT_QUEUE_DEPTH 2
+#endif
+
+#ifndef MA_EVENT_QUEUE_MAX_DEPTH
+    #define MA_EVENT_QUEUE_MAX_DEPTH 8
+#endif
+
+// bytes the pending entries may hold, an entry larger than that is still queued alone
+#ifndef MA_EVENT_QUEUE_MAX_BYTES
+    #define MA_EVENT_QUEUE_MAX_BYTES 128 * 1024
+#endif
+
+namespace ma {
+
+// what an event queue does with a new event while it is full
+typedef enum {
+    MA_EVENT_POLICY_BLOCK       = 0,  // wait for the transport, like sending directly
+    MA_EVENT_POLICY_DROP_OLDEST = 1,  // discard the oldest pending event
+    MA_EVENT_POLICY_DROP_NEWEST = 2,  // discard the new event
+    MA_EVENT_POLICY_COALESCE    = 3,  // replace every pending event with the new one, sent without its image
+    __MA_EVENT_POLICY_END
+} ma_event_policy_t;
+
+/*!
+ * @brief Bounded queue of outbound events of one transport, sent by its own thread so the
+ * producer (capture and inference) keeps running at its rate when the transport is slower.
+ *
+ * Each entry is copied into a single buffer and sent with one send() call, so an event and
+ * the binary image frame that follows it are kept or dropped together. The queue is full at
+ * its depth or at MA_EVENT_QUEUE_MAX_BYTES pending, whichever comes first.
+ */
+class EventQueue {
+public:
+    EventQueue(Transport& transport, ma_event_policy_t policy = MA_EVENT_POLICY_DROP_OLDEST, size_t depth = MA_EVENT_QUEUE_DEPTH);
+    ~EventQueue();
+
+    ma_err_t configure(ma_event_policy_t policy, size_t depth);
+
+    ma_event_policy_t policy() const;
+    size_t depth() const;
+    size_t pending() const;
+
+    // true when the queue is full, the next event would not be queued as is, producers may skip or shrink it
+    bool congested() const;
+
+    /*!
+     * @brief Queue the parts of an event as one entry, applying the policy when full.
+     *
+     * @param[in] iov parts of the entry, copied before returning
+     * @param[in] iovcnt number of parts
+     * @retval MA_OK queued, MA_EBUSY dropped by the policy
+     */
+    ma_err_t push(const ma_iovec_t* iov, size_t iovcnt);
+
+    // accounts an event the producer dropped itself after congested() returned true
+    void drop();
+
+    uint32_t sent() const;
+    uint32_t dropped() const;
+    uint32_t coalesced() const;
+
+private:
+    EventQueue(const EventQueue&)            = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    static void threadEntry(void* arg);
+    void run();
+    bool full(size_t size) const;
+
+    Transport& m_transport;
+    ma_event_policy_t m_policy;
+    size_t m_depth;
+
+    std::deque<std::string> m_pending;
+    size_t m_bytes;
+    Mutex m_lock;
+    Semaphore m_ready;  // signaled on each push
+    Semaphore m_space;  // signaled on each send, for the blocking policy
+    Thread* m_thread;
+
+    std::atomic<uint32_t> m_sent;
+    std::atomic<uint32_t> m_dropped;
+    std::atomic<uint32_t> m_coalesced;
+};
+
+}  // namespace ma
+
+#endif  // _MA_EVENT_QUEUE_H_
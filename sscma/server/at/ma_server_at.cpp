@@ -4,19 +4,31 @@
 #include <cctype>
 #include <cstddef>
 #include <cstring>
-#include <stack>
 
 #include "callback/algorithm.hpp"
+#include "callback/batch.hpp"
+#include "callback/cascade.hpp"
+#include "callback/codec.hpp"
 #include "callback/common.hpp"
 #include "callback/config.hpp"
+#include "callback/delta.hpp"
+#include "callback/event.hpp"
+#include "callback/filter.hpp"
+#include "callback/image.hpp"
 #include "callback/info.hpp"
 #include "callback/invoke.hpp"
 #include "callback/model.hpp"
+#include "callback/motion.hpp"
 #include "callback/mqtt.hpp"
+#include "callback/perf.hpp"
+#include "callback/profile.hpp"
 #include "callback/rc.hpp"
 #include "callback/resource.hpp"
+#include "callback/roi.hpp"
 #include "callback/sample.hpp"
 #include "callback/sensor.hpp"
+#include "callback/tile.hpp"
+#include "callback/track.hpp"
 #include "callback/wifi.hpp"
 #include "callback/trigger.hpp"
 
@@ -31,17 +43,46 @@ ATService::ATService(const std::string& name, const std::string& desc, const std
     argc = args.empty() ? 0 : std::count(args.begin(), args.end(), ',') + 1;
 }
 
+ATService::ATService(const std::string& name, const std::string& desc, const std::string& args, ATServiceViewCallback cb) : name(name), desc(desc), args(args), view_cb(cb) {
+    argc = args.empty() ? 0 : std::count(args.begin(), args.end(), ',') + 1;
+}
+
+uint32_t ATService::hash(std::string_view name) {
+    uint32_t h = 2166136261u;
+    for (char c : name) {
+        h ^= static_cast<uint8_t>(std::toupper(static_cast<unsigned char>(c)));
+        h *= 16777619u;
+    }
+    return h;
+}
+
 ma_err_t ATServer::addService(ATService& service) {
-    for (auto it = m_services.begin(); it != m_services.end(); ++it) {
-        if (it->name == service.name) {
-            return MA_EEXIST;
-        }
+    if (findService(service.name) != nullptr) {
+        return MA_EEXIST;
     }
     m_services.push_front(service);
 
+    const ATService* added = &m_services.front();
+    uint32_t hash          = ATService::hash(added->name);
+    auto it = std::upper_bound(m_dispatch.begin(), m_dispatch.end(), hash, [](uint32_t h, const std::pair<uint32_t, const ATService*>& e) { return h < e.first; });
+    m_dispatch.emplace(it, hash, added);
+
     return MA_OK;
 }
 
+const ATService* ATServer::findService(std::string_view name) const {
+    uint32_t hash = ATService::hash(name);
+    auto it = std::lower_bound(m_dispatch.begin(), m_dispatch.end(), hash, [](const std::pair<uint32_t, const ATService*>& e, uint32_t h) { return e.first < h; });
+    for (; it != m_dispatch.end() && it->first == hash; ++it) {
+        const std::string& candidate = it->second->name;
+        if (candidate.size() == name.size() &&
+            std::equal(candidate.begin(), candidate.end(), name.begin(), [](char a, char b) { return std::toupper(static_cast<unsigned char>(a)) == std::toupper(static_cast<unsigned char>(b)); })) {
+            return it->second;
+        }
+    }
+    return nullptr;
+}
+
 ATServer::ATServer(Encoder* encoder) : m_encoder(*encoder) {
     m_thread = new Thread("ATServer", ATServer::threadEntryStub, this, MA_SEVER_AT_EXECUTOR_TASK_PRIO, MA_SEVER_AT_EXECUTOR_STACK_SIZE);
     MA_ASSERT(m_thread);
@@ -70,9 +111,11 @@ void ATServer::threadEntry() {
         }
 
         if (transport) {
+            transport = &getSession(*transport).link;
             initDefaultSensor(transport, m_encoder);
             initDefaultModel(transport, m_encoder);
             initDefaultAlgorithm(transport, m_encoder);
+            initDefaultCascade(transport, m_encoder);
             initDefaultTrigger(transport, m_encoder);
             initDefaultRC(
                 transport,
@@ -89,12 +132,12 @@ void ATServer::threadEntry() {
             if (transport && *transport) {
                 int len = transport->receiveIf(buf, MA_SEVER_AT_CMD_MAX_LENGTH, 0x0D);
                 if (len > 1) {
-                    execute(buf, transport);
+                    execute(buf, len, *transport);
                     std::memset(buf, 0, MA_SEVER_AT_CMD_MAX_LENGTH + 1);
                 }
                 len = transport->receiveIf(buf, MA_SEVER_AT_CMD_MAX_LENGTH, 0x0A);
                 if (len > 1) {
-                    execute(buf, transport);
+                    execute(buf, len, *transport);
                     std::memset(buf, 0, MA_SEVER_AT_CMD_MAX_LENGTH + 1);
                 }
             }
@@ -106,23 +149,24 @@ void ATServer::threadEntry() {
 
 ma_err_t ATServer::init() {
 
-    this->addService("ID?", "Get device ID", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
-        static_resource->executor->submit([cmd = std::move(args[0]), &transport, &encoder](const std::atomic<bool>&) { get_device_id(cmd, transport, encoder); });
+    // read only queries reply in place with the server thread encoder, without waiting for the executor
+    this->addService("ID?", "Get device ID", "", [this](const std::vector<std::string_view>& args, Transport& transport, Encoder&) {
+        get_device_id(std::string(args[0]), transport, getDirectEncoder(transport));
         return MA_OK;
     });
 
-    this->addService("NAME?", "Get device name", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
-        static_resource->executor->submit([cmd = std::move(args[0]), &transport, &encoder](const std::atomic<bool>&) { get_device_name(cmd, transport, encoder); });
+    this->addService("NAME?", "Get device name", "", [this](const std::vector<std::string_view>& args, Transport& transport, Encoder&) {
+        get_device_name(std::string(args[0]), transport, getDirectEncoder(transport));
         return MA_OK;
     });
 
-    this->addService("STAT?", "Get device status", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
-        static_resource->executor->submit([cmd = std::move(args[0]), &transport, &encoder](const std::atomic<bool>&) { get_device_status(cmd, transport, encoder); });
+    this->addService("STAT?", "Get device status", "", [this](const std::vector<std::string_view>& args, Transport& transport, Encoder&) {
+        get_device_status(std::string(args[0]), transport, getDirectEncoder(transport));
         return MA_OK;
     });
 
-    this->addService("VER?", "Get device version", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
-        static_resource->executor->submit([cmd = std::move(args[0]), &transport, &encoder](const std::atomic<bool>&) { get_version(cmd, transport, encoder, MA_AT_API_VERSION); });
+    this->addService("VER?", "Get device version", "", [this](const std::vector<std::string_view>& args, Transport& transport, Encoder&) {
+        get_version(std::string(args[0]), transport, getDirectEncoder(transport), MA_AT_API_VERSION);
         return MA_OK;
     });
 
@@ -239,6 +283,35 @@ ma_err_t ATServer::init() {
         return MA_OK;
     });
 
+    addService("IMAGE", "Set image transfer mode of current transport", "MODE", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureImageMode(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("IMAGE?", "Get image transfer mode of current transport", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getImageMode(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("EVENTQ", "Set outbound event queue of current transport", "POLICY,DEPTH", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureEventQueue(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("EVENTQ?", "Get outbound event queue of current transport", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getEventQueue(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("BATCH", "Execute commands separated by ';' as one task with one reply", "COMMANDS", [this](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        batchCommands(
+            args,
+            transport,
+            encoder,
+            [this](std::string line, Transport& transport) { return execute(std::move(line), transport); });
+        return MA_OK;
+    });
+
     addService("INVOKE", "Invoke model", "N_TIMES,RESULTS_ONLY", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
         static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) {
             static_resource->current_task_id += 1;
@@ -247,6 +320,43 @@ ma_err_t ATServer::init() {
         return MA_OK;
     });
 
+    addService("PROFILE", "Profile model operators", "N_TIMES", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) {
+            static_resource->current_task_id += 1;
+            Profile::create(args, transport, encoder, static_resource->current_task_id)->run();
+        });
+        return MA_OK;
+    });
+
+    addService("PERF", "Reset perf statistics", "EVENT", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) {
+            configurePerfStats(args, transport, encoder);
+        });
+        return MA_OK;
+    });
+
+    addService("PERF?", "Get perf statistics", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) {
+            getPerfStats(args, transport, encoder);
+        });
+        return MA_OK;
+    });
+
+    addService("CASCADE", "Set cascade classifier model", "MODEL_ID", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) {
+            static_resource->current_task_id += 1;
+            configureCascade(args, transport, encoder);
+        });
+        return MA_OK;
+    });
+
+    addService("CASCADE?", "Get cascade classifier model", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) {
+            getCascade(args, transport, encoder);
+        });
+        return MA_OK;
+    });
+
     addService("ALGO", "Set algorithm type", "ALGO_ID", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
         static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureAlgorithm(args, transport, encoder); });
         return MA_OK;
@@ -277,6 +387,107 @@ ma_err_t ATServer::init() {
         return MA_OK;
     });
 
+    addService("DELTA?", "Get change-only INVOKE event config", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getDelta(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("DELTA", "Set change-only INVOKE event config", "ENABLE,IOU,SCORE,COUNT,KEEPALIVE", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureDelta(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("FILTER?", "Get INVOKE result filter config", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getFilter(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("FILTER", "Set INVOKE result filter config", "ENABLE,ALPHA,RISE,FALL,IOU", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureFilter(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("MOTION?", "Get INVOKE motion gate config", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getMotion(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("MOTION", "Set INVOKE motion gate config", "ENABLE,THRESHOLD,INTERVAL", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureMotion(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("TRACK?", "Get INVOKE tracking config", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getTrack(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("TRACK", "Set INVOKE tracking config", "ENABLE,BUFFER,THRESH,MATCH", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureTrack(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("TRACKSKIP?", "Get INVOKE detect interval of tracking", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getTrackSkip(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("TRACKSKIP", "Set INVOKE detect interval of tracking", "INTERVAL,UNCERTAINTY", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureTrackSkip(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("COUNTER?", "Get tracked line crossing counter config", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getCounter(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("COUNTER", "Set tracked line crossing counter config", "ENABLE,X0,Y0,X1,Y1", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureCounter(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("ZONE?", "Get named counter lines and zones", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getZone(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("ZONE", "Set a named counter line or zone", "NAME,POINTS", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureZone(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("TILE?", "Get tiled inference config", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getTile(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("TILE", "Set tiled inference config", "ENABLE,OVERLAP", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureTile(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("ROI?", "Get regions of interest", "", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { getRoi(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    addService("ROI", "Set regions of interest", "ROIS", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
+        static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureRoi(args, transport, encoder); });
+        return MA_OK;
+    });
+
+    // run in place with the server thread encoder, the codec must be switched before the next command of the transport is parsed
+    addService("CODEC", "Set codec of current transport", "TYPE", [this](std::vector<std::string> args, Transport& transport, Encoder&) {
+        configureCodec(args, transport, getDirectEncoder(transport), [this, &transport](ma_codec_type_t type) { return setCodec(transport, type); });
+        return MA_OK;
+    });
+
+    addService("CODEC?", "Get codec of current transport", "", [this](std::vector<std::string> args, Transport& transport, Encoder&) {
+        getCodec(args, transport, getDirectEncoder(transport));
+        return MA_OK;
+    });
+
     addService("WIFI", "Configure Wi-Fi", "NAME,SECURITY,PASSWORD", [](std::vector<std::string> args, Transport& transport, Encoder& encoder) {
         static_resource->executor->submit([args = std::move(args), &transport, &encoder](const std::atomic<bool>&) { configureWifi(args, transport, encoder); });
         return MA_OK;
@@ -410,93 +621,142 @@ ma_err_t ATServer::addService(const std::string& name, const std::string& desc,
     return addService(service);
 }
 
-ma_err_t ATServer::execute(std::string line, Transport& transport) {
-    ma_err_t ret = MA_OK;
-    std::string name;
-    std::string args;
-
-    line.erase(std::remove_if(line.begin(), line.end(), [](char c) { return !std::isprint(c); }), line.end());
-
-    // find first '=' in AT command (<name>=<args>)
-    size_t pos = line.find_first_of("=");
-    if (pos != std::string::npos) {
-        name = line.substr(0, pos);
-        args = line.substr(pos + 1, line.size());
-    } else {
-        name = line;
+ma_err_t ATServer::addService(const std::string& name, const std::string& desc, const std::string& args, ATServiceViewCallback cb) {
+    ATService service(name, desc, args, cb);
+    return addService(service);
+}
+
+ATSession::ATSession(Transport& transport) : link(transport) {}
+
+Encoder& ATSession::encoder() {
+    if (codec == MA_CODEC_CBOR) {
+        return cbor;
+    }
+    return json;
+}
+
+ATSession& ATServer::getSession(Transport& transport) {
+    // the commands of a batch share the session of the transport it runs for
+    Transport& origin = transport.underlying();
+    auto link         = m_links.find(&origin);
+    if (link != m_links.end()) {
+        return *link->second;
+    }
+    // created on the first command of a transport, nodes never move so references stay valid
+    auto [it, created] = m_sessions.try_emplace(&origin, origin);
+    if (created) {
+        m_links.emplace(&it->second.link, &it->second);
+    }
+    return it->second;
+}
+
+Encoder& ATServer::getEncoder(Transport& transport) {
+    return getSession(transport).encoder();
+}
+
+Encoder& ATServer::getDirectEncoder(Transport& transport) {
+    if (getSession(transport).codec == MA_CODEC_CBOR) {
+        return m_encoder_cbor;
+    }
+    return m_encoder;
+}
+
+ma_err_t ATServer::setCodec(Transport& transport, ma_codec_type_t type) {
+    if (type >= __MA_CODEC_END) {
+        return MA_EINVAL;
     }
+    getSession(transport).codec = type;
+    return MA_OK;
+}
+
+// splits the arguments in place, quoted ones are unescaped over themselves and every view points into args
+static void tokenize(char* args, size_t size, size_t argc, std::vector<std::string_view>& argv) {
+    size_t index = 0;
+
+    while (index < size && argv.size() < argc + 1u) {  // while not reach end of args and not enough args
+        char c = args[index];
+        if (c == '\'' || c == '"') [[unlikely]] {  // quoted, up to the same quote, a backslash escapes the next char
+            size_t begin = ++index;
+            size_t out   = begin;
+            while (index < size && args[index] != c) {
+                if (args[index] == '\\' && ++index >= size) [[unlikely]]
+                    break;
+                args[out++] = args[index++];
+            }
+            argv.emplace_back(args + begin, out - begin);
+            ++index;  // skip the closing quote
+        } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {  // a number, up to the first non digit
+            size_t begin = index;
+            while (++index < size && std::isdigit(static_cast<unsigned char>(args[index])))
+                ;
+            argv.emplace_back(args + begin, index - begin);
+        } else
+            ++index;  // if current char is not a quote or a digit, skip it
+    }
+}
 
-    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+ma_err_t ATServer::execute(char* line, size_t size, Transport& origin) {
+    // replies of the command go through the link, whichever thread sends them, or are recorded by a batch
+    ATSession& session   = getSession(origin);
+    Transport& transport = &origin.underlying() != &origin ? origin : session.link;
+    Encoder& encoder     = getDirectEncoder(transport);
+
+    // drop the line endings and any other non-printable character, in place
+    size = std::remove_if(line, line + size, [](char c) { return !std::isprint(static_cast<unsigned char>(c)); }) - line;
+
+    // <name>=<args>, the name is upper cased in place
+    std::string_view view(line, size);
+    size_t pos       = view.find('=');
+    size_t name_size = pos != std::string_view::npos ? pos : size;
+    std::transform(line, line + name_size, line, [](char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
+    std::string_view name = view.substr(0, name_size);
 
     // check if name is valid (starts with "AT+")
-    if (name.rfind("AT+", 0) != 0) {
-        m_encoder.begin(MA_MSG_TYPE_EVT, MA_EINVAL, "AT", "Uknown command: " + name);
-        m_encoder.end();
-        transport.send(reinterpret_cast<const char*>(m_encoder.data()), m_encoder.size());
+    if (name.substr(0, 3) != "AT+") {
+        encoder.begin(MA_MSG_TYPE_EVT, MA_EINVAL, "AT", "Uknown command: " + std::string(name));
+        encoder.end();
+        transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
         return MA_EINVAL;
     }
 
-    name = name.substr(3, name.size());  // remove "AT+" command prefix
+    name.remove_prefix(3);  // remove "AT+" command prefix
 
     // find command MA_TAG (everything after last '@'), then remove the MA_TAG to get the AT command
     // name
-    size_t cmd_body_pos    = name.rfind('@');
-    cmd_body_pos           = cmd_body_pos != std::string::npos ? cmd_body_pos + 1 : 0;
-    std::string target_cmd = name.substr(cmd_body_pos, name.size());
+    size_t cmd_body_pos = name.rfind('@');
+    cmd_body_pos        = cmd_body_pos != std::string_view::npos ? cmd_body_pos + 1 : 0;
 
-    // find command in cmd list
-    auto it = std::find_if(m_services.begin(), m_services.end(), [&](const ATService& c) { return c.name.compare(target_cmd) == 0; });
+    const ATService* service = findService(name.substr(cmd_body_pos));
 
-    if (it == m_services.end()) [[unlikely]] {
-        m_encoder.begin(MA_MSG_TYPE_EVT, MA_EINVAL, "AT", "Uknown command: " + name);
-        m_encoder.end();
-        transport.send(reinterpret_cast<const char*>(m_encoder.data()), m_encoder.size());
+    if (service == nullptr) [[unlikely]] {
+        encoder.begin(MA_MSG_TYPE_EVT, MA_EINVAL, "AT", "Uknown command: " + std::string(name));
+        encoder.end();
+        transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
         return MA_EINVAL;
     }
 
     // split args by ','
-    std::vector<std::string> argv;
-    argv.push_back(name);
-    std::stack<char> stk;
-    size_t index = 0;
-    size_t size  = args.size();
-
-    while (index < size && argv.size() < it->argc + 1u) {  // while not reach end of args and not enough args
-        char c = args.at(index);
-        if (c == '\'' || c == '"') [[unlikely]] {  // if current char is a quote
-            stk.push(c);                           // push the quote to stack
-            std::string arg;
-            while (++index < size && stk.size()) {  // while not reach end of args and stack is not empty
-                c = args.at(index);                 // get next char
-                if (c == stk.top())                 // if the char matches the top of stack, pop the stack
-                    stk.pop();
-                else if (c != '\\') [[likely]]  // if the char is not a backslash, append it to
-                    arg += c;
-                else if (++index < size) [[likely]]  // if the char is a backslash, get next char, append it to arg
-                    arg += args.at(index);
-            }
-            argv.push_back(std::move(arg));
-        } else if (c == '-' || std::isdigit(c)) {  // if current char is a digit or a minus sign
-            size_t prev = index;
-            while (++index < size)  // while not reach end of args
-                if (!std::isdigit(args.at(index)))
-                    break;                                    // if current char is not a digit, break
-            argv.push_back(args.substr(prev, index - prev));  // append the number string to argv
-        } else
-            ++index;  // if current char is not a quote or a digit, skip it
+    m_argv.clear();
+    m_argv.push_back(name);
+    if (pos != std::string_view::npos) {
+        tokenize(line + pos + 1, size - pos - 1, service->argc, m_argv);
     }
-    argv.shrink_to_fit();
 
-    if (argv.size() < it->argc + 1) [[unlikely]] {
-        m_encoder.begin(MA_MSG_TYPE_EVT, MA_EINVAL, "AT", "Command " + name + " got wrong arguments");
-        m_encoder.end();
-        transport.send(reinterpret_cast<const char*>(m_encoder.data()), m_encoder.size());
+    if (m_argv.size() < service->argc + 1u) [[unlikely]] {
+        encoder.begin(MA_MSG_TYPE_EVT, MA_EINVAL, "AT", "Command " + std::string(name) + " got wrong arguments");
+        encoder.end();
+        transport.send(reinterpret_cast<const char*>(encoder.data()), encoder.size());
         return MA_EINVAL;
     }
 
-    ret = it->cb(std::move(argv), transport, m_encoder);
+    if (service->view_cb) {
+        return service->view_cb(m_argv, transport, session.encoder());
+    }
+    return service->cb(std::vector<std::string>(m_argv.begin(), m_argv.end()), transport, session.encoder());
+}
 
-    return ret;
+ma_err_t ATServer::execute(std::string line, Transport& transport) {
+    return execute(line.data(), line.size(), transport);
 }
 
 ma_err_t ATServer::execute(std::string line, Transport* transport) {
@@ -3,11 +3,16 @@
 
 #include <functional>
 #include <string>
+#include <string_view>
 #include <forward_list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "codec/ma_codec.h"
 #include "core/ma_core.h"
 #include "porting/ma_porting.h"
+#include "server/at/ma_transport_link.h"
 
 #ifndef MA_SEVER_AT_EXECUTOR_STACK_SIZE
     #define MA_SEVER_AT_EXECUTOR_STACK_SIZE 20 * 1024
@@ -26,19 +31,41 @@ namespace ma {
 class ATServer;
 
 typedef std::function<ma_err_t(std::vector<std::string>, Transport&, Encoder&)> ATServiceCallback;
+// arguments are views into the receive buffer, only valid until the callback returns
+typedef std::function<ma_err_t(const std::vector<std::string_view>&, Transport&, Encoder&)> ATServiceViewCallback;
 
 struct ATService {
     ATService(const std::string& name, const std::string& desc, const std::string& args, ATServiceCallback cb);
+    ATService(const std::string& name, const std::string& desc, const std::string& args, ATServiceViewCallback cb);
 
-    std::string       name;
-    std::string       desc;
-    std::string       args;
-    uint8_t           argc;
-    ATServiceCallback cb;
+    // case insensitive FNV-1a of a command name, the key of the dispatch table
+    static uint32_t hash(std::string_view name);
+
+    std::string           name;
+    std::string           desc;
+    std::string           args;
+    uint8_t               argc;
+    ATServiceCallback     cb;
+    ATServiceViewCallback view_cb;
 
     friend class ATServer;
 };
 
+// per transport state, its encoders are only used by the executor and keep their buffers between messages,
+// the executor has a single worker, so the messages of its tasks are built one after another for all transports.
+// Read only queries (ID?, NAME?, VER?, STAT?, CODEC?) and CODEC reply from the server thread instead, with its
+// own encoders. Commands are given the link of the session, every thread sending on the transport goes through it.
+struct ATSession {
+    explicit ATSession(Transport& transport);
+
+    ma_codec_type_t   codec = MA_CODEC_JSON;
+    EncoderJSONStream json;
+    EncoderCBOR       cbor;
+    TransportLink     link;
+
+    Encoder& encoder();
+};
+
 class ATServer {
    public:
     ATServer(Encoder& codec);
@@ -55,19 +82,42 @@ class ATServer {
                         const std::string& desc,
                         const std::string& args,
                         ATServiceCallback  cb);
+    ma_err_t addService(const std::string& name,
+                        const std::string& desc,
+                        const std::string& args,
+                        ATServiceViewCallback cb);
     ma_err_t addService(ATService& service);
     ma_err_t removeService(const std::string& name);
+    // the line is tokenized in place, the arguments given to view callbacks point into it
+    ma_err_t execute(char* line, size_t size, Transport& transport);
     ma_err_t execute(std::string line, Transport& transport);
     ma_err_t execute(std::string line, Transport* transport);
 
+    Encoder& getEncoder(Transport& transport);
+    ma_err_t setCodec(Transport& transport, ma_codec_type_t type);
+
+   private:
+    // the session of a transport or of its link
+    ATSession& getSession(Transport& transport);
+    Encoder&   getDirectEncoder(Transport& transport);
+    const ATService* findService(std::string_view name) const;
+
    protected:
     void threadEntry();
 
    private:
     static void            threadEntryStub(void* arg);
     Thread*                m_thread;
+    // replies sent from the server thread itself, following the codec of the transport
     Encoder&               m_encoder;
+    EncoderCBOR            m_encoder_cbor;
+    std::unordered_map<const Transport*, ATSession> m_sessions;
+    std::unordered_map<const Transport*, ATSession*> m_links;
     std::forward_list<ATService> m_services;
+    // services sorted by the hash of their name, nodes of m_services never move
+    std::vector<std::pair<uint32_t, const ATService*>> m_dispatch;
+    // arguments of the command being executed, kept to reuse the capacity
+    std::vector<std::string_view> m_argv;
 };
 
 }  // namespace ma
@@ -0,0 +1,116 @@
+#include "ma_storage_batch.h"
+
+namespace ma {
+
+static const char* TAG = "ma::server::StorageBatch";
+
+StorageBatch::StorageBatch(Storage& backing) : m_backing(backing) {
+    m_initialized = true;
+}
+
+ma_err_t StorageBatch::init(const void* config) noexcept {
+    (void)config;
+    return MA_OK;
+}
+
+void StorageBatch::deInit() noexcept {}
+
+ma_err_t StorageBatch::set(const std::string& key, int64_t value) noexcept {
+    m_pending[key] = Entry{Entry::kInt, value, 0.0, {}};
+    return MA_OK;
+}
+
+ma_err_t StorageBatch::set(const std::string& key, double value) noexcept {
+    m_pending[key] = Entry{Entry::kDouble, 0, value, {}};
+    return MA_OK;
+}
+
+ma_err_t StorageBatch::set(const std::string& key, const void* value, size_t size) noexcept {
+    m_pending[key] = Entry{Entry::kBlob, 0, 0.0, std::string(static_cast<const char*>(value), size)};
+    return MA_OK;
+}
+
+ma_err_t StorageBatch::get(const std::string& key, int64_t& value) noexcept {
+    auto it = m_pending.find(key);
+    if (it == m_pending.end() || it->second.kind == Entry::kDouble || it->second.kind == Entry::kBlob) {
+        return m_backing.get(key, value);
+    }
+    if (it->second.kind == Entry::kRemoved) {
+        return MA_ENOENT;
+    }
+    value = it->second.i;
+    return MA_OK;
+}
+
+ma_err_t StorageBatch::get(const std::string& key, double& value) noexcept {
+    auto it = m_pending.find(key);
+    if (it == m_pending.end() || it->second.kind == Entry::kInt || it->second.kind == Entry::kBlob) {
+        return m_backing.get(key, value);
+    }
+    if (it->second.kind == Entry::kRemoved) {
+        return MA_ENOENT;
+    }
+    value = it->second.d;
+    return MA_OK;
+}
+
+ma_err_t StorageBatch::get(const std::string& key, std::string& value) noexcept {
+    auto it = m_pending.find(key);
+    if (it == m_pending.end() || it->second.kind == Entry::kInt || it->second.kind == Entry::kDouble) {
+        return m_backing.get(key, value);
+    }
+    if (it->second.kind == Entry::kRemoved) {
+        return MA_ENOENT;
+    }
+    value = it->second.blob;
+    return MA_OK;
+}
+
+ma_err_t StorageBatch::remove(const std::string& key) noexcept {
+    m_pending[key] = Entry{Entry::kRemoved, 0, 0.0, {}};
+    return MA_OK;
+}
+
+bool StorageBatch::exists(const std::string& key) noexcept {
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) {
+        return m_backing.exists(key);
+    }
+    return it->second.kind != Entry::kRemoved;
+}
+
+ma_err_t StorageBatch::commit() noexcept {
+    ma_err_t ret = MA_OK;
+    for (const auto& [key, entry] : m_pending) {
+        ma_err_t err = MA_OK;
+        switch (entry.kind) {
+            case Entry::kInt:
+                err = m_backing.set(key, entry.i);
+                break;
+            case Entry::kDouble:
+                err = m_backing.set(key, entry.d);
+                break;
+            case Entry::kBlob:
+                err = m_backing.set(key, entry.blob.data(), entry.blob.size());
+                break;
+            case Entry::kRemoved:
+                // removing a key that was never stored is not an error here
+                err = m_backing.exists(key) ? m_backing.remove(key) : MA_OK;
+                break;
+        }
+        if (err != MA_OK) {
+            MA_LOGW(TAG, "failed to write %s: %d", key.c_str(), err);
+            if (ret == MA_OK) {
+                ret = err;
+            }
+        }
+    }
+    m_pending.clear();
+    return ret;
+}
+
+size_t StorageBatch::pending() const noexcept {
+    return m_pending.size();
+}
+
+}  // namespace ma
@@ -0,0 +1,56 @@
+#ifndef _MA_STORAGE_BATCH_H_
+#define _MA_STORAGE_BATCH_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "core/ma_common.h"
+#include "porting/ma_storage.h"
+
+namespace ma {
+
+/*!
+ * @brief Write-back layer over a storage, writes and removals are kept in memory and
+ * reads see them, commit() then writes each touched key once with its last value.
+ *
+ * Used while a batch of commands runs (see Device::setStorageOverlay), so a key set by
+ * several commands costs a single write of the backing storage.
+ */
+class StorageBatch final : public Storage {
+public:
+    explicit StorageBatch(Storage& backing);
+    ~StorageBatch() = default;
+
+    ma_err_t init(const void* config) noexcept override;
+    void deInit() noexcept override;
+
+    ma_err_t set(const std::string& key, int64_t value) noexcept override;
+    ma_err_t set(const std::string& key, double value) noexcept override;
+    ma_err_t get(const std::string& key, int64_t& value) noexcept override;
+    ma_err_t get(const std::string& key, double& value) noexcept override;
+    ma_err_t set(const std::string& key, const void* value, size_t size) noexcept override;
+    ma_err_t get(const std::string& key, std::string& value) noexcept override;
+
+    ma_err_t remove(const std::string& key) noexcept override;
+    bool exists(const std::string& key) noexcept override;
+
+    // writes the pending changes to the backing storage, returns the first error
+    ma_err_t commit() noexcept;
+    size_t pending() const noexcept;
+
+private:
+    struct Entry {
+        enum Kind { kInt, kDouble, kBlob, kRemoved } kind;
+        int64_t i;
+        double d;
+        std::string blob;
+    };
+
+    Storage& m_backing;
+    std::map<std::string, Entry> m_pending;
+};
+
+}  // namespace ma
+
+#endif  // _MA_STORAGE_BATCH_H_
@@ -0,0 +1,104 @@
+#include "ma_transport_batch.h"
+
+namespace ma {
+
+TransportBatch::TransportBatch(Transport& transport) : Transport(transport.getType()), m_transport(transport), m_busy(false), m_recorder(nullptr), m_slot(0) {
+    m_initialized = true;
+}
+
+ma_err_t TransportBatch::init(const void* config) noexcept {
+    (void)config;
+    return MA_OK;
+}
+
+void TransportBatch::deInit() noexcept {}
+
+size_t TransportBatch::available() const noexcept {
+    return 0;
+}
+
+size_t TransportBatch::send(const char* data, size_t length) noexcept {
+    if (!recording()) {
+        return m_transport.send(data, length);
+    }
+    m_slots[m_slot].emplace_back(data, length);
+    return length;
+}
+
+size_t TransportBatch::sendv(const ma_iovec_t* iov, size_t iovcnt) noexcept {
+    if (!recording()) {
+        return m_transport.sendv(iov, iovcnt);
+    }
+    // the parts make a single message
+    std::string message;
+    for (size_t i = 0; i < iovcnt; ++i) {
+        message.append(static_cast<const char*>(iov[i].base), iov[i].len);
+    }
+    size_t size = message.size();
+    m_slots[m_slot].push_back(std::move(message));
+    return size;
+}
+
+size_t TransportBatch::flush() noexcept {
+    return recording() ? 0 : m_transport.flush();
+}
+
+size_t TransportBatch::receive(char* data, size_t length) noexcept {
+    (void)data;
+    (void)length;
+    return 0;
+}
+
+size_t TransportBatch::receiveIf(char* data, size_t length, char delimiter) noexcept {
+    (void)data;
+    (void)length;
+    (void)delimiter;
+    return 0;
+}
+
+Transport& TransportBatch::transport() const noexcept {
+    return m_transport;
+}
+
+Transport& TransportBatch::underlying() noexcept {
+    return m_transport;
+}
+
+ma_err_t TransportBatch::acquire(size_t count) noexcept {
+    if (m_busy.exchange(true)) {
+        return MA_EBUSY;
+    }
+    m_slots.clear();
+    m_slots.resize(count);
+    m_slot = 0;
+    return MA_OK;
+}
+
+void TransportBatch::record(bool enable) noexcept {
+    m_recorder.store(enable ? Thread::self() : nullptr);
+}
+
+void TransportBatch::select(size_t index) noexcept {
+    m_slot = index < m_slots.size() ? index : m_slots.size() - 1;
+}
+
+std::vector<std::string> TransportBatch::release() {
+    record(false);
+
+    std::vector<std::string> messages;
+    for (auto& slot : m_slots) {
+        for (auto& message : slot) {
+            messages.push_back(std::move(message));
+        }
+    }
+    m_slots.clear();
+    m_busy.store(false);
+    return messages;
+}
+
+bool TransportBatch::recording() const noexcept {
+    ma_thread_t* recorder = m_recorder.load();
+    return recorder != nullptr && recorder == Thread::self();
+}
+
+}  // namespace ma
@@ -0,0 +1,66 @@
+#ifndef _MA_TRANSPORT_BATCH_H_
+#define _MA_TRANSPORT_BATCH_H_
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "core/ma_common.h"
+#include "porting/ma_osal.h"
+#include "porting/ma_transport.h"
+
+#ifndef MA_AT_BATCH_MAX_COMMANDS
+    #define MA_AT_BATCH_MAX_COMMANDS 16
+#endif
+
+namespace ma {
+
+/*!
+ * @brief Transport the commands of a batch are executed on, it records the messages sent by
+ * the recording thread in the slot of the current command instead of sending them, so they
+ * can be replied as one aggregated message. Messages sent by any other thread, or while not
+ * recording, are forwarded to the wrapped transport (e.g. events of an INVOKE the batch started).
+ *
+ * Lives as long as the wrapped transport, a single batch may use it at a time.
+ */
+class TransportBatch final : public Transport {
+public:
+    explicit TransportBatch(Transport& transport);
+    ~TransportBatch() = default;
+
+    ma_err_t init(const void* config) noexcept override;
+    void deInit() noexcept override;
+
+    size_t available() const noexcept override;
+    size_t send(const char* data, size_t length) noexcept override;
+    size_t sendv(const ma_iovec_t* iov, size_t iovcnt) noexcept override;
+    size_t flush() noexcept override;
+    size_t receive(char* data, size_t length) noexcept override;
+    size_t receiveIf(char* data, size_t length, char delimiter) noexcept override;
+
+    Transport& transport() const noexcept;
+    Transport& underlying() noexcept override;
+
+    // claims the transport for a batch of count commands, MA_EBUSY while another batch holds it
+    ma_err_t acquire(size_t count) noexcept;
+    // the calling thread records from now on, or nobody with false
+    void record(bool enable) noexcept;
+    // messages sent from now on belong to the command at index
+    void select(size_t index) noexcept;
+    // the recorded messages in command order, the transport is free for the next batch
+    std::vector<std::string> release();
+
+private:
+    bool recording() const noexcept;
+
+    Transport& m_transport;
+    std::atomic<bool> m_busy;
+    std::atomic<ma_thread_t*> m_recorder;
+    size_t m_slot;
+    std::vector<std::vector<std::string>> m_slots;
+};
+
+}  // namespace ma
+
+#endif  // _MA_TRANSPORT_BATCH_H_
@@ -0,0 +1,48 @@
+#include "ma_transport_link.h"
+
+namespace ma {
+
+TransportLink::TransportLink(Transport& transport) : Transport(transport.getType()), m_transport(transport), m_lock() {
+    m_initialized = true;
+}
+
+ma_err_t TransportLink::init(const void* config) noexcept {
+    (void)config;
+    return MA_OK;
+}
+
+void TransportLink::deInit() noexcept {}
+
+size_t TransportLink::available() const noexcept {
+    return m_transport.available();
+}
+
+size_t TransportLink::send(const char* data, size_t length) noexcept {
+    const Guard guard(m_lock);
+    return m_transport.send(data, length);
+}
+
+size_t TransportLink::sendv(const ma_iovec_t* iov, size_t iovcnt) noexcept {
+    // the parts are one message, held across all of them on a byte stream
+    const Guard guard(m_lock);
+    return m_transport.sendv(iov, iovcnt);
+}
+
+size_t TransportLink::flush() noexcept {
+    const Guard guard(m_lock);
+    return m_transport.flush();
+}
+
+size_t TransportLink::receive(char* data, size_t length) noexcept {
+    return m_transport.receive(data, length);
+}
+
+size_t TransportLink::receiveIf(char* data, size_t length, char delimiter) noexcept {
+    return m_transport.receiveIf(data, length, delimiter);
+}
+
+Transport& TransportLink::transport() const noexcept {
+    return m_transport;
+}
+
+}  // namespace ma
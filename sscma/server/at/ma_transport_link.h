@@ -0,0 +1,46 @@
+#ifndef _MA_TRANSPORT_LINK_H_
+#define _MA_TRANSPORT_LINK_H_
+
+#include <cstddef>
+
+#include "core/ma_common.h"
+#include "porting/ma_osal.h"
+#include "porting/ma_transport.h"
+
+namespace ma {
+
+/*!
+ * @brief Transport the server hands to the commands of a connection, it forwards to the wrapped
+ * transport and holds one lock across each send, so the messages of the executor, the server
+ * thread and the event queue of the connection are never interleaved on a byte stream.
+ *
+ * Lives as long as the wrapped transport, receiving is left to the server.
+ */
+class TransportLink final : public Transport {
+public:
+    explicit TransportLink(Transport& transport);
+    ~TransportLink() = default;
+
+    ma_err_t init(const void* config) noexcept override;
+    void deInit() noexcept override;
+
+    size_t available() const noexcept override;
+    size_t send(const char* data, size_t length) noexcept override;
+    size_t sendv(const ma_iovec_t* iov, size_t iovcnt) noexcept override;
+    size_t flush() noexcept override;
+    size_t receive(char* data, size_t length) noexcept override;
+    size_t receiveIf(char* data, size_t length, char delimiter) noexcept override;
+
+    Transport& transport() const noexcept;
+
+private:
+    TransportLink(const TransportLink&)            = delete;
+    TransportLink& operator=(const TransportLink&) = delete;
+
+    Transport& m_transport;
+    Mutex m_lock;
+};
+
+}  // namespace ma
+
+#endif  // _MA_TRANSPORT_LINK_H_